@@ -0,0 +1,180 @@
+/*
+ * Audio.cxx
+ *
+ * This file is part of the Chip8++ source code.
+ * Copyright 2023 Patrick Melo <patrick@patrickmelo.com.br>
+ */
+
+#include "Audio.hxx"
+
+// Audio
+
+Audio::Audio(void) :
+    Chip8::Audio(),
+    isInitialized(false),
+    chip8(NULL),
+    audioDevice(0),
+    bufferPeriod(0),
+    wavePosition(0),
+    isBeeping(false),
+    beeperTime(0),
+    isPlaying(false),
+    callbackCount(0),
+    underrunCount(0),
+    toneCount(0),
+    lastCallbackTime(0),
+    latencyCount(0),
+    totalLatency(0),
+    maximumLatency(0) {
+    memset(this->waveTable, 0, sizeof(this->waveTable));
+}
+
+// General
+
+bool Audio::Initialize(Chip8* chip8) {
+    if (this->isInitialized) {
+        return false;
+    }
+
+    if (SDL_InitSubSystem(SDL_INIT_AUDIO) < 0) {
+        Error(Audio::Tag, "%s", SDL_GetError());
+        return false;
+    }
+
+    SDL_AudioSpec desiredSpec, obtainedSpec;
+
+    memset(&desiredSpec, 0, sizeof(desiredSpec));
+    desiredSpec.freq     = Audio::SampleRate;
+    desiredSpec.format   = AUDIO_S16SYS;
+    desiredSpec.channels = 1;
+    desiredSpec.samples  = Audio::BufferSamples;
+    desiredSpec.callback = &Audio::Fill;
+    desiredSpec.userdata = this;
+
+    // Nothing is allowed to change, SDL converts whatever the hardware wants behind the callback.
+
+    this->audioDevice = SDL_OpenAudioDevice(NULL, 0, &desiredSpec, &obtainedSpec, 0);
+
+    if (this->audioDevice == 0) {
+        Error(Audio::Tag, "%s", SDL_GetError());
+        SDL_QuitSubSystem(SDL_INIT_AUDIO);
+        return false;
+    }
+
+    // A square wave, one period long (the tone is rounded to a whole number of samples).
+
+    for (uint sampleIndex = 0; sampleIndex < Audio::WaveLength; ++sampleIndex) {
+        this->waveTable[sampleIndex] = (sampleIndex < (Audio::WaveLength / 2)) ? +Audio::ToneAmplitude : -Audio::ToneAmplitude;
+    }
+
+    this->chip8            = chip8;
+    this->bufferPeriod     = (UINT64(Audio::BufferSamples) * Scheduler::NanosecondsPerSecond) / Audio::SampleRate;
+    this->wavePosition     = 0;
+    this->isBeeping        = false;
+    this->beeperTime       = 0;
+    this->isPlaying        = false;
+    this->callbackCount    = 0;
+    this->underrunCount    = 0;
+    this->toneCount        = 0;
+    this->lastCallbackTime = 0;
+    this->latencyCount     = 0;
+    this->totalLatency     = 0;
+    this->maximumLatency   = 0;
+
+    this->chip8->SetAudio(this);
+    SDL_PauseAudioDevice(this->audioDevice, 0);
+
+    Info(Audio::Tag, "Initialized (%u Hz, %u samples per buffer).", Audio::SampleRate, Audio::BufferSamples);
+    return this->isInitialized = true;
+}
+
+void Audio::Finalize(void) {
+    if (!this->isInitialized) {
+        return;
+    }
+
+    this->chip8->SetAudio(NULL);
+
+    SDL_CloseAudioDevice(this->audioDevice);
+    SDL_QuitSubSystem(SDL_INIT_AUDIO);
+
+    this->audioDevice   = 0;
+    this->isInitialized = false;
+
+    Info(Audio::Tag, "%" PRIu64 " tones, %" PRIu64 " buffers (%" PRIu64 " underruns).", this->toneCount, this->callbackCount, this->underrunCount);
+    Info(Audio::Tag, "Beeper latency %.3f ms (worst %.3f ms).", this->GetMeanLatency() / 1e6, this->maximumLatency / 1e6);
+}
+
+// Chip8 (emulation thread)
+
+void Audio::SetBeeper(bool isBeeping) {
+    this->beeperTime.store(Scheduler::Now(), std::memory_order_relaxed);
+    this->isBeeping.store(isBeeping, std::memory_order_release);
+}
+
+// Callback (audio thread)
+
+void Audio::Fill(void* userData, Uint8* streamData, int streamSize) {
+    static_cast<Audio*>(userData)->Fill(reinterpret_cast<int16*>(streamData), streamSize / sizeof(int16));
+}
+
+void Audio::Fill(int16* sampleData, uint numberOfSamples) {
+    uint64 callbackTime = Scheduler::Now();
+    bool   isBeeping    = this->isBeeping.load(std::memory_order_acquire);
+
+    // The device asks for the next buffer while it still plays the current one, so a gap of two periods means it ran dry.
+
+    if ((this->callbackCount > 0) && ((callbackTime - this->lastCallbackTime) > (2 * this->bufferPeriod))) {
+        this->underrunCount++;
+    }
+
+    this->callbackCount++;
+    this->lastCallbackTime = callbackTime;
+
+    // What is written now is heard once the buffer ahead of it has played.
+
+    if (isBeeping != this->isPlaying) {
+        uint64 beeperLatency = (callbackTime - this->beeperTime.load(std::memory_order_relaxed)) + this->bufferPeriod;
+
+        this->latencyCount++;
+        this->totalLatency += beeperLatency;
+        this->maximumLatency = std::max(this->maximumLatency, beeperLatency);
+        this->toneCount += isBeeping;
+        this->isPlaying = isBeeping;
+    }
+
+    if (!isBeeping) {
+        memset(sampleData, 0, numberOfSamples * sizeof(int16));
+        return;
+    }
+
+    for (uint sampleIndex = 0; sampleIndex < numberOfSamples;) {
+        uint copiedSamples = std::min(numberOfSamples - sampleIndex, Audio::WaveLength - this->wavePosition);
+
+        memcpy(&sampleData[sampleIndex], &this->waveTable[this->wavePosition], copiedSamples * sizeof(int16));
+        sampleIndex += copiedSamples;
+        this->wavePosition = (this->wavePosition + copiedSamples) % Audio::WaveLength;
+    }
+}
+
+// Statistics
+
+uint64 Audio::GetCallbackCount(void) const {
+    return this->callbackCount;
+}
+
+uint64 Audio::GetUnderrunCount(void) const {
+    return this->underrunCount;
+}
+
+uint64 Audio::GetToneCount(void) const {
+    return this->toneCount;
+}
+
+double Audio::GetMeanLatency(void) const {
+    return this->latencyCount ? static_cast<double>(this->totalLatency) / this->latencyCount : 0.0;
+}
+
+uint64 Audio::GetMaximumLatency(void) const {
+    return this->maximumLatency;
+}
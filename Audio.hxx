@@ -0,0 +1,77 @@
+/*
+ * Audio.hxx
+ *
+ * This file is part of the Chip8++ source code.
+ * Copyright 2023 Patrick Melo <patrick@patrickmelo.com.br>
+ */
+
+#ifndef CHIP8_AUDIO_H
+#define CHIP8_AUDIO_H
+
+#include "Chip8.hxx"
+#include "Scheduler.hxx"
+
+#include <atomic>
+
+#include <SDL2/SDL.h>
+
+// Audio (SDL; SetBeeper runs on the emulation thread, the callback on SDL's audio thread and never locks or allocates)
+
+class Audio : public Chip8::Audio {
+    public:
+        Audio(void);
+
+        // Constants
+        static constexpr charconst Tag           = "Audio";
+        static constexpr uint      SampleRate    = 48000;
+        static constexpr uint      BufferSamples = 256;                           // 5.3 ms at 48 kHz, the device holds about two buffers
+        static constexpr uint      ToneFrequency = 440;
+        static constexpr uint      WaveLength    = SampleRate / ToneFrequency;    // Samples in one period of the tone
+        static constexpr int16     ToneAmplitude = 4096;
+
+        // General
+        bool Initialize(Chip8* chip8);
+        void Finalize(void);
+        void SetBeeper(bool isBeeping);
+
+        // Statistics (read after Finalize, the callback owns them while the device runs)
+        uint64 GetCallbackCount(void) const;
+        uint64 GetUnderrunCount(void) const;
+        uint64 GetToneCount(void) const;
+        double GetMeanLatency(void) const;    // Nanoseconds from SetBeeper to the first sample that plays it
+        uint64 GetMaximumLatency(void) const;
+
+    private:
+        // General
+        bool isInitialized;
+
+        // Chip8
+        Chip8* chip8;
+
+        // SDL
+        SDL_AudioDeviceID audioDevice;
+        uint              bufferPeriod;    // Nanoseconds of sound in one callback
+
+        // Waveform (one period, precomputed so the callback only copies)
+        int16 waveTable[WaveLength];
+        uint  wavePosition;
+
+        // Beeper (the emulation thread publishes, the callback takes it at the start of every buffer)
+        std::atomic<bool>   isBeeping;
+        std::atomic<uint64> beeperTime;
+        bool                isPlaying;
+
+        static void Fill(void* userData, Uint8* streamData, int streamSize);
+        void        Fill(int16* sampleData, uint numberOfSamples);
+
+        // Statistics
+        uint64 callbackCount;
+        uint64 underrunCount;    // Callbacks that came later than the device could have played the previous buffer
+        uint64 toneCount;
+        uint64 lastCallbackTime;
+        uint64 latencyCount;
+        uint64 totalLatency;
+        uint64 maximumLatency;
+};
+
+#endif    // CHIP8_AUDIO_H
@@ -0,0 +1,820 @@
+/*
+ * Batch.cxx
+ *
+ * This file is part of the Chip8++ source code.
+ * Copyright 2023 Patrick Melo <patrick@patrickmelo.com.br>
+ */
+
+#include "Batch.hxx"
+
+// State Helpers
+
+static inline void WriteState(uint8*& stateCursor, const void* fieldData, uint fieldSize) {
+    memcpy(stateCursor, fieldData, fieldSize);
+    stateCursor += fieldSize;
+}
+
+// Lane Helpers
+
+template <bool IsMasked, typename Type> static inline Type Select(const uint8* selectedLanes, uint lane, Type newValue, Type oldValue) {
+    return (!IsMasked || selectedLanes[lane]) ? newValue : oldValue;
+}
+
+// Batch
+
+Batch::Batch(void) :
+    groups(NULL),
+    numberOfGroups(0),
+    numberOfMachines(0),
+    quirkProfile(Chip8::QuirksVIP),
+    instructionsPerFrame(1) {
+    memset(&this->statistics, 0, sizeof(this->statistics));
+}
+
+Batch::~Batch() {
+    this->Finalize();
+}
+
+// General
+
+bool Batch::Initialize(const Chip8::RAM& programMemory, uint numberOfMachines, Chip8::QuirkProfile quirkProfile) {
+    this->Finalize();
+
+    if (numberOfMachines == 0) {
+        Error(Batch::Tag, "A batch needs at least one machine.");
+        return false;
+    }
+
+    this->numberOfMachines = numberOfMachines;
+    this->numberOfGroups   = (numberOfMachines + Batch::GroupLanes - 1) / Batch::GroupLanes;
+    this->quirkProfile     = quirkProfile;
+    this->groups           = new (std::nothrow) Group*[this->numberOfGroups]();
+
+    if (!this->groups) {
+        Error(Batch::Tag, "Could not allocate %u groups.", this->numberOfGroups);
+        this->Finalize();
+        return false;
+    }
+
+    for (uint groupIndex = 0; groupIndex < this->numberOfGroups; ++groupIndex) {
+        this->groups[groupIndex] = new (std::nothrow) Group;
+
+        if (!this->groups[groupIndex]) {
+            Error(Batch::Tag, "Could not allocate the machines of group %u.", groupIndex);
+            this->Finalize();
+            return false;
+        }
+
+        for (uint lane = 0; lane < Batch::GroupLanes; ++lane) {
+            this->groups[groupIndex]->randomSeed[lane] = Chip8::DefaultRandomSeed;
+            this->groups[groupIndex]->keyStates[lane]  = 0;
+        }
+    }
+
+    // Every lane starts from the same image, so the program is decoded once. An address stays on this cache until a lane
+    // stores to it.
+
+    memcpy(this->programMemory, programMemory, sizeof(Chip8::RAM));
+
+    for (uint address = 0; address < sizeof(Chip8::RAM); ++address) {
+        Chip8::Decode((this->programMemory[address] << 8) | this->programMemory[(address + 1) & 0xFFF], this->decodedMemory[address]);
+    }
+
+    this->Reset();
+    return true;
+}
+
+void Batch::Finalize(void) {
+    if (this->groups) {
+        for (uint groupIndex = 0; groupIndex < this->numberOfGroups; ++groupIndex) {
+            delete this->groups[groupIndex];
+        }
+
+        delete[] this->groups;
+    }
+
+    this->groups           = NULL;
+    this->numberOfGroups   = 0;
+    this->numberOfMachines = 0;
+}
+
+void Batch::Reset(void) {
+    for (uint groupIndex = 0; groupIndex < this->numberOfGroups; ++groupIndex) {
+        this->ResetGroup(*this->groups[groupIndex]);
+    }
+
+    // The machines past the end of the last group never run.
+
+    for (uint machineIndex = this->numberOfMachines; machineIndex < (this->numberOfGroups * Batch::GroupLanes); ++machineIndex) {
+        this->groups[machineIndex / Batch::GroupLanes]->isHalted[machineIndex % Batch::GroupLanes] = 1;
+    }
+
+    memset(&this->statistics, 0, sizeof(this->statistics));
+}
+
+void Batch::ResetGroup(Group& group) {
+    // The seeds and the keys survive a reset, as they do on a single machine.
+
+    memset(group.cpuRegisters, 0, sizeof(group.cpuRegisters));
+    memset(group.addressRegister, 0, sizeof(group.addressRegister));
+    memset(group.stackPointer, 0, sizeof(group.stackPointer));
+    memset(group.callStack, 0, sizeof(group.callStack));
+    memset(group.delayTimer, 0, sizeof(group.delayTimer));
+    memset(group.soundTimer, 0, sizeof(group.soundTimer));
+    memset(group.pressedKeys, 0, sizeof(group.pressedKeys));
+    memset(group.isWaitingForKey, 0, sizeof(group.isWaitingForKey));
+    memset(group.isHalted, 0, sizeof(group.isHalted));
+    memset(group.stopCycle, 0, sizeof(group.stopCycle));
+    memset(group.writtenMemory, 0, sizeof(group.writtenMemory));
+    memset(group.videoMemory, 0, sizeof(group.videoMemory));
+
+    for (uint lane = 0; lane < Batch::GroupLanes; ++lane) {
+        group.programCounter[lane] = Chip8::ProgramStartAddress;
+        group.randomState[lane]    = group.randomSeed[lane];
+
+        memcpy(group.mainMemory[lane], this->programMemory, sizeof(Chip8::RAM));
+    }
+}
+
+void Batch::SetCpuRate(uint instructionsPerSecond) {
+    this->SetInstructionsPerFrame((instructionsPerSecond + (Chip8::FrameRate / 2)) / Chip8::FrameRate);
+}
+
+void Batch::SetInstructionsPerFrame(uint instructionsPerFrame) {
+    this->instructionsPerFrame = instructionsPerFrame > 0 ? instructionsPerFrame : 1;
+}
+
+void Batch::SetRandomSeed(uint machineIndex, uint32 newSeed) {
+    if (machineIndex < this->numberOfMachines) {
+        this->groups[machineIndex / Batch::GroupLanes]->randomSeed[machineIndex % Batch::GroupLanes] = newSeed ? newSeed : Chip8::DefaultRandomSeed;
+    }
+}
+
+void Batch::SetKey(uint machineIndex, uint8 keyIndex, bool isPressed) {
+    if (machineIndex >= this->numberOfMachines) {
+        return;
+    }
+
+    Group& group  = *this->groups[machineIndex / Batch::GroupLanes];
+    uint   lane   = machineIndex % Batch::GroupLanes;
+    uint16 keyBit = 1 << (keyIndex % Chip8::NumberOfKeys);
+
+    if (isPressed) {
+        group.keyStates[lane] |= keyBit;
+        group.pressedKeys[lane] |= keyBit;
+    } else {
+        group.keyStates[lane] &= ~keyBit;
+    }
+}
+
+// CPU
+
+uint64 Batch::RunFrames(uint64 numberOfFrames) {
+    uint64 retiredInstructions = this->statistics.retiredInstructions;
+
+    // One group at a time for the whole run, its machines stay in the cache.
+
+    for (uint groupIndex = 0; groupIndex < this->numberOfGroups; ++groupIndex) {
+        switch (this->quirkProfile) {
+            case Chip8::QuirksVIP: this->RunGroup<Chip8::QuirksVIP>(*this->groups[groupIndex], numberOfFrames); break;
+            case Chip8::QuirksCHIP48: this->RunGroup<Chip8::QuirksCHIP48>(*this->groups[groupIndex], numberOfFrames); break;
+            case Chip8::QuirksSCHIP: this->RunGroup<Chip8::QuirksSCHIP>(*this->groups[groupIndex], numberOfFrames); break;
+        }
+    }
+
+    return this->statistics.retiredInstructions - retiredInstructions;
+}
+
+// Machines
+
+uint Batch::GetNumberOfMachines(void) const {
+    return this->numberOfMachines;
+}
+
+bool Batch::IsHalted(uint machineIndex) const {
+    return this->groups[machineIndex / Batch::GroupLanes]->isHalted[machineIndex % Batch::GroupLanes] != 0;
+}
+
+uint16 Batch::GetProgramCounter(uint machineIndex) const {
+    return this->groups[machineIndex / Batch::GroupLanes]->programCounter[machineIndex % Batch::GroupLanes];
+}
+
+uint32 Batch::GetAddressRegister(uint machineIndex) const {
+    return this->groups[machineIndex / Batch::GroupLanes]->addressRegister[machineIndex % Batch::GroupLanes];
+}
+
+uint8 Batch::GetRegister(uint machineIndex, uint registerIndex) const {
+    return this->groups[machineIndex / Batch::GroupLanes]->cpuRegisters[registerIndex & 0xF][machineIndex % Batch::GroupLanes];
+}
+
+const uint8* Batch::GetMemory(uint machineIndex) const {
+    return this->groups[machineIndex / Batch::GroupLanes]->mainMemory[machineIndex % Batch::GroupLanes];
+}
+
+void Batch::GetVRAM(uint machineIndex, Chip8::VRAM& videoMemory) const {
+    memset(videoMemory, 0, sizeof(Chip8::VRAM));
+    memcpy(videoMemory, this->groups[machineIndex / Batch::GroupLanes]->videoMemory[machineIndex % Batch::GroupLanes], Chip8::ScreenHeight * sizeof(uint64));
+}
+
+uint Batch::SaveState(uint machineIndex, uint8* stateBuffer, uint bufferSize) const {
+    if ((machineIndex >= this->numberOfMachines) || (bufferSize < Chip8::StateSize)) {
+        return 0;
+    }
+
+    // The layout of Chip8::SaveState, in the low resolution screen and without user flags. A running lane is always at the
+    // start of a frame, a stopped one where it stopped.
+
+    const Group& group       = *this->groups[machineIndex / Batch::GroupLanes];
+    uint         lane        = machineIndex % Batch::GroupLanes;
+    uint8*       stateCursor = stateBuffer;
+    uint32       stateMagic  = Chip8::StateMagic;
+    uint16       version     = Chip8::StateVersion;
+    uint16       stateSize   = Chip8::StateSize;
+    uint8        screenMode  = 0;
+    uint         frameCycles = group.isHalted[lane] ? group.stopCycle[lane] : 0;
+    uint8        flagRegisters[16];
+    uint16       callStack[16];
+    uint8        cpuRegisters[16];
+    Chip8::VRAM  videoMemory;
+
+    memset(flagRegisters, 0, sizeof(flagRegisters));
+
+    for (uint stackIndex = 0; stackIndex < 16; ++stackIndex) {
+        callStack[stackIndex]    = group.callStack[stackIndex][lane];
+        cpuRegisters[stackIndex] = group.cpuRegisters[stackIndex][lane];
+    }
+
+    this->GetVRAM(machineIndex, videoMemory);
+
+    WriteState(stateCursor, &stateMagic, sizeof(stateMagic));
+    WriteState(stateCursor, &version, sizeof(version));
+    WriteState(stateCursor, &stateSize, sizeof(stateSize));
+    WriteState(stateCursor, &group.addressRegister[lane], sizeof(group.addressRegister[lane]));
+    WriteState(stateCursor, &group.programCounter[lane], sizeof(group.programCounter[lane]));
+    WriteState(stateCursor, callStack, sizeof(callStack));
+    WriteState(stateCursor, cpuRegisters, sizeof(cpuRegisters));
+    WriteState(stateCursor, &group.stackPointer[lane], sizeof(group.stackPointer[lane]));
+    WriteState(stateCursor, &group.delayTimer[lane], sizeof(group.delayTimer[lane]));
+    WriteState(stateCursor, &group.soundTimer[lane], sizeof(group.soundTimer[lane]));
+    WriteState(stateCursor, &screenMode, sizeof(screenMode));
+    WriteState(stateCursor, &group.randomState[lane], sizeof(group.randomState[lane]));
+    WriteState(stateCursor, &frameCycles, sizeof(frameCycles));
+    WriteState(stateCursor, flagRegisters, sizeof(flagRegisters));
+    WriteState(stateCursor, videoMemory, sizeof(videoMemory));
+    WriteState(stateCursor, group.mainMemory[lane], sizeof(Chip8::RAM));
+
+    return stateCursor - stateBuffer;
+}
+
+// Statistics
+
+const Batch::Statistics& Batch::GetStatistics(void) const {
+    return this->statistics;
+}
+
+// Execution
+
+template <Chip8::QuirkProfile Profile> void Batch::RunGroup(Group& group, uint64 numberOfFrames) {
+    for (uint64 frameIndex = 0; frameIndex < numberOfFrames; ++frameIndex) {
+        uint liveLanes = 0;
+
+        for (uint lane = 0; lane < Batch::GroupLanes; ++lane) {
+            liveLanes += group.isHalted[lane] ^ 1;
+        }
+
+        if (liveLanes == 0) {
+            break;
+        }
+
+        // Lanes scattered over the program are cheaper one at a time than in a pass each, for the rest of the frame. The
+        // next frame tries the group again.
+
+        for (group.frameCycle = 0; group.frameCycle < this->instructionsPerFrame; ++group.frameCycle) {
+            if (this->Step<Profile>(group) > Batch::ScatteredPasses) {
+                this->RunLanes<Profile>(group, group.frameCycle + 1);
+                break;
+            }
+        }
+
+        this->Tick(group);
+    }
+}
+
+template <Chip8::QuirkProfile Profile> inline uint Batch::Step(Group& group) {
+    // Every live lane retires exactly one instruction per step, so the lanes keep the timing of a machine of their own.
+    // When they all sit at the same address of unmodified code, the group runs it as one vector operation.
+
+    uint16 programCounter = group.programCounter[0];
+    uint   laneMismatch   = 0;
+
+    for (uint lane = 0; lane < Batch::GroupLanes; ++lane) {
+        laneMismatch |= (group.programCounter[lane] ^ programCounter) | group.isHalted[lane];
+    }
+
+    if ((laneMismatch == 0) && !this->IsWritten(group, programCounter) && !this->IsWritten(group, programCounter + 1)) {
+        this->Execute<Profile, Batch::ExecuteGroup>(group, this->decodedMemory[programCounter & 0xFFF], NULL, 0);
+        this->statistics.groupSteps++;
+        this->statistics.retiredInstructions += Batch::GroupLanes;
+        return 0;
+    }
+
+    // Otherwise the lanes are taken one address at a time: every pending lane at the address of the first one runs in a
+    // masked pass over the whole group. A lane running code some lane wrote runs alone, from its own memory.
+
+    uint8 pendingLanes[Batch::GroupLanes];
+    uint8 selectedLanes[Batch::GroupLanes];
+    uint  firstLane      = 0;
+    uint  numberOfPasses = 0;
+
+    for (uint lane = 0; lane < Batch::GroupLanes; ++lane) {
+        pendingLanes[lane] = group.isHalted[lane] ^ 1;
+    }
+
+    while (true) {
+        while ((firstLane < Batch::GroupLanes) && !pendingLanes[firstLane]) {
+            firstLane++;
+        }
+
+        if (firstLane == Batch::GroupLanes) {
+            break;
+        }
+
+        programCounter = group.programCounter[firstLane];
+
+        uint passLanes = 0;
+
+        if (this->IsWritten(group, programCounter) || this->IsWritten(group, programCounter + 1)) {
+            Chip8::Instruction laneInstruction;
+
+            pendingLanes[firstLane] = 0;
+            passLanes               = 1;
+            this->Execute<Profile, Batch::ExecuteLane>(group, this->FetchInstruction(group, firstLane, laneInstruction), NULL, firstLane);
+        } else {
+            for (uint lane = 0; lane < Batch::GroupLanes; ++lane) {
+                selectedLanes[lane] = pendingLanes[lane] & (group.programCounter[lane] == programCounter);
+                pendingLanes[lane] ^= selectedLanes[lane];
+                passLanes += selectedLanes[lane];
+            }
+
+            this->Execute<Profile, Batch::ExecuteMasked>(group, this->decodedMemory[programCounter & 0xFFF], selectedLanes, 0);
+        }
+
+        numberOfPasses++;
+        this->statistics.maskedPasses++;
+        this->statistics.maskedInstructions += passLanes;
+        this->statistics.retiredInstructions += passLanes;
+    }
+
+    return numberOfPasses;
+}
+
+template <Chip8::QuirkProfile Profile> void Batch::RunLanes(Group& group, uint firstCycle) {
+    uint64 laneInstructions = 0;
+
+    for (uint lane = 0; lane < Batch::GroupLanes; ++lane) {
+        if (group.isHalted[lane]) {
+            continue;
+        }
+
+        for (uint frameCycle = firstCycle; frameCycle < this->instructionsPerFrame; ++frameCycle) {
+            Chip8::Instruction laneInstruction;
+
+            this->Execute<Profile, Batch::ExecuteLane>(group, this->FetchInstruction(group, lane, laneInstruction), NULL, lane);
+            laneInstructions++;
+
+            if (group.isHalted[lane]) {
+                group.stopCycle[lane] = frameCycle;
+                break;
+            }
+        }
+    }
+
+    this->statistics.laneInstructions += laneInstructions;
+    this->statistics.retiredInstructions += laneInstructions;
+}
+
+inline void Batch::Halt(Group& group, uint lane) {
+    group.isHalted[lane]  = 1;
+    group.stopCycle[lane] = group.frameCycle;
+}
+
+inline const Chip8::Instruction& Batch::FetchInstruction(const Group& group, uint lane, Chip8::Instruction& laneInstruction) const {
+    uint16 programCounter = group.programCounter[lane];
+
+    if (!this->IsWritten(group, programCounter) && !this->IsWritten(group, programCounter + 1)) {
+        return this->decodedMemory[programCounter & 0xFFF];
+    }
+
+    const uint8* laneMemory = group.mainMemory[lane];
+
+    Chip8::Decode((laneMemory[programCounter & 0xFFF] << 8) | laneMemory[(programCounter + 1) & 0xFFF], laneInstruction);
+    return laneInstruction;
+}
+
+template <Chip8::QuirkProfile Profile, Batch::ExecutionMode Mode> void Batch::Execute(Group& group, const Chip8::Instruction& instruction, const uint8* selectedLanes, uint onlyLane) {
+    // One instruction over every lane of the group, over the selected ones or over a single lane. For a group the bounds
+    // are constant and the masked stores are blends, which is what lets the compiler turn the register, skip and timer
+    // loops into vector code. Each loop mirrors the matching Chip8 operation, in the same order of reads and writes, so VF
+    // aliasing VX or VY ends the same way. The operations with control flow of their own run lane by lane.
+
+    constexpr bool IsMasked  = Mode == Batch::ExecuteMasked;
+    const uint     beginLane = Mode == Batch::ExecuteLane ? onlyLane : 0;
+    const uint     endLane   = Mode == Batch::ExecuteLane ? onlyLane + 1 : Batch::GroupLanes;
+    const uint     x         = instruction.registerX;
+    const uint     y         = instruction.registerY;
+    const uint     source    = Chip8::Quirks<Profile>::ShiftUsesVY ? y : x;
+
+    switch (instruction.operation) {
+        case Chip8::Operation00E0:
+            for (uint lane = beginLane; lane < endLane; ++lane) {
+                if (IsMasked && !selectedLanes[lane]) {
+                    continue;
+                }
+
+                memset(group.videoMemory[lane], 0, sizeof(group.videoMemory[lane]));
+                group.programCounter[lane] += 2;
+            }
+            break;
+
+        case Chip8::Operation00EE:
+            for (uint lane = beginLane; lane < endLane; ++lane) {
+                if (IsMasked && !selectedLanes[lane]) {
+                    continue;
+                }
+
+                if (group.stackPointer[lane] == 0) {
+                    this->Halt(group, lane);
+                } else {
+                    group.programCounter[lane] = group.callStack[--group.stackPointer[lane]][lane];
+                }
+            }
+            break;
+
+        case Chip8::Operation1NNN:
+            for (uint lane = beginLane; lane < endLane; ++lane) {
+                group.programCounter[lane] = Select<IsMasked>(selectedLanes, lane, instruction.address, group.programCounter[lane]);
+            }
+            break;
+
+        case Chip8::Operation2NNN:
+            for (uint lane = beginLane; lane < endLane; ++lane) {
+                if (IsMasked && !selectedLanes[lane]) {
+                    continue;
+                }
+
+                if (group.stackPointer[lane] >= 15) {
+                    this->Halt(group, lane);
+                } else {
+                    group.callStack[group.stackPointer[lane]++][lane] = group.programCounter[lane] + 2;
+                    group.programCounter[lane]                        = instruction.address;
+                }
+            }
+            break;
+
+        case Chip8::Operation3XNN:
+            for (uint lane = beginLane; lane < endLane; ++lane) {
+                uint16 nextAddress = group.programCounter[lane] + ((group.cpuRegisters[x][lane] == instruction.value) * 2) + 2;
+                group.programCounter[lane] = Select<IsMasked>(selectedLanes, lane, nextAddress, group.programCounter[lane]);
+            }
+            break;
+
+        case Chip8::Operation4XNN:
+            for (uint lane = beginLane; lane < endLane; ++lane) {
+                uint16 nextAddress = group.programCounter[lane] + ((group.cpuRegisters[x][lane] != instruction.value) * 2) + 2;
+                group.programCounter[lane] = Select<IsMasked>(selectedLanes, lane, nextAddress, group.programCounter[lane]);
+            }
+            break;
+
+        case Chip8::Operation5XY0:
+            for (uint lane = beginLane; lane < endLane; ++lane) {
+                uint16 nextAddress = group.programCounter[lane] + ((group.cpuRegisters[x][lane] == group.cpuRegisters[y][lane]) * 2) + 2;
+                group.programCounter[lane] = Select<IsMasked>(selectedLanes, lane, nextAddress, group.programCounter[lane]);
+            }
+            break;
+
+        case Chip8::Operation6XNN:
+            for (uint lane = beginLane; lane < endLane; ++lane) {
+                group.cpuRegisters[x][lane] = Select<IsMasked>(selectedLanes, lane, instruction.value, group.cpuRegisters[x][lane]);
+                group.programCounter[lane]  = Select<IsMasked>(selectedLanes, lane, UINT16(group.programCounter[lane] + 2), group.programCounter[lane]);
+            }
+            break;
+
+        case Chip8::Operation7XNN:
+            for (uint lane = beginLane; lane < endLane; ++lane) {
+                group.cpuRegisters[x][lane] = Select<IsMasked>(selectedLanes, lane, UINT8(group.cpuRegisters[x][lane] + instruction.value), group.cpuRegisters[x][lane]);
+                group.programCounter[lane]  = Select<IsMasked>(selectedLanes, lane, UINT16(group.programCounter[lane] + 2), group.programCounter[lane]);
+            }
+            break;
+
+        case Chip8::Operation8XY0:
+            for (uint lane = beginLane; lane < endLane; ++lane) {
+                group.cpuRegisters[x][lane] = Select<IsMasked>(selectedLanes, lane, group.cpuRegisters[y][lane], group.cpuRegisters[x][lane]);
+                group.programCounter[lane]  = Select<IsMasked>(selectedLanes, lane, UINT16(group.programCounter[lane] + 2), group.programCounter[lane]);
+            }
+            break;
+
+        case Chip8::Operation8XY1:
+            for (uint lane = beginLane; lane < endLane; ++lane) {
+                group.cpuRegisters[x][lane] = Select<IsMasked>(selectedLanes, lane, UINT8(group.cpuRegisters[x][lane] | group.cpuRegisters[y][lane]), group.cpuRegisters[x][lane]);
+
+                if (Chip8::Quirks<Profile>::LogicResetsVF) {
+                    group.cpuRegisters[0xF][lane] = Select<IsMasked>(selectedLanes, lane, UINT8(0), group.cpuRegisters[0xF][lane]);
+                }
+
+                group.programCounter[lane] = Select<IsMasked>(selectedLanes, lane, UINT16(group.programCounter[lane] + 2), group.programCounter[lane]);
+            }
+            break;
+
+        case Chip8::Operation8XY2:
+            for (uint lane = beginLane; lane < endLane; ++lane) {
+                group.cpuRegisters[x][lane] = Select<IsMasked>(selectedLanes, lane, UINT8(group.cpuRegisters[x][lane] & group.cpuRegisters[y][lane]), group.cpuRegisters[x][lane]);
+
+                if (Chip8::Quirks<Profile>::LogicResetsVF) {
+                    group.cpuRegisters[0xF][lane] = Select<IsMasked>(selectedLanes, lane, UINT8(0), group.cpuRegisters[0xF][lane]);
+                }
+
+                group.programCounter[lane] = Select<IsMasked>(selectedLanes, lane, UINT16(group.programCounter[lane] + 2), group.programCounter[lane]);
+            }
+            break;
+
+        case Chip8::Operation8XY3:
+            for (uint lane = beginLane; lane < endLane; ++lane) {
+                group.cpuRegisters[x][lane] = Select<IsMasked>(selectedLanes, lane, UINT8(group.cpuRegisters[x][lane] ^ group.cpuRegisters[y][lane]), group.cpuRegisters[x][lane]);
+
+                if (Chip8::Quirks<Profile>::LogicResetsVF) {
+                    group.cpuRegisters[0xF][lane] = Select<IsMasked>(selectedLanes, lane, UINT8(0), group.cpuRegisters[0xF][lane]);
+                }
+
+                group.programCounter[lane] = Select<IsMasked>(selectedLanes, lane, UINT16(group.programCounter[lane] + 2), group.programCounter[lane]);
+            }
+            break;
+
+        case Chip8::Operation8XY4:
+            for (uint lane = beginLane; lane < endLane; ++lane) {
+                group.cpuRegisters[0xF][lane] = Select<IsMasked>(selectedLanes, lane, UINT8(UINT16(group.cpuRegisters[x][lane] + group.cpuRegisters[y][lane]) > 255), group.cpuRegisters[0xF][lane]);
+                group.cpuRegisters[x][lane]   = Select<IsMasked>(selectedLanes, lane, UINT8(group.cpuRegisters[x][lane] + group.cpuRegisters[y][lane]), group.cpuRegisters[x][lane]);
+                group.programCounter[lane]    = Select<IsMasked>(selectedLanes, lane, UINT16(group.programCounter[lane] + 2), group.programCounter[lane]);
+            }
+            break;
+
+        case Chip8::Operation8XY5:
+            for (uint lane = beginLane; lane < endLane; ++lane) {
+                group.cpuRegisters[0xF][lane] = Select<IsMasked>(selectedLanes, lane, UINT8(!(group.cpuRegisters[x][lane] < group.cpuRegisters[y][lane])), group.cpuRegisters[0xF][lane]);
+                group.cpuRegisters[x][lane]   = Select<IsMasked>(selectedLanes, lane, UINT8(group.cpuRegisters[x][lane] - group.cpuRegisters[y][lane]), group.cpuRegisters[x][lane]);
+                group.programCounter[lane]    = Select<IsMasked>(selectedLanes, lane, UINT16(group.programCounter[lane] + 2), group.programCounter[lane]);
+            }
+            break;
+
+        case Chip8::Operation8XY6:
+            for (uint lane = beginLane; lane < endLane; ++lane) {
+                group.cpuRegisters[0xF][lane] = Select<IsMasked>(selectedLanes, lane, UINT8(group.cpuRegisters[source][lane] & 0x1), group.cpuRegisters[0xF][lane]);
+                group.cpuRegisters[x][lane]   = Select<IsMasked>(selectedLanes, lane, UINT8(group.cpuRegisters[source][lane] >> 1), group.cpuRegisters[x][lane]);
+                group.programCounter[lane]    = Select<IsMasked>(selectedLanes, lane, UINT16(group.programCounter[lane] + 2), group.programCounter[lane]);
+            }
+            break;
+
+        case Chip8::Operation8XY7:
+            for (uint lane = beginLane; lane < endLane; ++lane) {
+                group.cpuRegisters[0xF][lane] = Select<IsMasked>(selectedLanes, lane, UINT8(!(group.cpuRegisters[y][lane] < group.cpuRegisters[x][lane])), group.cpuRegisters[0xF][lane]);
+                group.cpuRegisters[x][lane]   = Select<IsMasked>(selectedLanes, lane, UINT8(group.cpuRegisters[y][lane] - group.cpuRegisters[x][lane]), group.cpuRegisters[x][lane]);
+                group.programCounter[lane]    = Select<IsMasked>(selectedLanes, lane, UINT16(group.programCounter[lane] + 2), group.programCounter[lane]);
+            }
+            break;
+
+        case Chip8::Operation8XYE:
+            for (uint lane = beginLane; lane < endLane; ++lane) {
+                group.cpuRegisters[0xF][lane] = Select<IsMasked>(selectedLanes, lane, UINT8(group.cpuRegisters[source][lane] >> 7), group.cpuRegisters[0xF][lane]);
+                group.cpuRegisters[x][lane]   = Select<IsMasked>(selectedLanes, lane, UINT8(group.cpuRegisters[source][lane] << 1), group.cpuRegisters[x][lane]);
+                group.programCounter[lane]    = Select<IsMasked>(selectedLanes, lane, UINT16(group.programCounter[lane] + 2), group.programCounter[lane]);
+            }
+            break;
+
+        case Chip8::Operation9XY0:
+            for (uint lane = beginLane; lane < endLane; ++lane) {
+                uint16 nextAddress = group.programCounter[lane] + ((group.cpuRegisters[x][lane] != group.cpuRegisters[y][lane]) * 2) + 2;
+                group.programCounter[lane] = Select<IsMasked>(selectedLanes, lane, nextAddress, group.programCounter[lane]);
+            }
+            break;
+
+        case Chip8::OperationANNN:
+            for (uint lane = beginLane; lane < endLane; ++lane) {
+                group.addressRegister[lane] = Select<IsMasked>(selectedLanes, lane, UINT32(instruction.address), group.addressRegister[lane]);
+                group.programCounter[lane]  = Select<IsMasked>(selectedLanes, lane, UINT16(group.programCounter[lane] + 2), group.programCounter[lane]);
+            }
+            break;
+
+        case Chip8::OperationBNNN:
+            for (uint lane = beginLane; lane < endLane; ++lane) {
+                uint16 jumpAddress = instruction.address + group.cpuRegisters[Chip8::Quirks<Profile>::JumpUsesVX ? x : 0][lane];
+                group.programCounter[lane] = Select<IsMasked>(selectedLanes, lane, jumpAddress, group.programCounter[lane]);
+            }
+            break;
+
+        case Chip8::OperationCXNN:
+            for (uint lane = beginLane; lane < endLane; ++lane) {
+                uint32 randomState = group.randomState[lane];
+
+                randomState ^= randomState << 13;
+                randomState ^= randomState >> 17;
+                randomState ^= randomState << 5;
+
+                group.randomState[lane]     = Select<IsMasked>(selectedLanes, lane, randomState, group.randomState[lane]);
+                group.cpuRegisters[x][lane] = Select<IsMasked>(selectedLanes, lane, UINT8((randomState >> 24) & instruction.value), group.cpuRegisters[x][lane]);
+                group.programCounter[lane]  = Select<IsMasked>(selectedLanes, lane, UINT16(group.programCounter[lane] + 2), group.programCounter[lane]);
+            }
+            break;
+
+        case Chip8::OperationDXYN:
+            for (uint lane = beginLane; lane < endLane; ++lane) {
+                if (!IsMasked || selectedLanes[lane]) {
+                    this->DrawSprite<Profile>(group, lane, instruction);
+                }
+            }
+            break;
+
+        case Chip8::OperationEX9E:
+            for (uint lane = beginLane; lane < endLane; ++lane) {
+                uint16 nextAddress = group.programCounter[lane] + 2 + (((group.keyStates[lane] >> (group.cpuRegisters[x][lane] & 0xF)) & 0x1) << 1);
+                group.programCounter[lane] = Select<IsMasked>(selectedLanes, lane, nextAddress, group.programCounter[lane]);
+            }
+            break;
+
+        case Chip8::OperationEXA1:
+            for (uint lane = beginLane; lane < endLane; ++lane) {
+                uint16 nextAddress = group.programCounter[lane] + 4 - (((group.keyStates[lane] >> (group.cpuRegisters[x][lane] & 0xF)) & 0x1) << 1);
+                group.programCounter[lane] = Select<IsMasked>(selectedLanes, lane, nextAddress, group.programCounter[lane]);
+            }
+            break;
+
+        case Chip8::OperationFX07:
+            for (uint lane = beginLane; lane < endLane; ++lane) {
+                group.cpuRegisters[x][lane] = Select<IsMasked>(selectedLanes, lane, group.delayTimer[lane], group.cpuRegisters[x][lane]);
+                group.programCounter[lane]  = Select<IsMasked>(selectedLanes, lane, UINT16(group.programCounter[lane] + 2), group.programCounter[lane]);
+            }
+            break;
+
+        case Chip8::OperationFX0A:
+            // A waiting lane runs FX0A again at every step, where a single machine idles to the end of the frame; both
+            // come out of the frame in the same state.
+
+            for (uint lane = beginLane; lane < endLane; ++lane) {
+                if (IsMasked && !selectedLanes[lane]) {
+                    continue;
+                }
+
+                if (!group.isWaitingForKey[lane]) {
+                    group.pressedKeys[lane]     = 0;
+                    group.isWaitingForKey[lane] = 1;
+                } else if (group.pressedKeys[lane]) {
+                    group.cpuRegisters[x][lane] = __builtin_ctz(group.pressedKeys[lane]);
+                    group.pressedKeys[lane]     = 0;
+                    group.isWaitingForKey[lane] = 0;
+                    group.programCounter[lane] += 2;
+                }
+            }
+            break;
+
+        case Chip8::OperationFX15:
+            for (uint lane = beginLane; lane < endLane; ++lane) {
+                group.delayTimer[lane]     = Select<IsMasked>(selectedLanes, lane, group.cpuRegisters[x][lane], group.delayTimer[lane]);
+                group.programCounter[lane] = Select<IsMasked>(selectedLanes, lane, UINT16(group.programCounter[lane] + 2), group.programCounter[lane]);
+            }
+            break;
+
+        case Chip8::OperationFX18:
+            for (uint lane = beginLane; lane < endLane; ++lane) {
+                group.soundTimer[lane]     = Select<IsMasked>(selectedLanes, lane, group.cpuRegisters[x][lane], group.soundTimer[lane]);
+                group.programCounter[lane] = Select<IsMasked>(selectedLanes, lane, UINT16(group.programCounter[lane] + 2), group.programCounter[lane]);
+            }
+            break;
+
+        case Chip8::OperationFX1E:
+            for (uint lane = beginLane; lane < endLane; ++lane) {
+                group.addressRegister[lane] = Select<IsMasked>(selectedLanes, lane, (group.addressRegister[lane] + group.cpuRegisters[x][lane]) & Chip8::AddressMask, group.addressRegister[lane]);
+                group.programCounter[lane]  = Select<IsMasked>(selectedLanes, lane, UINT16(group.programCounter[lane] + 2), group.programCounter[lane]);
+            }
+            break;
+
+        case Chip8::OperationFX29:
+            for (uint lane = beginLane; lane < endLane; ++lane) {
+                group.addressRegister[lane] = Select<IsMasked>(selectedLanes, lane, UINT32(Chip8::FontStartAddress + (group.cpuRegisters[x][lane] * 5)), group.addressRegister[lane]);
+                group.programCounter[lane]  = Select<IsMasked>(selectedLanes, lane, UINT16(group.programCounter[lane] + 2), group.programCounter[lane]);
+            }
+            break;
+
+        case Chip8::OperationFX33:
+            for (uint lane = beginLane; lane < endLane; ++lane) {
+                if (IsMasked && !selectedLanes[lane]) {
+                    continue;
+                }
+
+                uint32 storeAddress  = group.addressRegister[lane];
+                uint8  registerValue = group.cpuRegisters[x][lane];
+
+                group.mainMemory[lane][storeAddress & 0xFFF]       = registerValue / 100;
+                group.mainMemory[lane][(storeAddress + 1) & 0xFFF] = (registerValue % 100) / 10;
+                group.mainMemory[lane][(storeAddress + 2) & 0xFFF] = (registerValue % 100) % 10;
+
+                this->MarkWritten(group, storeAddress);
+                this->MarkWritten(group, storeAddress + 1);
+                this->MarkWritten(group, storeAddress + 2);
+                group.programCounter[lane] += 2;
+            }
+            break;
+
+        case Chip8::OperationFX55:
+            for (uint lane = beginLane; lane < endLane; ++lane) {
+                if (IsMasked && !selectedLanes[lane]) {
+                    continue;
+                }
+
+                uint32 storeAddress = group.addressRegister[lane];
+
+                for (uint registerIndex = 0; registerIndex <= x; ++registerIndex) {
+                    group.mainMemory[lane][(storeAddress + registerIndex) & 0xFFF] = group.cpuRegisters[registerIndex][lane];
+                    this->MarkWritten(group, storeAddress + registerIndex);
+                }
+
+                if (Chip8::Quirks<Profile>::MemoryIncrement != Chip8::IncrementNone) {
+                    group.addressRegister[lane] = (storeAddress + x + (Chip8::Quirks<Profile>::MemoryIncrement == Chip8::IncrementXPlusOne)) & Chip8::AddressMask;
+                }
+
+                group.programCounter[lane] += 2;
+            }
+            break;
+
+        case Chip8::OperationFX65:
+            for (uint lane = beginLane; lane < endLane; ++lane) {
+                if (IsMasked && !selectedLanes[lane]) {
+                    continue;
+                }
+
+                uint32 loadAddress = group.addressRegister[lane];
+
+                for (uint registerIndex = 0; registerIndex <= x; ++registerIndex) {
+                    group.cpuRegisters[registerIndex][lane] = group.mainMemory[lane][(loadAddress + registerIndex) & 0xFFF];
+                }
+
+                if (Chip8::Quirks<Profile>::MemoryIncrement != Chip8::IncrementNone) {
+                    group.addressRegister[lane] = (loadAddress + x + (Chip8::Quirks<Profile>::MemoryIncrement == Chip8::IncrementXPlusOne)) & Chip8::AddressMask;
+                }
+
+                group.programCounter[lane] += 2;
+            }
+            break;
+
+        default:
+            // Unknown, 00FD and the SUPER-CHIP and MEGA-CHIP instructions: the lane stops where it is.
+
+            for (uint lane = beginLane; lane < endLane; ++lane) {
+                if (!IsMasked || selectedLanes[lane]) {
+                    this->Halt(group, lane);
+                }
+            }
+            break;
+    }
+}
+
+template <Chip8::QuirkProfile Profile> inline void Batch::DrawSprite(Group& group, uint lane, const Chip8::Instruction& instruction) {
+    // The low resolution half of Chip8::DrawSprite, one word per row.
+
+    const uint8* laneMemory    = group.mainMemory[lane];
+    uint64*      videoMemory   = group.videoMemory[lane];
+    uint32       lineAddress   = group.addressRegister[lane];
+    uint         xPosition     = group.cpuRegisters[instruction.registerX][lane] % Chip8::ScreenWidth;
+    uint         yPosition     = group.cpuRegisters[instruction.registerY][lane] % Chip8::ScreenHeight;
+    bool         isLargeSprite = (instruction.nibble == 0) && Chip8::Quirks<Profile>::LargeSprites;
+    uint         numberOfLines = isLargeSprite ? 16 : instruction.nibble;
+    uint64       collisionMask = 0;
+
+    if (Chip8::Quirks<Profile>::SpritesClip && ((yPosition + numberOfLines) > Chip8::ScreenHeight)) {
+        numberOfLines = Chip8::ScreenHeight - yPosition;
+    }
+
+    for (uint8 spriteLine = 0; spriteLine < numberOfLines; ++spriteLine) {
+        uint64 lineBits = UINT64(laneMemory[lineAddress++ & 0xFFF]) << 56;
+
+        if (isLargeSprite) {
+            lineBits |= UINT64(laneMemory[lineAddress++ & 0xFFF]) << 48;
+        }
+
+        uint64 leftBits  = lineBits >> xPosition;
+        uint64 rightBits = Chip8::Quirks<Profile>::SpritesClip || (xPosition == 0) ? 0 : lineBits << (64 - xPosition);
+
+        collisionMask |= videoMemory[yPosition] & (leftBits | rightBits);
+        videoMemory[yPosition] ^= leftBits | rightBits;
+        yPosition = (yPosition + 1) % Chip8::ScreenHeight;
+    }
+
+    group.cpuRegisters[0xF][lane] = collisionMask != 0;
+    group.programCounter[lane] += 2;
+}
+
+void Batch::Tick(Group& group) {
+    for (uint lane = 0; lane < Batch::GroupLanes; ++lane) {
+        uint8 isLive = group.isHalted[lane] ^ 1;
+
+        group.soundTimer[lane] -= (group.soundTimer[lane] != 0) & isLive;
+        group.delayTimer[lane] -= (group.delayTimer[lane] != 0) & isLive;
+    }
+}
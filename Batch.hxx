@@ -0,0 +1,125 @@
+/*
+ * Batch.hxx
+ *
+ * This file is part of the Chip8++ source code.
+ * Copyright 2023 Patrick Melo <patrick@patrickmelo.com.br>
+ */
+
+#ifndef CHIP8_BATCH_H
+#define CHIP8_BATCH_H
+
+#include "Chip8.hxx"
+#include "Core.hxx"
+
+// Batch (many machines running one program in lockstep, one SIMD lane per machine)
+
+class Batch {
+    public:
+        Batch(void);
+        ~Batch();
+
+        // Constants
+        static constexpr charconst Tag = "Batch";
+
+#if defined(__AVX512BW__)
+        static constexpr uint GroupLanes = 64;    // Machines per group, a vector of bytes
+#else
+        static constexpr uint GroupLanes = 32;
+#endif
+
+        struct Statistics {
+                uint64 retiredInstructions;    // Across every machine
+                uint64 groupSteps;             // Steps where the whole group shared one instruction
+                uint64 maskedPasses;           // Passes over the group for the lanes at one address, when they did not
+                uint64 maskedInstructions;     // Instructions retired by those passes
+                uint64 laneInstructions;       // Instructions retired by lanes running on their own, once scattered
+        };
+
+        // General (classic CHIP-8 only; SUPER-CHIP and MEGA-CHIP instructions halt the machine that runs them)
+        bool Initialize(const Chip8::RAM& programMemory, uint numberOfMachines, Chip8::QuirkProfile quirkProfile);
+        void Finalize(void);
+        void Reset(void);
+        void SetCpuRate(uint instructionsPerSecond);
+        void SetInstructionsPerFrame(uint instructionsPerFrame);
+        void SetRandomSeed(uint machineIndex, uint32 newSeed);    // Takes effect at the next reset
+        void SetKey(uint machineIndex, uint8 keyIndex, bool isPressed);
+
+        // CPU
+        uint64 RunFrames(uint64 numberOfFrames);
+
+        // Machines
+        uint         GetNumberOfMachines(void) const;
+        bool         IsHalted(uint machineIndex) const;
+        uint16       GetProgramCounter(uint machineIndex) const;
+        uint32       GetAddressRegister(uint machineIndex) const;
+        uint8        GetRegister(uint machineIndex, uint registerIndex) const;
+        const uint8* GetMemory(uint machineIndex) const;
+        void         GetVRAM(uint machineIndex, Chip8::VRAM& videoMemory) const;                   // Only the first 32 words are drawn
+        uint         SaveState(uint machineIndex, uint8* stateBuffer, uint bufferSize) const;    // Chip8::LoadState takes it, between frames
+
+        // Statistics
+        const Statistics& GetStatistics(void) const;
+
+    private:
+        // Machines (struct of arrays, the lane is always the last index so each operation walks contiguous bytes)
+        struct Group {
+                uint8  cpuRegisters[16][GroupLanes];
+                uint32 addressRegister[GroupLanes];
+                uint16 programCounter[GroupLanes];
+                uint8  stackPointer[GroupLanes];
+                uint16 callStack[16][GroupLanes];
+                uint8  delayTimer[GroupLanes];
+                uint8  soundTimer[GroupLanes];
+                uint32 randomSeed[GroupLanes];
+                uint32 randomState[GroupLanes];
+                uint16 keyStates[GroupLanes];
+                uint16 pressedKeys[GroupLanes];
+                uint8  isWaitingForKey[GroupLanes];
+                uint8  isHalted[GroupLanes];                       // Also set on the unused lanes of the last group
+                uint32 stopCycle[GroupLanes];                      // Where in its frame the lane halted
+                uint64 writtenMemory[sizeof(Chip8::RAM) / 64];    // Addresses some lane stored to, the lanes may disagree there
+                uint64 videoMemory[GroupLanes][Chip8::ScreenHeight];
+                uint8  mainMemory[GroupLanes][sizeof(Chip8::RAM)];
+                uint   frameCycle;                                 // The step of the frame being run, the same for every lane
+        };
+
+        Group**             groups;
+        uint                numberOfGroups;
+        uint                numberOfMachines;
+        Chip8::QuirkProfile quirkProfile;
+        uint                instructionsPerFrame;
+        Chip8::RAM          programMemory;
+        Chip8::Instruction  decodedMemory[sizeof(Chip8::RAM)];    // The program as loaded, valid wherever no lane stored
+        Statistics          statistics;
+
+        inline bool IsWritten(const Group& group, uint16 address) const {
+            return (group.writtenMemory[(address & 0xFFF) >> 6] >> (address & 63)) & 1;
+        }
+
+        inline void MarkWritten(Group& group, uint16 address) {
+            group.writtenMemory[(address & 0xFFF) >> 6] |= UINT64(1) << (address & 63);
+        }
+
+        void ResetGroup(Group& group);
+
+        // Execution
+        enum ExecutionMode {
+            ExecuteGroup,     // Every lane, all at the same address
+            ExecuteMasked,    // The selected lanes
+            ExecuteLane       // A single lane
+        };
+
+        static constexpr uint ScatteredPasses = GroupLanes / 4;    // Beyond this many passes in a step the lanes run on their own
+
+        void                      Halt(Group& group, uint lane);
+        const Chip8::Instruction& FetchInstruction(const Group& group, uint lane, Chip8::Instruction& laneInstruction) const;
+
+        template <Chip8::QuirkProfile Profile> void RunGroup(Group& group, uint64 numberOfFrames);
+        template <Chip8::QuirkProfile Profile> uint Step(Group& group);
+        template <Chip8::QuirkProfile Profile> void RunLanes(Group& group, uint firstCycle);
+        template <Chip8::QuirkProfile Profile, ExecutionMode Mode> void Execute(Group& group, const Chip8::Instruction& instruction, const uint8* selectedLanes, uint onlyLane);
+        template <Chip8::QuirkProfile Profile> void DrawSprite(Group& group, uint lane, const Chip8::Instruction& instruction);
+        void Tick(Group& group);
+};
+
+#endif    // CHIP8_BATCH_H
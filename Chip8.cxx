@@ -6,6 +6,14 @@
  */
 
 #include "Chip8.hxx"
+#include "Recompiler.hxx"
+#include "Rewind.hxx"
+#include "Tracer.hxx"
+#include "Translation.hxx"
+
+#include <chrono>
+
+#include <sys/stat.h>
 
 // Contants
 
@@ -14,58 +22,155 @@ const uint8 DefaultFontData[80] =
         0xF0, 0x90, 0x90, 0x90, 0xF0,
         0x20, 0x60, 0x20, 0x20, 0x70,
         0xF0, 0x10, 0xF0, 0x80, 0xF0,
-        0xF0, 0x10, 0xF0, 0x80, 0xF0,
-        0xF0, 0x10, 0xF0, 0x80, 0xF0,
-        0xF0, 0x10, 0xF0, 0x80, 0xF0,
-        0xF0, 0x10, 0xF0, 0x80, 0xF0,
-        0xF0, 0x10, 0xF0, 0x80, 0xF0,
-        0xF0, 0x10, 0xF0, 0x80, 0xF0,
-        0xF0, 0x10, 0xF0, 0x80, 0xF0,
-        0xF0, 0x10, 0xF0, 0x80, 0xF0,
-        0xF0, 0x10, 0xF0, 0x80, 0xF0,
-        0xF0, 0x10, 0xF0, 0x80, 0xF0,
-        0xF0, 0x10, 0xF0, 0x80, 0xF0,
-        0xF0, 0x10, 0xF0, 0x80, 0xF0,
-        0xF0, 0x10, 0xF0, 0x80, 0xF0};
+        0xF0, 0x10, 0xF0, 0x10, 0xF0,
+        0x90, 0x90, 0xF0, 0x10, 0x10,
+        0xF0, 0x80, 0xF0, 0x10, 0xF0,
+        0xF0, 0x80, 0xF0, 0x90, 0xF0,
+        0xF0, 0x10, 0x20, 0x40, 0x40,
+        0xF0, 0x90, 0xF0, 0x90, 0xF0,
+        0xF0, 0x90, 0xF0, 0x10, 0xF0,
+        0xF0, 0x90, 0xF0, 0x90, 0x90,
+        0xE0, 0x90, 0xE0, 0x90, 0xE0,
+        0xF0, 0x80, 0x80, 0x80, 0xF0,
+        0xE0, 0x90, 0x90, 0x90, 0xE0,
+        0xF0, 0x80, 0xF0, 0x80, 0xF0,
+        0xF0, 0x80, 0xF0, 0x80, 0x80};
+
+const uint8 LargeFontData[160] =
+    {
+        0xFF, 0xFF, 0xC3, 0xC3, 0xC3, 0xC3, 0xC3, 0xC3, 0xFF, 0xFF,
+        0x18, 0x78, 0x78, 0x18, 0x18, 0x18, 0x18, 0x18, 0xFF, 0xFF,
+        0xFF, 0xFF, 0x03, 0x03, 0xFF, 0xFF, 0xC0, 0xC0, 0xFF, 0xFF,
+        0xFF, 0xFF, 0x03, 0x03, 0xFF, 0xFF, 0x03, 0x03, 0xFF, 0xFF,
+        0xC3, 0xC3, 0xC3, 0xC3, 0xFF, 0xFF, 0x03, 0x03, 0x03, 0x03,
+        0xFF, 0xFF, 0xC0, 0xC0, 0xFF, 0xFF, 0x03, 0x03, 0xFF, 0xFF,
+        0xFF, 0xFF, 0xC0, 0xC0, 0xFF, 0xFF, 0xC3, 0xC3, 0xFF, 0xFF,
+        0xFF, 0xFF, 0x03, 0x03, 0x06, 0x0C, 0x18, 0x18, 0x18, 0x18,
+        0xFF, 0xFF, 0xC3, 0xC3, 0xFF, 0xFF, 0xC3, 0xC3, 0xFF, 0xFF,
+        0xFF, 0xFF, 0xC3, 0xC3, 0xFF, 0xFF, 0x03, 0x03, 0xFF, 0xFF,
+        0x7E, 0xFF, 0xC3, 0xC3, 0xC3, 0xFF, 0xFF, 0xC3, 0xC3, 0xC3,
+        0xFC, 0xFC, 0xC3, 0xC3, 0xFC, 0xFC, 0xC3, 0xC3, 0xFC, 0xFC,
+        0x3C, 0xFF, 0xC3, 0xC0, 0xC0, 0xC0, 0xC0, 0xC3, 0xFF, 0x3C,
+        0xFC, 0xFE, 0xC3, 0xC3, 0xC3, 0xC3, 0xC3, 0xC3, 0xFE, 0xFC,
+        0xFF, 0xFF, 0xC0, 0xC0, 0xFF, 0xFF, 0xC0, 0xC0, 0xFF, 0xFF,
+        0xFF, 0xFF, 0xC0, 0xC0, 0xFF, 0xFF, 0xC0, 0xC0, 0xC0, 0xC0};
+
+// State Helpers
+
+static inline void WriteState(uint8*& stateCursor, const void* fieldData, uint fieldSize) {
+    memcpy(stateCursor, fieldData, fieldSize);
+    stateCursor += fieldSize;
+}
+
+static inline void ReadState(const uint8*& stateCursor, void* fieldData, uint fieldSize) {
+    memcpy(fieldData, stateCursor, fieldSize);
+    stateCursor += fieldSize;
+}
+
+// Blitter Helpers
+
+static inline uint64 OpaqueMask(uint64 spritePixels) {
+    // 0xFF in every byte that holds a non-zero palette index, without a branch per pixel.
+
+    uint64 nonZeroBits = (((spritePixels & UINT64(0x7F7F7F7F7F7F7F7F)) + UINT64(0x7F7F7F7F7F7F7F7F)) | spritePixels) & UINT64(0x8080808080808080);
+    return (nonZeroBits >> 7) * 0xFF;
+}
+
+static inline bool BlitRow(uint8* screenLine, const uint8* spriteLine, uint numberOfPixels) {
+    // Index 0 is transparent, every other index replaces the screen pixel. Eight pixels at a time, the rest one by one.
+
+    uint64 collisionBits = 0;
+    uint   pixelIndex    = 0;
+
+    for (; (pixelIndex + 8) <= numberOfPixels; pixelIndex += 8) {
+        uint64 spritePixels, screenPixels;
+
+        memcpy(&spritePixels, spriteLine + pixelIndex, 8);
+        memcpy(&screenPixels, screenLine + pixelIndex, 8);
+
+        uint64 opaqueMask = OpaqueMask(spritePixels);
+        collisionBits |= screenPixels & opaqueMask;
+        screenPixels = (screenPixels & ~opaqueMask) | spritePixels;
+
+        memcpy(screenLine + pixelIndex, &screenPixels, 8);
+    }
+
+    for (; pixelIndex < numberOfPixels; ++pixelIndex) {
+        if (spriteLine[pixelIndex]) {
+            collisionBits |= screenLine[pixelIndex];
+            screenLine[pixelIndex] = spriteLine[pixelIndex];
+        }
+    }
+
+    return collisionBits != 0;
+}
 
 // Chip8
 
 Chip8::Chip8(void) :
     addressRegister(0),
-    cpuWait(false),
-    mainMemory(NULL),
-    videoMemory(NULL),
+    memoryPages(NULL),
+    numberOfPages(0),
+    memoryMask(0),
+    sharedMemory(NULL),
+    isExtendedScreen(false),
+    isMegaChip(false),
+    megaChip(NULL),
     isRunning(false),
+    stopReason(Chip8::Stopped),
+    frameCycles(0),
+    instructionsPerFrame(Chip8::DefaultCpuRate / Chip8::FrameRate),
     programCounter(0),
     stackPointer(0),
     opCode(0),
+    randomSeed(Chip8::DefaultRandomSeed),
+    randomState(Chip8::DefaultRandomSeed),
+    isIdleSkipping(true),
+    isIdle(false),
     delayTimer(0),
     soundTimer(0),
-    currentInterface(NULL) {
+    isBeeping(false),
+    currentEngine(Chip8::Interpreter),
+    quirkProfile(Chip8::QuirksVIP),
+    decodedMemory(NULL),
+    recompiler(NULL),
+    translation(NULL),
+    currentInterface(NULL),
+    keyStates(0),
+    pressedKeys(0),
+    pressTime(0),
+    isWaitingForKey(false),
+    currentAudio(NULL),
+    currentRewind(NULL),
+    currentTracer(NULL) {
     memset(this->cpuRegisters, 0, sizeof(this->cpuRegisters));
+    memset(this->flagRegisters, 0, sizeof(this->flagRegisters));
     memset(this->callStack, 0, sizeof(this->callStack));
+    memset(this->videoMemory, 0, sizeof(this->videoMemory));
+    memset(&this->dirtyRegion, 0, sizeof(this->dirtyRegion));
+    memset(&this->idleLoop, 0, sizeof(this->idleLoop));
+    memset(&this->idleStatistics, 0, sizeof(this->idleStatistics));
+
+    this->MarkDirty(0, Chip8::ScreenHeight - 1);
+}
 
-    this->operationsTable[0x0] = &Chip8::Op0x0;
-    this->operationsTable[0x1] = &Chip8::Op0x1;
-    this->operationsTable[0x2] = &Chip8::Op0x2;
-    this->operationsTable[0x3] = &Chip8::Op0x3;
-    this->operationsTable[0x4] = &Chip8::Op0x4;
-    this->operationsTable[0x5] = &Chip8::Op0x5;
-    this->operationsTable[0x6] = &Chip8::Op0x6;
-    this->operationsTable[0x7] = &Chip8::Op0x7;
-    this->operationsTable[0x8] = &Chip8::Op0x8;
-    this->operationsTable[0x9] = &Chip8::Op0x9;
-    this->operationsTable[0xA] = &Chip8::Op0xA;
-    this->operationsTable[0xB] = &Chip8::Op0xB;
-    this->operationsTable[0xC] = &Chip8::Op0xC;
-    this->operationsTable[0xD] = &Chip8::Op0xD;
-    this->operationsTable[0xE] = &Chip8::Op0xE;
-    this->operationsTable[0xF] = &Chip8::Op0xF;
+Chip8::~Chip8() {
+    this->ReleasePages();
+
+    delete[] this->memoryPages;
+    delete[] this->decodedMemory;
+    delete this->recompiler;
+    delete this->translation;
+    delete this->megaChip;
 }
 
 // Utilities
 
 bool Chip8::LoadProgram(const string filePath, RAM& programMemory) {
+    return Chip8::LoadProgram(filePath, programMemory, sizeof(RAM));
+}
+
+bool Chip8::LoadProgram(const string filePath, uint8* programMemory, uint32 memorySize) {
     FILE* programFile = fopen(filePath.c_str(), "rb");
 
     if (!programFile) {
@@ -74,543 +179,2054 @@ bool Chip8::LoadProgram(const string filePath, RAM& programMemory) {
     }
 
     fseeko(programFile, 0, SEEK_END);
-    uint fileSize = ftello(programFile);
+    off_t fileSize = ftello(programFile);
     fseeko(programFile, 0, SEEK_SET);
 
+    if ((fileSize <= 0) || (fileSize > (memorySize - Chip8::ProgramStartAddress))) {
+        Error(Chip8::Tag, "The program does not fit in %u bytes of memory.", memorySize);
+        fclose(programFile);
+        return false;
+    }
+
     if (fread(&programMemory[Chip8::ProgramStartAddress], fileSize, 1, programFile) != 1) {
         Error(Chip8::Tag, "Could not read the program file.");
         fclose(programFile);
         return false;
     }
 
-    memcpy(&programMemory[Chip8::FontStartAddress], DefaultFontData, sizeof(DefaultFontData));
+    Chip8::LoadFonts(programMemory);
 
     fclose(programFile);
     Info(Chip8::Tag, "Program loaded from %s", filePath.c_str());
     return true;
 }
 
-// CPU
+void Chip8::LoadFonts(uint8* programMemory) {
+    memcpy(&programMemory[Chip8::FontStartAddress], DefaultFontData, sizeof(DefaultFontData));
+    memcpy(&programMemory[Chip8::LargeFontStartAddress], LargeFontData, sizeof(LargeFontData));
+}
 
-void Chip8::Run(void) {
-    if (!this->currentInterface) {
-        Error(Chip8::Tag, "Cannot run without an interface.");
-        return;
-    }
+uint32 Chip8::GetMemorySize(const string filePath) {
+    struct stat fileStatus;
 
-    if ((!this->mainMemory) || (!this->videoMemory)) {
-        Error(Chip8::Tag, "Cannot run without RAM and VRAM.");
-        return;
+    if (stat(filePath.c_str(), &fileStatus) != 0) {
+        Error(Chip8::Tag, "Could not open the program file.");
+        return 0;
     }
 
-    this->Reset();
-    this->isRunning = true;
-
-    while (this->isRunning) {
-        this->Tick();
+    return Chip8::GetMemorySize(UINT64(fileStatus.st_size));
+}
 
-        if (this->cpuWait) {
-            continue;
-        }
+uint32 Chip8::GetMemorySize(uint64 programSize) {
+    uint64 memorySize = sizeof(RAM);
 
-        // Execute the next opCode
+    while (memorySize < (Chip8::ProgramStartAddress + programSize)) {
+        memorySize <<= 1;
+    }
 
-        this->opCode = ((*this->mainMemory)[this->programCounter] << 8) | ((*this->mainMemory)[this->programCounter + 1]);
-        (this->*operationsTable[this->opCode >> 12])();
-        this->cpuWait = true;
+    if (memorySize > Chip8::MaximumMemorySize) {
+        Error(Chip8::Tag, "The program is larger than %u bytes.", Chip8::MaximumMemorySize - Chip8::ProgramStartAddress);
+        return 0;
     }
-}
 
-void Chip8::Stop(void) {
-    this->isRunning = false;
+    return memorySize;
 }
 
-void Chip8::Reset(void) {
-    this->addressRegister = 0;
-    this->programCounter  = Chip8::ProgramStartAddress;
-    this->stackPointer    = 0;
-    this->opCode          = 0;
-    this->delayTimer      = 0;
-    this->soundTimer      = 0;
-    this->cpuWait         = false;
+Chip8::QuirkProfile Chip8::DetectQuirkProfile(const string filePath, const uint8* programMemory) {
+    // SUPER-CHIP programs are named .sc8 by convention, or give themselves away with the high resolution and exit
+    // instructions (MEGA-CHIP programs build on them). Everything else is taken as a COSMAC VIP program.
 
-    gettimeofday(&(this)->lastTick, NULL);
-    gettimeofday(&(this)->lastCpuTick, NULL);
+    size_t extensionStart = filePath.find_last_of('.');
 
-    memset(this->cpuRegisters, 0, sizeof(this->cpuRegisters));
-    memset(this->callStack, 0, sizeof(this->callStack));
-    memset(*this->videoMemory, 0, sizeof(*this->videoMemory));
-}
+    if ((extensionStart != string::npos) && (strcasecmp(filePath.c_str() + extensionStart, ".sc8") == 0)) {
+        return Chip8::QuirksSCHIP;
+    }
 
-// Memory
+    if ((extensionStart != string::npos) && (strcasecmp(filePath.c_str() + extensionStart, ".c48") == 0)) {
+        return Chip8::QuirksCHIP48;
+    }
 
-void Chip8::SetRAM(RAM* mainMemory) {
-    this->mainMemory = mainMemory;
-}
+    for (uint address = Chip8::ProgramStartAddress; address < (sizeof(RAM) - 1); address += 2) {
+        uint16 opCode = (programMemory[address] << 8) | programMemory[address + 1];
 
-void Chip8::SetVRAM(VRAM* videoMemory) {
-    this->videoMemory = videoMemory;
-}
+        if ((opCode == 0x00FD) || (opCode == 0x00FE) || (opCode == 0x00FF) || (opCode == 0x0011)) {
+            return Chip8::QuirksSCHIP;
+        }
+    }
 
-// Interface
+    return Chip8::QuirksVIP;
+}
 
-void Chip8::SetInterface(Interface* newInterface) {
-    this->currentInterface = newInterface;
+void Chip8::Disassemble(uint16 opCode, char* textBuffer, uint bufferSize) {
+    Instruction decodedInstruction;
+    Chip8::Decode(opCode, decodedInstruction);
+
+    uint registerX = decodedInstruction.registerX;
+    uint registerY = decodedInstruction.registerY;
+
+    switch (decodedInstruction.operation) {
+        case Chip8::Operation00E0: snprintf(textBuffer, bufferSize, "CLS"); break;
+        case Chip8::Operation00EE: snprintf(textBuffer, bufferSize, "RTS"); break;
+        case Chip8::Operation00BN: snprintf(textBuffer, bufferSize, "SCU $%x", decodedInstruction.nibble); break;
+        case Chip8::Operation00CN: snprintf(textBuffer, bufferSize, "SCD $%x", decodedInstruction.nibble); break;
+        case Chip8::Operation00FB: snprintf(textBuffer, bufferSize, "SCR"); break;
+        case Chip8::Operation00FC: snprintf(textBuffer, bufferSize, "SCL"); break;
+        case Chip8::Operation00FD: snprintf(textBuffer, bufferSize, "EXIT"); break;
+        case Chip8::Operation00FE: snprintf(textBuffer, bufferSize, "LOW"); break;
+        case Chip8::Operation00FF: snprintf(textBuffer, bufferSize, "HIGH"); break;
+        case Chip8::Operation0010: snprintf(textBuffer, bufferSize, "MEGAOFF"); break;
+        case Chip8::Operation0011: snprintf(textBuffer, bufferSize, "MEGAON"); break;
+        case Chip8::Operation01NN: snprintf(textBuffer, bufferSize, "LDHI $%02x", decodedInstruction.value); break;
+        case Chip8::Operation02NN: snprintf(textBuffer, bufferSize, "LDPAL $%02x", decodedInstruction.value); break;
+        case Chip8::Operation03NN: snprintf(textBuffer, bufferSize, "SPRW $%02x", decodedInstruction.value); break;
+        case Chip8::Operation04NN: snprintf(textBuffer, bufferSize, "SPRH $%02x", decodedInstruction.value); break;
+        case Chip8::Operation05NN: snprintf(textBuffer, bufferSize, "ALPHA $%02x", decodedInstruction.value); break;
+        case Chip8::Operation060N: snprintf(textBuffer, bufferSize, "DIGISND $%x", decodedInstruction.nibble); break;
+        case Chip8::Operation0700: snprintf(textBuffer, bufferSize, "STOPSND"); break;
+        case Chip8::Operation080N: snprintf(textBuffer, bufferSize, "BMODE $%x", decodedInstruction.nibble); break;
+        case Chip8::Operation1NNN: snprintf(textBuffer, bufferSize, "JMP $%03x", decodedInstruction.address); break;
+        case Chip8::Operation2NNN: snprintf(textBuffer, bufferSize, "JSR $%03x", decodedInstruction.address); break;
+        case Chip8::Operation3XNN: snprintf(textBuffer, bufferSize, "SKEQ V%X, $%02x", registerX, decodedInstruction.value); break;
+        case Chip8::Operation4XNN: snprintf(textBuffer, bufferSize, "SKNE V%X, $%02x", registerX, decodedInstruction.value); break;
+        case Chip8::Operation5XY0: snprintf(textBuffer, bufferSize, "SKEQ V%X, V%X", registerX, registerY); break;
+        case Chip8::Operation6XNN: snprintf(textBuffer, bufferSize, "MOV V%X, $%02x", registerX, decodedInstruction.value); break;
+        case Chip8::Operation7XNN: snprintf(textBuffer, bufferSize, "ADD V%X, $%02x", registerX, decodedInstruction.value); break;
+        case Chip8::Operation8XY0: snprintf(textBuffer, bufferSize, "MOV V%X, V%X", registerX, registerY); break;
+        case Chip8::Operation8XY1: snprintf(textBuffer, bufferSize, "OR V%X, V%X", registerX, registerY); break;
+        case Chip8::Operation8XY2: snprintf(textBuffer, bufferSize, "AND V%X, V%X", registerX, registerY); break;
+        case Chip8::Operation8XY3: snprintf(textBuffer, bufferSize, "XOR V%X, V%X", registerX, registerY); break;
+        case Chip8::Operation8XY4: snprintf(textBuffer, bufferSize, "ADD V%X, V%X", registerX, registerY); break;
+        case Chip8::Operation8XY5: snprintf(textBuffer, bufferSize, "SUB V%X, V%X", registerX, registerY); break;
+        case Chip8::Operation8XY6: snprintf(textBuffer, bufferSize, "SHR V%X", registerX); break;
+        case Chip8::Operation8XY7: snprintf(textBuffer, bufferSize, "RSB V%X, V%X", registerX, registerY); break;
+        case Chip8::Operation8XYE: snprintf(textBuffer, bufferSize, "SHL V%X", registerX); break;
+        case Chip8::Operation9XY0: snprintf(textBuffer, bufferSize, "SKNE V%X, V%X", registerX, registerY); break;
+        case Chip8::OperationANNN: snprintf(textBuffer, bufferSize, "MVI $%03x", decodedInstruction.address); break;
+        case Chip8::OperationBNNN: snprintf(textBuffer, bufferSize, "JMI $%03x", decodedInstruction.address); break;
+        case Chip8::OperationCXNN: snprintf(textBuffer, bufferSize, "RAND V%X, $%02x", registerX, decodedInstruction.value); break;
+        case Chip8::OperationDXYN: snprintf(textBuffer, bufferSize, "SPRITE V%X, V%X, $%x", registerX, registerY, decodedInstruction.nibble); break;
+        case Chip8::OperationEX9E: snprintf(textBuffer, bufferSize, "SKPR V%X", registerX); break;
+        case Chip8::OperationEXA1: snprintf(textBuffer, bufferSize, "SKUP V%X", registerX); break;
+        case Chip8::OperationFX07: snprintf(textBuffer, bufferSize, "GDELAY V%X", registerX); break;
+        case Chip8::OperationFX0A: snprintf(textBuffer, bufferSize, "KEY V%X", registerX); break;
+        case Chip8::OperationFX15: snprintf(textBuffer, bufferSize, "SDELAY V%X", registerX); break;
+        case Chip8::OperationFX18: snprintf(textBuffer, bufferSize, "SSOUND V%X", registerX); break;
+        case Chip8::OperationFX1E: snprintf(textBuffer, bufferSize, "ADI V%X", registerX); break;
+        case Chip8::OperationFX29: snprintf(textBuffer, bufferSize, "FONT V%X", registerX); break;
+        case Chip8::OperationFX30: snprintf(textBuffer, bufferSize, "XFONT V%X", registerX); break;
+        case Chip8::OperationFX33: snprintf(textBuffer, bufferSize, "BCD V%X", registerX); break;
+        case Chip8::OperationFX55: snprintf(textBuffer, bufferSize, "STR V%X", registerX); break;
+        case Chip8::OperationFX65: snprintf(textBuffer, bufferSize, "LDR V%X", registerX); break;
+        case Chip8::OperationFX75: snprintf(textBuffer, bufferSize, "STRF V%X", registerX); break;
+        case Chip8::OperationFX85: snprintf(textBuffer, bufferSize, "LDRF V%X", registerX); break;
+        default: snprintf(textBuffer, bufferSize, "DW $%04x", opCode); break;
+    }
 }
 
-// Execution
+// CPU
 
-#ifdef CHIP8_DEBUG
+void Chip8::Run(void) {
+    if (!this->currentInterface) {
+        Error(Chip8::Tag, "Cannot run without an interface.");
+        return;
+    }
 
-inline void Chip8::DebugOpCode(const string debugMessage, ...) {
-    if (this->delayTimer > 0) {
+    if (!this->memoryPages) {
+        Error(Chip8::Tag, "Cannot run without RAM.");
         return;
     }
 
-    static char    messageBuffer[4097];
-    static va_list messageArguments;
+    this->Reset();
+    this->isRunning  = true;
+    this->stopReason = Chip8::Stopped;
+    this->frameScheduler.Start(Chip8::FrameRate);
+
+    // Run a whole frame of instructions in one batch, then sleep until the next frame deadline. A program waiting for
+    // a key parks until one is pressed (and finishes the frame) or until the frame is due (and the timers tick). An idle
+    // loop skips what is left of the frame's instructions, and the thread sleeps that much longer. An interface that
+    // follows the display's refresh starts the next frame on it instead, and the deadlines count from there.
 
-    va_start(messageArguments, debugMessage);
-    vsprintf(messageBuffer, debugMessage.c_str(), messageArguments);
-    va_end(messageArguments);
+    while (this->isRunning) {
+        uint64 remainingCycles = this->instructionsPerFrame;
+        bool   isFrameDue      = false;
 
-    Debug(Chip8::Tag, "$%03x (%02x %02x): %s", this->programCounter, this->opCode >> 8, this->opCode & 0xFF, messageBuffer);
-}
+        while (remainingCycles > 0) {
+            remainingCycles -= this->Execute(remainingCycles);
 
-#else
+            if (!this->isRunning && this->isIdle) {
+                remainingCycles -= this->SkipIdleLoop(remainingCycles);
 
-inline void Chip8::DebugOpCode(const string debugMessage, ...) {
-    // Empty
-}
+                if (this->isRunning) {
+                    continue;
+                }
+            }
 
-#endif    // CHIP8_DEBUG
+            if (this->isRunning || !this->isWaitingForKey) {
+                break;
+            }
 
-void Chip8::Halt(const string haltMessage, ...) {
-    static char    messageBuffer[4097];
-    static va_list messageArguments;
+            this->isRunning = true;
 
-    va_start(messageArguments, haltMessage);
-    vsprintf(messageBuffer, haltMessage.c_str(), messageArguments);
-    va_end(messageArguments);
+            if (!this->WaitForKey(this->frameScheduler.GetNextDeadline())) {
+                isFrameDue = true;
+                break;
+            }
+        }
 
-    Error(Chip8::Tag, ">>> HALTED AT $%03x >>> %s", this->programCounter, messageBuffer);
-    this->isRunning = false;
+        if (!this->isRunning) {
+            break;
+        }
+
+        this->Tick();
+
+        if (isFrameDue) {
+            this->frameScheduler.CompleteFrame();
+        } else if (this->currentInterface && this->currentInterface->WaitForFrame(this->frameScheduler.GetNextDeadline())) {
+            this->frameScheduler.Synchronize();
+        } else {
+            this->frameScheduler.WaitForNextFrame();
+        }
+    }
 }
 
-// Timers
+uint64 Chip8::RunCycles(uint64 numberOfCycles) {
+    if (!this->memoryPages) {
+        Error(Chip8::Tag, "Cannot run without RAM.");
+        this->stopReason = Chip8::Halted;
+        return 0;
+    }
 
-void Chip8::Tick(void) {
-    static timeval currentTime;
-    static uint    elapsedTime;
+    // No wall-clock throttling here: the timers advance once every instructionsPerFrame retired instructions.
 
-    gettimeofday(&currentTime, NULL);
-    elapsedTime = ((currentTime.tv_sec * 1000000) + currentTime.tv_usec) - ((this->lastTick.tv_sec * 1000000) + this->lastTick.tv_usec);
+    uint64 retiredInstructions = 0;
 
-    if (elapsedTime >= 16000) {
-        this->currentInterface->Update();
+    this->isRunning  = true;
+    this->stopReason = Chip8::BudgetExhausted;
 
-        if (this->soundTimer > 0) {
-            this->soundTimer--;
-        }
+    while (this->isRunning && (retiredInstructions < numberOfCycles)) {
+        uint64 batchCycles = this->instructionsPerFrame - this->frameCycles;
 
-        if (this->delayTimer > 0) {
-            this->delayTimer--;
+        if (batchCycles > (numberOfCycles - retiredInstructions)) {
+            batchCycles = numberOfCycles - retiredInstructions;
         }
 
-        gettimeofday(&(this)->lastTick, NULL);
-    }
-
-    elapsedTime = ((currentTime.tv_sec * 1000000) + currentTime.tv_usec) - ((this->lastCpuTick.tv_sec * 1000000) + this->lastCpuTick.tv_usec);
+        batchCycles = this->Execute(batchCycles);
+        retiredInstructions += batchCycles;
+        this->frameCycles += batchCycles;
 
-    if (elapsedTime >= 2000) {
-        this->cpuWait = false;
-        gettimeofday(&(this)->lastCpuTick, NULL);
-    }
-}
+        // A loop that came back unchanged stopped the batch at its jump, the passes before the next tick are skipped.
 
-// Operations
+        if (!this->isRunning && this->isIdle) {
+            uint64 idleCycles = this->SkipIdleLoop(std::min<uint64>(this->instructionsPerFrame - this->frameCycles, numberOfCycles - retiredInstructions));
 
-void Chip8::Op0x0(void) {
-    switch (this->opCode & 0xFF) {
-        case 0xE0: {
-            this->DebugOpCode("CLS");
-            memset(*this->videoMemory, 0, sizeof(*this->videoMemory));
-            break;
+            retiredInstructions += idleCycles;
+            this->frameCycles += idleCycles;
         }
 
-        case 0xEE: {
-            if (this->stackPointer == 0) {
-                this->Halt("No subroutine to return from.");
-                return;
+        // Without a wall clock to park on, a program waiting for a key idles until the next tick, where the interface
+        // may press one. The idle cycles count, as they would have if FX0A had run again and again.
+
+        if (!this->isRunning && this->isWaitingForKey) {
+            this->isRunning = true;
+
+            if (this->pressedKeys.load(std::memory_order_acquire) == 0) {
+                uint64 idleCycles = std::min<uint64>(this->instructionsPerFrame - this->frameCycles, numberOfCycles - retiredInstructions);
+
+                retiredInstructions += idleCycles;
+                this->frameCycles += idleCycles;
             }
+        }
 
-            this->DebugOpCode("RTS");
-            this->programCounter = this->callStack[--this->stackPointer];
+        if (!this->isRunning) {
             break;
         }
 
-        default: {
-            this->Halt("Unknown opCode: %02x %02x.", this->opCode >> 8, this->opCode & 0xFF);
-            return;
+        if (this->frameCycles >= this->instructionsPerFrame) {
+            this->frameCycles = 0;
+            this->Tick();
         }
     }
 
-    this->programCounter += 2;
+    this->isRunning = false;
+    return retiredInstructions;
 }
 
-void Chip8::Op0x1(void) {
-    static uint16 jumpAddress;
+uint64 Chip8::RunFrames(uint64 numberOfFrames) {
+    if (numberOfFrames == 0) {
+        this->stopReason = Chip8::BudgetExhausted;
+        return 0;
+    }
 
-    jumpAddress = this->opCode & 0xFFF;
+    return this->RunCycles((numberOfFrames * this->instructionsPerFrame) - this->frameCycles);
+}
 
-    this->DebugOpCode("JMP $%03x", jumpAddress);
-    this->programCounter = jumpAddress;
+void Chip8::Stop(void) {
+    this->isRunning  = false;
+    this->stopReason = Chip8::Stopped;
 }
 
-void Chip8::Op0x2(void) {
-    if (this->stackPointer == 15) {
-        this->Halt("Stack overflow.");
-        return;
-    }
+void Chip8::Reset(void) {
+    this->addressRegister = 0;
+    this->programCounter  = Chip8::ProgramStartAddress;
+    this->stackPointer    = 0;
+    this->opCode          = 0;
+    this->delayTimer      = 0;
+    this->soundTimer      = 0;
+    this->frameCycles     = 0;
+    this->randomState     = this->randomSeed;
+    this->isWaitingForKey = false;
+    this->isIdle          = false;
 
-    static uint16 jumpAddress;
+    this->idleLoop.isWatched = false;
 
-    jumpAddress = this->opCode & 0xFFF;
+    this->UpdateBeeper();
 
-    this->DebugOpCode("JSR $%03x", jumpAddress);
-    this->callStack[this->stackPointer++] = this->programCounter + 2;
-    this->programCounter                  = jumpAddress;
-}
+    memset(this->cpuRegisters, 0, sizeof(this->cpuRegisters));
+    memset(this->callStack, 0, sizeof(this->callStack));
 
-void Chip8::Op0x3(void) {
-    static uint8 registerX, testValue;
+    this->SetMegaChip(false);
+    this->SetExtendedScreen(false);
+    memset(this->videoMemory, 0, sizeof(this->videoMemory));
+    this->MarkDirty(0, Chip8::ScreenHeight - 1);
+    this->InvalidateAllCode();
+}
 
-    registerX = (this->opCode >> 8) & 0xF;
-    testValue = this->opCode & 0xFF;
+void Chip8::SetCpuRate(uint instructionsPerSecond) {
+    this->SetInstructionsPerFrame((instructionsPerSecond + (Chip8::FrameRate / 2)) / Chip8::FrameRate);
+}
 
-    this->DebugOpCode("SKEQ V%X, $%02x", registerX, testValue);
-    this->programCounter += ((this->cpuRegisters[registerX] == testValue) * 2) + 2;
+void Chip8::SetInstructionsPerFrame(uint instructionsPerFrame) {
+    this->instructionsPerFrame = instructionsPerFrame > 0 ? instructionsPerFrame : 1;
+    this->frameCycles          = 0;
 }
 
-void Chip8::Op0x4(void) {
-    static uint8 registerX, testValue;
+uint Chip8::GetInstructionsPerFrame(void) const {
+    return this->instructionsPerFrame;
+}
 
-    registerX = (this->opCode >> 8) & 0xF;
-    testValue = this->opCode & 0xFF;
+Chip8::StopReason Chip8::GetStopReason(void) const {
+    return this->stopReason;
+}
 
-    this->DebugOpCode("SKNE V%X, $%02x", registerX, testValue);
-    this->programCounter += ((this->cpuRegisters[registerX] != testValue) * 2) + 2;
+uint64 Chip8::GetMissedDeadlines(void) const {
+    return this->frameScheduler.GetMissedDeadlines();
 }
 
-void Chip8::Op0x5(void) {
-    static uint8 registerX, registerY;
+void Chip8::SetRandomSeed(uint32 newSeed) {
+    // Xorshift never leaves the all-zero state.
+    this->randomSeed  = newSeed ? newSeed : Chip8::DefaultRandomSeed;
+    this->randomState = this->randomSeed;
+}
 
-    registerX = (this->opCode >> 8) & 0xF;
-    registerY = (this->opCode >> 4) & 0xF;
+// Registers
 
-    this->DebugOpCode("SKEQ V%X, V%X", registerX, registerY);
-    this->programCounter += ((this->cpuRegisters[registerX] == this->cpuRegisters[registerY]) * 2) + 2;
+const uint8* Chip8::GetRegisters(void) const {
+    return this->cpuRegisters;
 }
 
-void Chip8::Op0x6(void) {
-    static uint8 registerX, newValue;
+uint32 Chip8::GetAddressRegister(void) const {
+    return this->addressRegister;
+}
 
-    registerX = (this->opCode >> 8) & 0xF;
-    newValue  = this->opCode & 0xFF;
+uint16 Chip8::GetProgramCounter(void) const {
+    return this->programCounter;
+}
 
-    this->DebugOpCode("MOV V%X, $%02x", registerX, newValue);
-    this->cpuRegisters[registerX] = newValue;
-    this->programCounter += 2;
+uint8 Chip8::GetDelayTimer(void) const {
+    return this->delayTimer;
 }
 
-void Chip8::Op0x7(void) {
-    static uint8 registerX, addValue;
+uint8 Chip8::GetSoundTimer(void) const {
+    return this->soundTimer;
+}
 
-    registerX = (this->opCode >> 8) & 0xF;
-    addValue  = this->opCode & 0xFF;
+// Idle Loops
 
-    this->DebugOpCode("ADD V%X, $%02x", registerX, addValue);
-    this->cpuRegisters[registerX] += addValue;
-    this->programCounter += 2;
+void Chip8::SetIdleSkipping(bool isEnabled) {
+    this->isIdleSkipping = isEnabled;
+    this->InvalidateAllCode();
 }
 
-void Chip8::Op0x8(void) {
-    static uint8 registerX, registerY;
-
-    registerX = (this->opCode >> 8) & 0xF;
-    registerY = (this->opCode >> 4) & 0xF;
+const Chip8::IdleStatistics& Chip8::GetIdleStatistics(void) const {
+    return this->idleStatistics;
+}
 
-    switch (this->opCode & 0xF) {
-        case 0x0: {
-            this->DebugOpCode("MOV V%X, V%X", registerX, registerY);
-            this->cpuRegisters[registerX] = this->cpuRegisters[registerY];
-            break;
-        }
+bool Chip8::IsIdleLoop(uint16 jumpAddress, uint16 loopAddress) const {
+    // A jump back over a few instructions that only compute V0-VF and I from themselves, memory and the delay timer.
+    // Within a frame nothing else can change what such a loop does.
 
-        case 0x1: {
-            this->DebugOpCode("OR V%X, V%X", registerX, registerY);
-            this->cpuRegisters[registerX] |= this->cpuRegisters[registerY];
-            break;
-        }
+    if (!this->isIdleSkipping || (loopAddress > jumpAddress) || ((jumpAddress - loopAddress) & 1) || ((jumpAddress - loopAddress) >= (Chip8::MaximumIdleLoopLength * 2))) {
+        return false;
+    }
 
-        case 0x2: {
-            this->DebugOpCode("AND V%X, V%X", registerX, registerY);
-            this->cpuRegisters[registerX] &= this->cpuRegisters[registerY];
-            break;
+    for (uint16 instructionAddress = loopAddress; instructionAddress < jumpAddress; instructionAddress += 2) {
+        Instruction loopInstruction;
+        Chip8::Decode((this->ReadMemory(instructionAddress & 0xFFF) << 8) | this->ReadMemory((instructionAddress + 1) & 0xFFF), loopInstruction);
+
+        switch (loopInstruction.operation) {
+            case Chip8::Operation3XNN:
+            case Chip8::Operation4XNN:
+            case Chip8::Operation5XY0:
+            case Chip8::Operation6XNN:
+            case Chip8::Operation7XNN:
+            case Chip8::Operation8XY0:
+            case Chip8::Operation8XY1:
+            case Chip8::Operation8XY2:
+            case Chip8::Operation8XY3:
+            case Chip8::Operation8XY4:
+            case Chip8::Operation8XY5:
+            case Chip8::Operation8XY6:
+            case Chip8::Operation8XY7:
+            case Chip8::Operation8XYE:
+            case Chip8::Operation9XY0:
+            case Chip8::OperationANNN:
+            case Chip8::OperationFX07:
+            case Chip8::OperationFX1E:
+            case Chip8::OperationFX29:
+            case Chip8::OperationFX30:
+            case Chip8::OperationFX65: break;
+            default: return false;
         }
+    }
 
-        case 0x3: {
-            this->DebugOpCode("XOR V%X, V%X", registerX, registerY);
-            this->cpuRegisters[registerX] ^= this->cpuRegisters[registerY];
-            break;
-        }
+    return true;
+}
 
-        case 0x4: {
-            this->DebugOpCode("ADD V%X, V%X", registerX, registerY);
+uint64 Chip8::SkipIdleLoop(uint64 numberOfCycles) {
+    // The batch stopped before the jump back. One pass is stepped from there: it has to stay inside the loop (the code
+    // may have changed since it was decoded) and come back to the jump with the values it left with. Every pass after
+    // it is then the same one until the timers tick, so the whole passes the budget has room for are skipped.
 
-            this->cpuRegisters[0xF] = UINT16(this->cpuRegisters[registerX] + this->cpuRegisters[registerY]) > 255;
-            this->cpuRegisters[registerX] += this->cpuRegisters[registerY];
+    uint16 jumpAddress         = this->programCounter;
+    uint16 loopAddress         = this->idleLoop.loopAddress;
+    uint32 loopAddressRegister = this->addressRegister;
+    uint8  loopRegisters[16];
+    uint64 passCycles = 0;
 
-            break;
-        }
+    memcpy(loopRegisters, this->cpuRegisters, sizeof(loopRegisters));
 
-        case 0x5: {
-            this->DebugOpCode("SUB V%X, V%X", registerX, registerY);
+    this->isRunning          = true;
+    this->isIdle             = false;
+    this->idleLoop.isWatched = false;
 
-            this->cpuRegisters[0xF] = !(this->cpuRegisters[registerX] < this->cpuRegisters[registerY]);
-            this->cpuRegisters[registerX] -= this->cpuRegisters[registerY];
+    bool isLoop = this->IsIdleLoop(jumpAddress, loopAddress);
 
-            break;
+    do {
+        if ((passCycles == numberOfCycles) || (this->Execute(1) == 0)) {
+            return passCycles;
         }
 
-        case 0x6: {
-            this->DebugOpCode("SHR V%X", registerX);
-
-            this->cpuRegisters[0xF] = this->cpuRegisters[registerX] & 0x1;
-            this->cpuRegisters[registerX] >>= 1;
+        passCycles++;
 
-            break;
+        if (!isLoop || (this->programCounter < loopAddress) || (this->programCounter > jumpAddress)) {
+            return passCycles;
         }
+    } while (this->programCounter != jumpAddress);
 
-        case 0x7: {
-            this->DebugOpCode("RSB V%X, V%X", registerX, registerY);
-
-            this->cpuRegisters[0xF]       = !(this->cpuRegisters[registerY] < this->cpuRegisters[registerX]);
-            this->cpuRegisters[registerX] = this->cpuRegisters[registerY] - this->cpuRegisters[registerX];
-            break;
-        }
+    if ((this->addressRegister != loopAddressRegister) || (memcmp(this->cpuRegisters, loopRegisters, sizeof(loopRegisters)) != 0)) {
+        return passCycles;
+    }
 
-        case 0xE: {
-            this->DebugOpCode("SHL V%X", registerX);
+    uint64 skippedInstructions = ((numberOfCycles - passCycles) / passCycles) * passCycles;
 
-            this->cpuRegisters[0xF] = this->cpuRegisters[registerX] >> 7;
-            this->cpuRegisters[registerX] <<= 1;
-            break;
-        }
+    // What is left of the frame runs normally, too short for another pass to be compared.
 
-        default: {
-            this->Halt("Unknown opCode: %02x %02x.", this->opCode >> 8, this->opCode & 0xFF);
-            return;
-        }
-    }
+    this->idleLoop.isWatched = false;
+    this->idleStatistics.skippedLoops += skippedInstructions > 0;
+    this->idleStatistics.skippedInstructions += skippedInstructions;
 
-    this->programCounter += 2;
+    return passCycles + skippedInstructions;
 }
 
-void Chip8::Op0x9(void) {
-    static uint8 registerX, registerY;
-
-    registerX = (this->opCode >> 8) & 0xF;
-    registerY = (this->opCode >> 4) & 0xF;
+// Memory
 
-    this->DebugOpCode("SKNE V%X, V%X", registerX, registerY);
-    this->programCounter += ((this->cpuRegisters[registerX] != this->cpuRegisters[registerY]) * 2) + 2;
+void Chip8::SetRAM(RAM* mainMemory) {
+    this->SetMemory(*mainMemory, sizeof(RAM));
 }
 
-void Chip8::Op0xA(void) {
-    static uint16 newAddress;
+bool Chip8::SetMemory(uint8* mainMemory, uint32 memorySize) {
+    return this->MapMemory(mainMemory, memorySize, false);
+}
 
-    newAddress = this->opCode & 0xFFF;
+bool Chip8::SetSharedMemory(const uint8* sharedMemory, uint32 memorySize) {
+    // Sessions running the same program share its image (fonts and code included), each one only pays for the pages it
+    // writes.
 
-    this->DebugOpCode("MVI $%03x", newAddress);
-    this->addressRegister = newAddress;
-    this->programCounter += 2;
+    return this->MapMemory(sharedMemory, memorySize, true);
 }
 
-void Chip8::Op0xB(void) {
-    static uint16 jumpAddress;
+uint32 Chip8::GetMemorySize(void) const {
+    return this->memoryMask + 1;
+}
 
-    jumpAddress = this->opCode & 0xFFF;
+Chip8::MemoryFootprint Chip8::GetMemoryFootprint(void) const {
+    MemoryFootprint memoryFootprint;
 
-    this->DebugOpCode("JMI $%03x", jumpAddress);
-    this->programCounter = jumpAddress + this->cpuRegisters[0];
-}
+    memoryFootprint.sharedPages   = this->sharedMemory ? this->numberOfPages - this->copiedPages.size() : 0;
+    memoryFootprint.privatePages  = this->numberOfPages - memoryFootprint.sharedPages;
+    memoryFootprint.instanceBytes = sizeof(Chip8) + (this->numberOfPages * sizeof(uint8*)) + (UINT64(memoryFootprint.privatePages) * Chip8::PageSize);
 
-void Chip8::Op0xC(void) {
-    static uint8 registerX, maskValue;
+    if (this->decodedMemory) {
+        memoryFootprint.instanceBytes += sizeof(Instruction) * sizeof(RAM);
+    }
 
-    registerX = (this->opCode >> 8) & 0xF;
-    maskValue = this->opCode & 0xFF;
+    if (this->megaChip) {
+        memoryFootprint.instanceBytes += sizeof(MegaChipState);
+    }
 
-    this->DebugOpCode("RAND V%X, $%02x", registerX, maskValue);
-    this->cpuRegisters[registerX] = (rand() % 256) & maskValue;
-    this->programCounter += 2;
+    return memoryFootprint;
 }
 
-void Chip8::Op0xD(void) {
-    static uint8 registerX, registerY, spriteHeight;
+bool Chip8::MapMemory(const uint8* memoryData, uint32 memorySize, bool isShared) {
+    // Data reads and writes wrap with a mask, so the size has to be a power of two.
 
-    registerX    = (this->opCode >> 8) & 0xF;
-    registerY    = (this->opCode >> 4) & 0xF;
-    spriteHeight = this->opCode & 0xF;
-    ;
+    if ((memorySize < sizeof(RAM)) || (memorySize > Chip8::MaximumMemorySize) || (memorySize & (memorySize - 1))) {
+        Error(Chip8::Tag, "Unsupported memory size (%u bytes).", memorySize);
+        return false;
+    }
 
-    this->DebugOpCode("SPRITE V%X, V%X, $%x", registerX, registerY, spriteHeight);
+    uint numberOfPages = memorySize / Chip8::PageSize;
 
-    uint16 lineAddress = this->addressRegister;
-    uint8  currentLine = (*this->mainMemory)[lineAddress++];
-    uint   startingX   = this->cpuRegisters[registerX];
-    uint   startingY   = this->cpuRegisters[registerY];
-    uint   xPosition   = startingX;
-    uint   yPosition   = startingY;
-    uint8  pixelValue;
-    uint8  screenValue;
+    if (numberOfPages != this->numberOfPages) {
+        delete[] this->memoryPages;
 
-    this->cpuRegisters[0xF] = 0;
+        this->numberOfPages = 0;
+        this->memoryPages   = new (std::nothrow) uint8*[numberOfPages];
 
-    for (uint8 yPixels = 0; yPixels < spriteHeight; ++yPixels) {
-        if (yPosition > 32) {
-            yPosition -= 32;
+        if (!this->memoryPages) {
+            Error(Chip8::Tag, "Could not allocate the memory page table.");
+            return false;
         }
 
-        xPosition = startingX;
+        this->numberOfPages = numberOfPages;
+    }
 
-        for (uint8 xPixels = 0; xPixels < 8; ++xPixels) {
-            if (xPosition > 64) {
-                xPosition -= 64;
-            }
+    this->ReleasePages();
 
-            pixelValue  = (currentLine >> (7 - xPixels)) & 0x1;
-            screenValue = (*this->videoMemory)[((yPosition * 64) + xPosition) * 3] / 255;
+    for (uint pageIndex = 0; pageIndex < numberOfPages; ++pageIndex) {
+        this->memoryPages[pageIndex] = const_cast<uint8*>(memoryData) + (pageIndex * Chip8::PageSize);
+    }
 
-            if ((pixelValue == screenValue) && (screenValue == 0x1)) {
-                this->cpuRegisters[0xF] = 1;
-            }
+    this->sharedMemory = isShared ? memoryData : NULL;
+    this->memoryMask   = memorySize - 1;
+    this->InvalidateAllCode();
+    return true;
+}
 
-            memset(&(*this->videoMemory)[((yPosition * 64) + xPosition) * 3], (screenValue ^ pixelValue) * 255, 3);
-            xPosition++;
-        }
+uint8* Chip8::CopyPage(uint32 address) {
+    uint   pageIndex  = (address & this->memoryMask) >> Chip8::PageBits;
+    uint8* copiedPage = new (std::nothrow) uint8[Chip8::PageSize];
 
-        currentLine = (*this->mainMemory)[lineAddress++];
-        yPosition++;
+    if (!copiedPage) {
+        this->Halt("Could not copy a memory page.");
+        return NULL;
     }
 
-    this->programCounter += 2;
+    memcpy(copiedPage, this->memoryPages[pageIndex], Chip8::PageSize);
+    this->copiedPages.push_back(copiedPage);
+    return this->memoryPages[pageIndex] = copiedPage;
 }
 
-void Chip8::Op0xE(void) {
-    static uint8 registerX;
+void Chip8::ReadMemoryBlock(uint32 address, uint8* blockData, uint blockSize) const {
+    // Page by page, wrapping at the end of memory.
 
-    registerX = (this->opCode >> 8) & 0xF;
+    while (blockSize > 0) {
+        uint pageOffset = address & (Chip8::PageSize - 1);
+        uint copySize   = std::min(blockSize, Chip8::PageSize - pageOffset);
 
-    switch (this->opCode & 0xFF) {
-        case 0x9E: {
-            this->DebugOpCode("SKPR V%X", registerX);
-            // this->currentInterface->ReadKeys( this->keyStates );
-            // this->programCounter += this->keyStates[ this->cpuRegisters[ registerIndex ] ] ? 4 : 2;
+        memcpy(blockData, &this->memoryPages[(address & this->memoryMask) >> Chip8::PageBits][pageOffset], copySize);
+        address += copySize;
+        blockData += copySize;
+        blockSize -= copySize;
+    }
+}
 
-            // TODO
-            this->programCounter += 2;
-            break;
-        }
+void Chip8::ReleasePages(void) {
+    for (uint pageIndex = 0; pageIndex < this->copiedPages.size(); ++pageIndex) {
+        delete[] this->copiedPages[pageIndex];
+    }
 
-        case 0xA1: {
-            this->DebugOpCode("SKUP V%X", registerX);
-            // this->currentInterface->ReadKeys( this->keyStates );
-            // this->programCounter += this->keyStates[ this->cpuRegisters[ registerIndex ] ] ? 2 : 4;
+    this->copiedPages.clear();
+}
 
-            // TODO
-            this->programCounter += 4;
-            break;
-        }
+const Chip8::VRAM& Chip8::GetVRAM(void) const {
+    return this->videoMemory;
+}
 
-        default: {
-            this->Halt("Unknown opCode: %02x %02x.", this->opCode >> 8, this->opCode & 0xFF);
-            return;
-        }
+bool Chip8::IsExtendedScreen(void) const {
+    return this->isExtendedScreen;
+}
+
+uint Chip8::GetScreenWidth(void) const {
+    if (this->isMegaChip) {
+        return Chip8::MegaScreenWidth;
     }
+
+    return this->isExtendedScreen ? Chip8::ExtendedScreenWidth : Chip8::ScreenWidth;
 }
 
-void Chip8::Op0xF(void) {
-    static uint8 registerX;
+uint Chip8::GetScreenHeight(void) const {
+    if (this->isMegaChip) {
+        return Chip8::MegaScreenHeight;
+    }
 
-    registerX = (this->opCode >> 8) & 0xF;
+    return this->isExtendedScreen ? Chip8::ExtendedScreenHeight : Chip8::ScreenHeight;
+}
 
-    switch (this->opCode & 0xFF) {
-        case 0x07: {
-            this->DebugOpCode("GDELAY V%X", registerX);
-            this->cpuRegisters[registerX] = this->delayTimer;
-            break;
-        }
+inline void Chip8::MarkDirty(uint firstRow, uint lastRow) {
+    if (!this->dirtyRegion.isDirty) {
+        this->dirtyRegion.isDirty  = true;
+        this->dirtyRegion.firstRow = firstRow;
+        this->dirtyRegion.lastRow  = lastRow;
+        return;
+    }
 
-        case 0x0A: {
-            // this->waitingForKey = true;
-            // this->keyRegister = registerIndex;
+    if (firstRow < this->dirtyRegion.firstRow) {
+        this->dirtyRegion.firstRow = firstRow;
+    }
 
-            // TODO
-            break;
-        }
+    if (lastRow > this->dirtyRegion.lastRow) {
+        this->dirtyRegion.lastRow = lastRow;
+    }
+}
 
-        case 0x15: {
-            this->DebugOpCode("SDELAY V%X", registerX);
-            this->delayTimer = this->cpuRegisters[registerX];
-            break;
-        }
+void Chip8::SetExtendedScreen(bool isExtended) {
+    // The two modes map pixels differently, so switching starts from a clear screen.
 
-        case 0x18: {
-            this->DebugOpCode("SSOUND V%X", registerX);
-            this->soundTimer = this->cpuRegisters[registerX];
-            break;
-        }
+    if (isExtended == this->isExtendedScreen) {
+        return;
+    }
 
-        case 0x1E: {
-            this->DebugOpCode("ADI V%X", registerX);
-            this->addressRegister += this->cpuRegisters[registerX];
-            break;
-        }
+    this->isExtendedScreen = isExtended;
+    memset(this->videoMemory, 0, sizeof(this->videoMemory));
+    this->MarkDirty(0, this->GetScreenHeight() - 1);
+}
 
-        case 0x29: {
-            this->DebugOpCode("FONT V%X", registerX);
-            this->addressRegister = Chip8::FontStartAddress + (this->cpuRegisters[registerX] * 5);
-            break;
-        }
+// MEGA-CHIP
 
-        case 0x33: {
-            this->DebugOpCode("BCD V%X", registerX);
+bool Chip8::IsMegaChip(void) const {
+    return this->isMegaChip;
+}
 
-            (*this->mainMemory)[this->addressRegister]     = this->cpuRegisters[registerX] / 100;
-            (*this->mainMemory)[this->addressRegister + 1] = (this->cpuRegisters[registerX] % 100) / 10;
-            (*this->mainMemory)[this->addressRegister + 2] = (this->cpuRegisters[registerX] % 100) % 10;
-            break;
-        }
+const uint8* Chip8::GetIndexedVRAM(void) const {
+    return this->megaChip ? this->megaChip->screenMemory[this->megaChip->drawnScreen ^ 1] : NULL;
+}
 
-        case 0x55: {
-            this->DebugOpCode("STR V%X", registerX);
-            memcpy(&(*this->mainMemory)[Chip8::ProgramStartAddress + this->addressRegister], this->cpuRegisters, registerX + 1);
-            break;
-        }
+const Chip8::Palette& Chip8::GetPalette(void) const {
+    static const Palette EmptyPalette = {0};
+    return this->megaChip ? this->megaChip->palette : EmptyPalette;
+}
 
-        case 0x65: {
-            this->DebugOpCode("LDR V%X", registerX);
-            memcpy(this->cpuRegisters, &(*this->mainMemory)[Chip8::ProgramStartAddress + this->addressRegister], registerX + 1);
+uint8 Chip8::GetScreenAlpha(void) const {
+    return this->megaChip ? this->megaChip->screenAlpha : 0xFF;
+}
+
+bool Chip8::SetMegaChip(bool isEnabled) {
+    if (isEnabled == this->isMegaChip) {
+        return true;
+    }
+
+    if (isEnabled && !this->megaChip) {
+        this->megaChip = new (std::nothrow) MegaChipState;
+
+        if (!this->megaChip) {
+            Error(Chip8::Tag, "Could not allocate the MEGA-CHIP screen.");
+            return false;
+        }
+    }
+
+    // Both screens start blank. Colors default to white, so characters drawn before a palette is loaded are visible.
+
+    if (isEnabled) {
+        memset(this->megaChip->screenMemory, 0, sizeof(this->megaChip->screenMemory));
+
+        this->megaChip->palette[0] = 0;
+
+        for (uint colorIndex = 1; colorIndex < 256; ++colorIndex) {
+            this->megaChip->palette[colorIndex] = 0xFFFFFFFF;
+        }
+
+        this->megaChip->drawnScreen    = 0;
+        this->megaChip->spriteWidth    = 0;
+        this->megaChip->spriteHeight   = 0;
+        this->megaChip->screenAlpha    = 0xFF;
+        this->megaChip->blendMode      = 0;
+        this->megaChip->soundAddress   = 0;
+        this->megaChip->isSoundPlaying = false;
+        this->megaChip->isSoundLooping = false;
+    }
+
+    this->isMegaChip = isEnabled;
+    memset(this->videoMemory, 0, sizeof(this->videoMemory));
+    this->MarkDirty(0, this->GetScreenHeight() - 1);
+    return true;
+}
+
+// State
+
+uint Chip8::SaveState(uint8* stateBuffer, uint bufferSize) const {
+    if (!this->memoryPages || this->isMegaChip || (this->GetMemorySize() != sizeof(RAM)) || (bufferSize < Chip8::StateSize)) {
+        return 0;
+    }
+
+    uint8* stateCursor = stateBuffer;
+    uint32 stateMagic  = Chip8::StateMagic;
+    uint16 version     = Chip8::StateVersion;
+    uint16 stateSize   = Chip8::StateSize;
+    uint8  screenMode  = this->isExtendedScreen;
+
+    // Header
+
+    WriteState(stateCursor, &stateMagic, sizeof(stateMagic));
+    WriteState(stateCursor, &version, sizeof(version));
+    WriteState(stateCursor, &stateSize, sizeof(stateSize));
+
+    // CPU and timers
+
+    WriteState(stateCursor, &this->addressRegister, sizeof(this->addressRegister));
+    WriteState(stateCursor, &this->programCounter, sizeof(this->programCounter));
+    WriteState(stateCursor, this->callStack, sizeof(this->callStack));
+    WriteState(stateCursor, this->cpuRegisters, sizeof(this->cpuRegisters));
+    WriteState(stateCursor, &this->stackPointer, sizeof(this->stackPointer));
+    WriteState(stateCursor, &this->delayTimer, sizeof(this->delayTimer));
+    WriteState(stateCursor, &this->soundTimer, sizeof(this->soundTimer));
+    WriteState(stateCursor, &screenMode, sizeof(screenMode));
+    WriteState(stateCursor, &this->randomState, sizeof(this->randomState));
+    WriteState(stateCursor, &this->frameCycles, sizeof(this->frameCycles));
+    WriteState(stateCursor, this->flagRegisters, sizeof(this->flagRegisters));
+
+    // Memory
+
+    WriteState(stateCursor, this->videoMemory, sizeof(this->videoMemory));
+    for (uint pageIndex = 0; pageIndex < (sizeof(RAM) / Chip8::PageSize); ++pageIndex) {
+        WriteState(stateCursor, this->memoryPages[pageIndex], Chip8::PageSize);
+    }
+
+    return stateCursor - stateBuffer;
+}
+
+bool Chip8::LoadState(const uint8* stateBuffer, uint stateSize) {
+    if (!this->memoryPages || (stateSize < Chip8::StateSize)) {
+        Error(Chip8::Tag, "Cannot load a state without RAM or from a truncated buffer.");
+        return false;
+    }
+
+    if (this->GetMemorySize() != sizeof(RAM)) {
+        Error(Chip8::Tag, "States only hold 4 KB of memory.");
+        return false;
+    }
+
+    const uint8* stateCursor = stateBuffer;
+    uint32       stateMagic;
+    uint16       version;
+    uint16       savedSize;
+    uint8        savedStackPointer;
+    uint8        screenMode;
+
+    ReadState(stateCursor, &stateMagic, sizeof(stateMagic));
+    ReadState(stateCursor, &version, sizeof(version));
+    ReadState(stateCursor, &savedSize, sizeof(savedSize));
+
+    if ((stateMagic != Chip8::StateMagic) || (version != Chip8::StateVersion) || (savedSize != Chip8::StateSize)) {
+        Error(Chip8::Tag, "Unsupported state (version %u, %u bytes).", version, savedSize);
+        return false;
+    }
+
+    // Validate before anything is overwritten, the stack pointer follows the header, I, PC, the stack and V0-VF. 2NNN
+    // leaves it at 15 at most (and halts instead of calling from there), anything above is corrupted.
+
+    savedStackPointer = stateCursor[sizeof(this->addressRegister) + sizeof(this->programCounter) + sizeof(this->callStack) + sizeof(this->cpuRegisters)];
+
+    if (savedStackPointer > 15) {
+        Error(Chip8::Tag, "Corrupted state (stack pointer %u).", savedStackPointer);
+        return false;
+    }
+
+    // CPU and timers
+
+    ReadState(stateCursor, &this->addressRegister, sizeof(this->addressRegister));
+    ReadState(stateCursor, &this->programCounter, sizeof(this->programCounter));
+    ReadState(stateCursor, this->callStack, sizeof(this->callStack));
+    ReadState(stateCursor, this->cpuRegisters, sizeof(this->cpuRegisters));
+    ReadState(stateCursor, &this->stackPointer, sizeof(this->stackPointer));
+    ReadState(stateCursor, &this->delayTimer, sizeof(this->delayTimer));
+    ReadState(stateCursor, &this->soundTimer, sizeof(this->soundTimer));
+    ReadState(stateCursor, &screenMode, sizeof(screenMode));
+    ReadState(stateCursor, &this->randomState, sizeof(this->randomState));
+    ReadState(stateCursor, &this->frameCycles, sizeof(this->frameCycles));
+    ReadState(stateCursor, this->flagRegisters, sizeof(this->flagRegisters));
+
+    if (this->frameCycles >= this->instructionsPerFrame) {
+        this->frameCycles = 0;
+    }
+
+    // A state saved during FX0A starts the wait over (the keys are not part of the state).
+
+    this->isWaitingForKey = false;
+
+    // Memory (only the RAM blocks that differ are copied, so the decoded code elsewhere stays valid)
+
+    this->SetMegaChip(false);
+    this->isExtendedScreen = screenMode != 0;
+    ReadState(stateCursor, this->videoMemory, sizeof(this->videoMemory));
+
+    for (uint blockAddress = 0; blockAddress < sizeof(RAM); blockAddress += 64) {
+        if (memcmp(&this->memoryPages[blockAddress >> Chip8::PageBits][blockAddress & (Chip8::PageSize - 1)], stateCursor + blockAddress, 64) != 0) {
+            uint8* memoryPage = this->GetWritablePage(blockAddress);
+
+            if (memoryPage) {
+                memcpy(&memoryPage[blockAddress & (Chip8::PageSize - 1)], stateCursor + blockAddress, 64);
+                this->InvalidateCode(blockAddress, 64);
+            }
+        }
+    }
+
+    this->opCode = 0;
+    this->MarkDirty(0, this->GetScreenHeight() - 1);
+    this->UpdateBeeper();
+    return true;
+}
+
+// Engine
+
+bool Chip8::SetEngine(Engine newEngine) {
+    if ((newEngine == Chip8::Recompiled) && !this->recompiler) {
+        if (!Recompiler::IsSupported()) {
+            Error(Chip8::Tag, "The recompiler is not supported on this platform.");
+            return false;
+        }
+
+        this->recompiler = new (std::nothrow) Recompiler(this);
+
+        if (!this->recompiler || !this->recompiler->Initialize()) {
+            Error(Chip8::Tag, "Could not initialize the recompiler.");
+            delete this->recompiler;
+            this->recompiler = NULL;
+            return false;
+        }
+    }
+
+    if ((newEngine == Chip8::Translated) && !this->translation) {
+        this->translation = new (std::nothrow) Translation(this);
+
+        if (!this->translation) {
+            Error(Chip8::Tag, "Could not allocate the translation state.");
+            return false;
+        }
+    }
+
+    if ((newEngine != Chip8::Interpreter) && !this->decodedMemory) {
+        this->decodedMemory = new (std::nothrow) Instruction[sizeof(RAM)];
+
+        if (!this->decodedMemory) {
+            Error(Chip8::Tag, "Could not allocate the decoded instructions cache.");
+            return false;
+        }
+    }
+
+    this->currentEngine = newEngine;
+    this->InvalidateAllCode();
+    return true;
+}
+
+Chip8::Engine Chip8::GetEngine(void) const {
+    return this->currentEngine;
+}
+
+// Translation
+
+charconst Chip8::GetTranslatedProgram(void) const {
+    const Translation::Program* translatedProgram = this->translation ? this->translation->GetProgram() : NULL;
+
+    return ((this->currentEngine == Chip8::Translated) && translatedProgram) ? translatedProgram->programName : NULL;
+}
+
+Chip8::TranslationStatistics Chip8::GetTranslationStatistics(void) const {
+    TranslationStatistics translationStatistics = {0, 0};
+
+    if (this->translation) {
+        translationStatistics.nativeInstructions      = this->translation->GetNativeInstructions();
+        translationStatistics.interpretedInstructions = this->translation->GetInterpretedInstructions();
+    }
+
+    return translationStatistics;
+}
+
+// Quirks
+
+void Chip8::SetQuirkProfile(QuirkProfile newProfile) {
+    this->quirkProfile = newProfile;
+
+    // Native blocks are compiled for one profile, and programs are translated for one.
+
+    if (this->recompiler) {
+        this->recompiler->Flush();
+    }
+
+    if (this->translation) {
+        this->translation->Flush();
+    }
+}
+
+Chip8::QuirkProfile Chip8::GetQuirkProfile(void) const {
+    return this->quirkProfile;
+}
+
+// Interface
+
+void Chip8::SetInterface(Interface* newInterface) {
+    this->currentInterface = newInterface;
+}
+
+// Keypad
+
+void Chip8::SetKey(uint8 keyIndex, bool isPressed) {
+    uint16 keyBit = 1 << (keyIndex % Chip8::NumberOfKeys);
+
+    if (!isPressed) {
+        this->keyStates.fetch_and(~keyBit, std::memory_order_release);
+        return;
+    }
+
+    this->pressTime.store(Scheduler::Now(), std::memory_order_relaxed);
+    this->keyStates.fetch_or(keyBit, std::memory_order_release);
+
+    // Latched under the lock, so a CPU about to park either sees the press or gets the notification.
+
+    {
+        std::lock_guard<std::mutex> keyGuard(this->keyLock);
+        this->pressedKeys.fetch_or(keyBit, std::memory_order_release);
+    }
+
+    this->keyCondition.notify_one();
+}
+
+void Chip8::SetKeyStates(uint16 keyMask) {
+    uint16 pressedKeys = keyMask & ~this->keyStates.exchange(keyMask, std::memory_order_acq_rel);
+
+    if (!pressedKeys) {
+        return;
+    }
+
+    this->pressTime.store(Scheduler::Now(), std::memory_order_relaxed);
+
+    {
+        std::lock_guard<std::mutex> keyGuard(this->keyLock);
+        this->pressedKeys.fetch_or(pressedKeys, std::memory_order_release);
+    }
+
+    this->keyCondition.notify_one();
+}
+
+uint16 Chip8::GetKeyStates(void) const {
+    return this->keyStates.load(std::memory_order_acquire);
+}
+
+const IntervalStatistics& Chip8::GetKeyLatency(void) const {
+    return this->keyLatency;
+}
+
+bool Chip8::WaitForKey(uint64 wakeTime) {
+    // Scheduler::Now and steady_clock are both CLOCK_MONOTONIC.
+
+    std::chrono::steady_clock::time_point wakePoint(std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::nanoseconds(wakeTime)));
+    std::unique_lock<std::mutex>          keyGuard(this->keyLock);
+
+    return this->keyCondition.wait_until(keyGuard, wakePoint, [this]() { return this->pressedKeys.load(std::memory_order_acquire) != 0; });
+}
+
+// Audio
+
+void Chip8::SetAudio(Audio* newAudio) {
+    this->currentAudio = newAudio;
+    this->isBeeping    = false;
+
+    if (this->currentAudio) {
+        this->UpdateBeeper();
+    }
+}
+
+// Rewind
+
+void Chip8::SetRewind(Rewind* newRewind) {
+    this->currentRewind = newRewind;
+}
+
+// Tracing
+
+void Chip8::SetTracer(Tracer* newTracer) {
+    this->currentTracer = newTracer;
+}
+
+#ifdef CHIP8_PROFILE
+
+// Profiling
+
+Profiler& Chip8::GetProfiler(void) {
+    if (this->recompiler) {
+        this->recompiler->FlushProfile();
+    }
+
+    return this->profiler;
+}
+
+const Profiler& Chip8::GetProfiler(void) const {
+    return this->profiler;
+}
+
+#endif    // CHIP8_PROFILE
+
+// Execution
+
+inline uint16 Chip8::FetchOpCode(void) const {
+    return (this->ReadMemory(this->programCounter & 0xFFF) << 8) | this->ReadMemory((this->programCounter + 1) & 0xFFF);
+}
+
+uint64 Chip8::Execute(uint64 numberOfCycles) {
+#ifdef CHIP8_PROFILE
+    uint64 startTicks = this->profiler.StartExecution();
+#endif
+
+    uint64 retiredInstructions;
+
+    switch (this->currentEngine) {
+        case Chip8::Predecoded: retiredInstructions = this->ExecutePredecoded(numberOfCycles); break;
+        case Chip8::Recompiled: retiredInstructions = this->currentTracer ? this->ExecutePredecoded(numberOfCycles) : this->recompiler->Execute(numberOfCycles); break;
+        case Chip8::Translated: retiredInstructions = this->currentTracer ? this->ExecutePredecoded(numberOfCycles) : this->translation->Execute(numberOfCycles); break;
+        default: retiredInstructions = this->ExecuteInterpreted(numberOfCycles); break;
+    }
+
+#ifdef CHIP8_PROFILE
+    this->profiler.StopExecution(startTicks, retiredInstructions);
+#endif
+
+    return retiredInstructions;
+}
+
+uint64 Chip8::ExecuteInterpreted(uint64 numberOfCycles) {
+    switch (this->quirkProfile) {
+        case Chip8::QuirksCHIP48: return this->ExecuteInterpreted<Chip8::QuirksCHIP48>(numberOfCycles);
+        case Chip8::QuirksSCHIP: return this->ExecuteInterpreted<Chip8::QuirksSCHIP>(numberOfCycles);
+        default: return this->ExecuteInterpreted<Chip8::QuirksVIP>(numberOfCycles);
+    }
+}
+
+uint64 Chip8::ExecutePredecoded(uint64 numberOfCycles) {
+    switch (this->quirkProfile) {
+        case Chip8::QuirksCHIP48: return this->ExecutePredecoded<Chip8::QuirksCHIP48>(numberOfCycles);
+        case Chip8::QuirksSCHIP: return this->ExecutePredecoded<Chip8::QuirksSCHIP>(numberOfCycles);
+        default: return this->ExecutePredecoded<Chip8::QuirksVIP>(numberOfCycles);
+    }
+}
+
+template <Chip8::QuirkProfile Profile> uint64 Chip8::ExecuteInterpreted(uint64 numberOfCycles) {
+    Instruction currentInstruction;
+    uint64      retiredInstructions = 0;
+
+    while (retiredInstructions < numberOfCycles) {
+        this->Decode(this->opCode = this->FetchOpCode(), currentInstruction);
+        this->Dispatch<Profile>(currentInstruction);
+
+        if (!this->isRunning) {
             break;
         }
 
-        default: {
-            this->Halt("Unknown opCode: %02x %02x.", this->opCode >> 8, this->opCode & 0xFF);
+        retiredInstructions++;
+    }
+
+    return retiredInstructions;
+}
+
+template <Chip8::QuirkProfile Profile> uint64 Chip8::ExecutePredecoded(uint64 numberOfCycles) {
+    uint64 retiredInstructions = 0;
+
+    while (retiredInstructions < numberOfCycles) {
+        const Instruction& decodedInstruction = this->decodedMemory[this->programCounter & 0xFFF];
+
+        this->opCode = decodedInstruction.opCode;
+        this->Dispatch<Profile>(decodedInstruction);
+
+        if (!this->isRunning) {
+            break;
+        }
+
+        retiredInstructions++;
+    }
+
+    return retiredInstructions;
+}
+
+inline uint8 Chip8::NextRandom(void) {
+    this->randomState ^= this->randomState << 13;
+    this->randomState ^= this->randomState >> 17;
+    this->randomState ^= this->randomState << 5;
+
+    return this->randomState >> 24;
+}
+
+void Chip8::Halt(const string haltMessage, ...) {
+    char    messageBuffer[4097];
+    va_list messageArguments;
+
+    va_start(messageArguments, haltMessage);
+    vsnprintf(messageBuffer, sizeof(messageBuffer), haltMessage.c_str(), messageArguments);
+    va_end(messageArguments);
+
+    Error(Chip8::Tag, ">>> HALTED AT $%03x >>> %s", this->programCounter, messageBuffer);
+    this->isRunning  = false;
+    this->stopReason = Chip8::Halted;
+}
+
+// Timers
+
+void Chip8::Tick(void) {
+#ifdef CHIP8_PROFILE
+    uint64 startTicks = this->profiler.StartUpdate();
+#endif
+
+    if (this->currentInterface) {
+        this->currentInterface->Update(this->dirtyRegion);
+    }
+
+#ifdef CHIP8_PROFILE
+    this->profiler.StopUpdate(startTicks);
+    this->profiler.RecordFrame();
+#endif
+
+    this->dirtyRegion.isDirty = false;
+
+    if (this->soundTimer > 0) {
+        this->soundTimer--;
+    }
+
+    if (this->delayTimer > 0) {
+        this->delayTimer--;
+    }
+
+    this->UpdateBeeper();
+
+    if (this->currentTracer) {
+        this->currentTracer->AdvanceFrame();
+    }
+
+    if (this->currentRewind) {
+        this->currentRewind->Capture();
+    }
+}
+
+void Chip8::UpdateBeeper(void) {
+    // The beeper sounds while the sound timer runs, the sink only hears about changes.
+
+    bool isBeeping = this->soundTimer > 0;
+
+    if (isBeeping != this->isBeeping) {
+        this->isBeeping = isBeeping;
+
+        if (this->currentAudio) {
+            this->currentAudio->SetBeeper(isBeeping);
+        }
+    }
+}
+
+// Decoding
+
+void Chip8::Decode(uint16 opCode, Instruction& instruction) {
+    instruction.opCode    = opCode;
+    instruction.address   = opCode & 0xFFF;
+    instruction.registerX = (opCode >> 8) & 0xF;
+    instruction.registerY = (opCode >> 4) & 0xF;
+    instruction.value     = opCode & 0xFF;
+    instruction.nibble    = opCode & 0xF;
+    instruction.operation = Chip8::OperationUnknown;
+
+    switch (opCode >> 12) {
+        case 0x0: {
+            switch (opCode & 0xFFF0) {
+                case 0x00B0: instruction.operation = Chip8::Operation00BN; break;
+                case 0x00C0: instruction.operation = Chip8::Operation00CN; break;
+                case 0x0600: instruction.operation = Chip8::Operation060N; break;
+                case 0x0800: instruction.operation = Chip8::Operation080N; break;
+            }
+
+            switch (opCode & 0xFF00) {
+                case 0x0100: instruction.operation = Chip8::Operation01NN; break;
+                case 0x0200: instruction.operation = Chip8::Operation02NN; break;
+                case 0x0300: instruction.operation = Chip8::Operation03NN; break;
+                case 0x0400: instruction.operation = Chip8::Operation04NN; break;
+                case 0x0500: instruction.operation = Chip8::Operation05NN; break;
+            }
+
+            switch (opCode) {
+                case 0x0010: instruction.operation = Chip8::Operation0010; break;
+                case 0x0011: instruction.operation = Chip8::Operation0011; break;
+                case 0x00E0: instruction.operation = Chip8::Operation00E0; break;
+                case 0x00EE: instruction.operation = Chip8::Operation00EE; break;
+                case 0x00FB: instruction.operation = Chip8::Operation00FB; break;
+                case 0x00FC: instruction.operation = Chip8::Operation00FC; break;
+                case 0x00FD: instruction.operation = Chip8::Operation00FD; break;
+                case 0x00FE: instruction.operation = Chip8::Operation00FE; break;
+                case 0x00FF: instruction.operation = Chip8::Operation00FF; break;
+                case 0x0700: instruction.operation = Chip8::Operation0700; break;
+            }
+
+            break;
+        }
+
+        case 0x1: instruction.operation = Chip8::Operation1NNN; break;
+        case 0x2: instruction.operation = Chip8::Operation2NNN; break;
+        case 0x3: instruction.operation = Chip8::Operation3XNN; break;
+        case 0x4: instruction.operation = Chip8::Operation4XNN; break;
+        case 0x5: instruction.operation = Chip8::Operation5XY0; break;
+        case 0x6: instruction.operation = Chip8::Operation6XNN; break;
+        case 0x7: instruction.operation = Chip8::Operation7XNN; break;
+
+        case 0x8: {
+            switch (instruction.nibble) {
+                case 0x0: instruction.operation = Chip8::Operation8XY0; break;
+                case 0x1: instruction.operation = Chip8::Operation8XY1; break;
+                case 0x2: instruction.operation = Chip8::Operation8XY2; break;
+                case 0x3: instruction.operation = Chip8::Operation8XY3; break;
+                case 0x4: instruction.operation = Chip8::Operation8XY4; break;
+                case 0x5: instruction.operation = Chip8::Operation8XY5; break;
+                case 0x6: instruction.operation = Chip8::Operation8XY6; break;
+                case 0x7: instruction.operation = Chip8::Operation8XY7; break;
+                case 0xE: instruction.operation = Chip8::Operation8XYE; break;
+            }
+
+            break;
+        }
+
+        case 0x9: instruction.operation = Chip8::Operation9XY0; break;
+        case 0xA: instruction.operation = Chip8::OperationANNN; break;
+        case 0xB: instruction.operation = Chip8::OperationBNNN; break;
+        case 0xC: instruction.operation = Chip8::OperationCXNN; break;
+        case 0xD: instruction.operation = Chip8::OperationDXYN; break;
+
+        case 0xE: {
+            switch (instruction.value) {
+                case 0x9E: instruction.operation = Chip8::OperationEX9E; break;
+                case 0xA1: instruction.operation = Chip8::OperationEXA1; break;
+            }
+
+            break;
+        }
+
+        case 0xF: {
+            switch (instruction.value) {
+                case 0x07: instruction.operation = Chip8::OperationFX07; break;
+                case 0x0A: instruction.operation = Chip8::OperationFX0A; break;
+                case 0x15: instruction.operation = Chip8::OperationFX15; break;
+                case 0x18: instruction.operation = Chip8::OperationFX18; break;
+                case 0x1E: instruction.operation = Chip8::OperationFX1E; break;
+                case 0x29: instruction.operation = Chip8::OperationFX29; break;
+                case 0x30: instruction.operation = Chip8::OperationFX30; break;
+                case 0x33: instruction.operation = Chip8::OperationFX33; break;
+                case 0x55: instruction.operation = Chip8::OperationFX55; break;
+                case 0x65: instruction.operation = Chip8::OperationFX65; break;
+                case 0x75: instruction.operation = Chip8::OperationFX75; break;
+                case 0x85: instruction.operation = Chip8::OperationFX85; break;
+            }
+
+            break;
+        }
+    }
+}
+
+template <Chip8::QuirkProfile Profile> inline void Chip8::Dispatch(const Instruction& instruction) {
+#ifdef CHIP8_PROFILE
+    if (instruction.operation != Chip8::OperationDecode) {
+        this->profiler.RecordInstruction(this->programCounter, instruction.operation);
+    }
+#endif
+
+    if (this->currentTracer && (instruction.operation != Chip8::OperationDecode)) {
+        this->DispatchTraced<Profile>(instruction);
+    } else {
+        this->DispatchOperation<Profile>(instruction);
+    }
+}
+
+template <Chip8::QuirkProfile Profile> inline void Chip8::DispatchOperation(const Instruction& instruction) {
+    switch (instruction.operation) {
+        case Chip8::OperationDecode: this->OpDecode<Profile>(instruction); break;
+        case Chip8::OperationUnknown: this->OpUnknown(instruction); break;
+        case Chip8::Operation00E0: this->Op00E0(instruction); break;
+        case Chip8::Operation00EE: this->Op00EE(instruction); break;
+        case Chip8::Operation00BN: this->Op00BN(instruction); break;
+        case Chip8::Operation00CN: this->Op00CN(instruction); break;
+        case Chip8::Operation00FB: this->Op00FB(instruction); break;
+        case Chip8::Operation00FC: this->Op00FC(instruction); break;
+        case Chip8::Operation00FD: this->Op00FD(instruction); break;
+        case Chip8::Operation00FE: this->Op00FE(instruction); break;
+        case Chip8::Operation00FF: this->Op00FF(instruction); break;
+        case Chip8::Operation0010: this->Op0010(instruction); break;
+        case Chip8::Operation0011: this->Op0011(instruction); break;
+        case Chip8::Operation01NN: this->Op01NN(instruction); break;
+        case Chip8::Operation02NN: this->Op02NN(instruction); break;
+        case Chip8::Operation03NN: this->Op03NN(instruction); break;
+        case Chip8::Operation04NN: this->Op04NN(instruction); break;
+        case Chip8::Operation05NN: this->Op05NN(instruction); break;
+        case Chip8::Operation060N: this->Op060N(instruction); break;
+        case Chip8::Operation0700: this->Op0700(instruction); break;
+        case Chip8::Operation080N: this->Op080N(instruction); break;
+        case Chip8::Operation1NNN: this->Op1NNN(instruction); break;
+        case Chip8::Operation2NNN: this->Op2NNN(instruction); break;
+        case Chip8::Operation3XNN: this->Op3XNN(instruction); break;
+        case Chip8::Operation4XNN: this->Op4XNN(instruction); break;
+        case Chip8::Operation5XY0: this->Op5XY0(instruction); break;
+        case Chip8::Operation6XNN: this->Op6XNN(instruction); break;
+        case Chip8::Operation7XNN: this->Op7XNN(instruction); break;
+        case Chip8::Operation8XY0: this->Op8XY0(instruction); break;
+        case Chip8::Operation8XY1: this->Op8XY1<Profile>(instruction); break;
+        case Chip8::Operation8XY2: this->Op8XY2<Profile>(instruction); break;
+        case Chip8::Operation8XY3: this->Op8XY3<Profile>(instruction); break;
+        case Chip8::Operation8XY4: this->Op8XY4(instruction); break;
+        case Chip8::Operation8XY5: this->Op8XY5(instruction); break;
+        case Chip8::Operation8XY6: this->Op8XY6<Profile>(instruction); break;
+        case Chip8::Operation8XY7: this->Op8XY7(instruction); break;
+        case Chip8::Operation8XYE: this->Op8XYE<Profile>(instruction); break;
+        case Chip8::Operation9XY0: this->Op9XY0(instruction); break;
+        case Chip8::OperationANNN: this->OpANNN(instruction); break;
+        case Chip8::OperationBNNN: this->OpBNNN<Profile>(instruction); break;
+        case Chip8::OperationCXNN: this->OpCXNN(instruction); break;
+        case Chip8::OperationDXYN: this->OpDXYN<Profile>(instruction); break;
+        case Chip8::OperationEX9E: this->OpEX9E(instruction); break;
+        case Chip8::OperationEXA1: this->OpEXA1(instruction); break;
+        case Chip8::OperationFX07: this->OpFX07(instruction); break;
+        case Chip8::OperationFX0A: this->OpFX0A(instruction); break;
+        case Chip8::OperationFX15: this->OpFX15(instruction); break;
+        case Chip8::OperationFX18: this->OpFX18(instruction); break;
+        case Chip8::OperationFX1E: this->OpFX1E(instruction); break;
+        case Chip8::OperationFX29: this->OpFX29(instruction); break;
+        case Chip8::OperationFX30: this->OpFX30(instruction); break;
+        case Chip8::OperationFX33: this->OpFX33(instruction); break;
+        case Chip8::OperationFX55: this->OpFX55<Profile>(instruction); break;
+        case Chip8::OperationFX65: this->OpFX65<Profile>(instruction); break;
+        case Chip8::OperationFX75: this->OpFX75(instruction); break;
+        case Chip8::OperationFX85: this->OpFX85(instruction); break;
+        case Chip8::OperationIdleJump: this->OpIdleJump(instruction); break;
+    }
+}
+
+template <Chip8::QuirkProfile Profile> void Chip8::DispatchTraced(const Instruction& instruction) {
+    Tracer::Record newRecord;
+    uint8          previousRegisters[16];
+
+    newRecord.frameNumber    = this->currentTracer->GetFrameNumber();
+    newRecord.programCounter = this->programCounter;
+    newRecord.opCode         = instruction.opCode;
+    memcpy(previousRegisters, this->cpuRegisters, sizeof(previousRegisters));
+
+    this->DispatchOperation<Profile>(instruction);
+
+    newRecord.addressRegister  = this->addressRegister;
+    newRecord.changedRegisters = 0;
+    newRecord.delayTimer       = this->delayTimer;
+    newRecord.soundTimer       = this->soundTimer;
+    newRecord.stackPointer     = this->stackPointer;
+    newRecord.addressHigh      = this->addressRegister >> 16;
+    memcpy(newRecord.cpuRegisters, this->cpuRegisters, sizeof(newRecord.cpuRegisters));
+
+    for (uint registerIndex = 0; registerIndex < 16; ++registerIndex) {
+        newRecord.changedRegisters |= (previousRegisters[registerIndex] != this->cpuRegisters[registerIndex]) << registerIndex;
+    }
+
+    this->currentTracer->Append(newRecord);
+}
+
+void Chip8::InvalidateCode(uint32 address, uint length) {
+    // Code only runs from the first 4 KB, writes above it are data. I is wider than memory, and the writes wrap around
+    // it like WriteMemory does.
+
+    address &= this->memoryMask;
+
+    if (!this->decodedMemory || (address >= sizeof(RAM))) {
+        return;
+    }
+
+    if (this->recompiler) {
+        this->recompiler->Invalidate(address, length);
+    }
+
+    if (this->translation) {
+        this->translation->Invalidate(address, length);
+    }
+
+    // An instruction starting one byte before the write overlaps it too.
+
+    for (uint byteIndex = 0; byteIndex <= length; ++byteIndex) {
+        this->decodedMemory[(address + byteIndex - 1) & 0xFFF].operation = Chip8::OperationDecode;
+    }
+}
+
+void Chip8::InvalidateAllCode(void) {
+    if (!this->decodedMemory) {
+        return;
+    }
+
+    if (this->recompiler) {
+        this->recompiler->Flush();
+    }
+
+    if (this->translation) {
+        this->translation->Flush();
+    }
+
+    for (uint instructionAddress = 0; instructionAddress < sizeof(RAM); ++instructionAddress) {
+        this->decodedMemory[instructionAddress].operation = Chip8::OperationDecode;
+    }
+}
+
+// Operations
+
+template <Chip8::QuirkProfile Profile> void Chip8::OpDecode(const Instruction& instruction) {
+    Instruction& decodedInstruction = this->decodedMemory[this->programCounter & 0xFFF];
+
+    this->Decode(this->opCode = this->FetchOpCode(), decodedInstruction);
+
+    if ((decodedInstruction.operation == Chip8::Operation1NNN) && this->IsIdleLoop(this->programCounter, decodedInstruction.address)) {
+        decodedInstruction.operation = Chip8::OperationIdleJump;
+    }
+
+    this->Dispatch<Profile>(decodedInstruction);
+}
+
+void Chip8::OpUnknown(const Instruction& instruction) {
+    this->Halt("Unknown opCode: %02x %02x.", instruction.opCode >> 8, instruction.opCode & 0xFF);
+}
+
+void Chip8::Op00E0(const Instruction& instruction) {
+    // MEGA-CHIP programs present their frames by clearing the screen, the completed one goes to the interface. The low
+    // resolution screen only uses the first quarter of the words.
+
+    if (this->isMegaChip) {
+        this->megaChip->drawnScreen ^= 1;
+        memset(this->megaChip->screenMemory[this->megaChip->drawnScreen], 0, sizeof(IndexedVRAM));
+    } else if (this->isExtendedScreen) {
+        memset(this->videoMemory, 0, sizeof(this->videoMemory));
+    } else {
+        memset(this->videoMemory, 0, Chip8::ScreenHeight * sizeof(this->videoMemory[0]));
+    }
+
+    this->MarkDirty(0, this->GetScreenHeight() - 1);
+    this->programCounter += 2;
+}
+
+void Chip8::Op00EE(const Instruction& instruction) {
+    if (this->stackPointer == 0) {
+        this->Halt("No subroutine to return from.");
+        return;
+    }
+
+    this->programCounter = this->callStack[--this->stackPointer];
+}
+
+void Chip8::Op00BN(const Instruction& instruction) {
+    // Whole rows move up at once, the rows scrolled in at the bottom are blank.
+
+    if (this->isMegaChip) {
+        uint8* screenMemory = this->megaChip->screenMemory[this->megaChip->drawnScreen];
+        uint   scrollSize   = instruction.nibble * Chip8::MegaScreenWidth;
+
+        memmove(screenMemory, screenMemory + scrollSize, sizeof(IndexedVRAM) - scrollSize);
+        memset(screenMemory + sizeof(IndexedVRAM) - scrollSize, 0, scrollSize);
+        this->programCounter += 2;
+        return;
+    }
+
+    uint rowWords    = this->isExtendedScreen ? 2 : 1;
+    uint screenWords = this->GetScreenHeight() * rowWords;
+    uint scrollWords = instruction.nibble * rowWords;
+
+    memmove(this->videoMemory, &this->videoMemory[scrollWords], (screenWords - scrollWords) * sizeof(uint64));
+    memset(&this->videoMemory[screenWords - scrollWords], 0, scrollWords * sizeof(uint64));
+
+    this->MarkDirty(0, this->GetScreenHeight() - 1);
+    this->programCounter += 2;
+}
+
+void Chip8::Op00CN(const Instruction& instruction) {
+    // Whole rows move down at once, the rows scrolled in at the top are blank.
+
+    if (this->isMegaChip) {
+        uint8* screenMemory = this->megaChip->screenMemory[this->megaChip->drawnScreen];
+        uint   scrollSize   = instruction.nibble * Chip8::MegaScreenWidth;
+
+        memmove(screenMemory + scrollSize, screenMemory, sizeof(IndexedVRAM) - scrollSize);
+        memset(screenMemory, 0, scrollSize);
+        this->programCounter += 2;
+        return;
+    }
+
+    uint rowWords    = this->isExtendedScreen ? 2 : 1;
+    uint screenWords = this->GetScreenHeight() * rowWords;
+    uint scrollWords = instruction.nibble * rowWords;
+
+    memmove(&this->videoMemory[scrollWords], this->videoMemory, (screenWords - scrollWords) * sizeof(uint64));
+    memset(this->videoMemory, 0, scrollWords * sizeof(uint64));
+
+    this->MarkDirty(0, this->GetScreenHeight() - 1);
+    this->programCounter += 2;
+}
+
+void Chip8::Op00FB(const Instruction& instruction) {
+    // Four pixels to the right: one shift per word, the extended screen carries the left word of a row into the right one.
+    // MEGA-CHIP rows are moved four bytes.
+
+    if (this->isMegaChip) {
+        uint8* screenMemory = this->megaChip->screenMemory[this->megaChip->drawnScreen];
+
+        for (uint rowOffset = 0; rowOffset < sizeof(IndexedVRAM); rowOffset += Chip8::MegaScreenWidth) {
+            memmove(screenMemory + rowOffset + 4, screenMemory + rowOffset, Chip8::MegaScreenWidth - 4);
+            memset(screenMemory + rowOffset, 0, 4);
+        }
+
+        this->programCounter += 2;
+        return;
+    }
+
+    if (this->isExtendedScreen) {
+        for (uint wordIndex = 0; wordIndex < (Chip8::ExtendedScreenHeight * 2); wordIndex += 2) {
+            this->videoMemory[wordIndex + 1] = (this->videoMemory[wordIndex + 1] >> 4) | (this->videoMemory[wordIndex] << 60);
+            this->videoMemory[wordIndex] >>= 4;
+        }
+    } else {
+        for (uint wordIndex = 0; wordIndex < Chip8::ScreenHeight; ++wordIndex) {
+            this->videoMemory[wordIndex] >>= 4;
+        }
+    }
+
+    this->MarkDirty(0, this->GetScreenHeight() - 1);
+    this->programCounter += 2;
+}
+
+void Chip8::Op00FC(const Instruction& instruction) {
+    if (this->isMegaChip) {
+        uint8* screenMemory = this->megaChip->screenMemory[this->megaChip->drawnScreen];
+
+        for (uint rowOffset = 0; rowOffset < sizeof(IndexedVRAM); rowOffset += Chip8::MegaScreenWidth) {
+            memmove(screenMemory + rowOffset, screenMemory + rowOffset + 4, Chip8::MegaScreenWidth - 4);
+            memset(screenMemory + rowOffset + Chip8::MegaScreenWidth - 4, 0, 4);
+        }
+
+        this->programCounter += 2;
+        return;
+    }
+
+    if (this->isExtendedScreen) {
+        for (uint wordIndex = 0; wordIndex < (Chip8::ExtendedScreenHeight * 2); wordIndex += 2) {
+            this->videoMemory[wordIndex] = (this->videoMemory[wordIndex] << 4) | (this->videoMemory[wordIndex + 1] >> 60);
+            this->videoMemory[wordIndex + 1] <<= 4;
+        }
+    } else {
+        for (uint wordIndex = 0; wordIndex < Chip8::ScreenHeight; ++wordIndex) {
+            this->videoMemory[wordIndex] <<= 4;
+        }
+    }
+
+    this->MarkDirty(0, this->GetScreenHeight() - 1);
+    this->programCounter += 2;
+}
+
+void Chip8::Op00FD(const Instruction& instruction) {
+    this->isRunning  = false;
+    this->stopReason = Chip8::Exited;
+}
+
+void Chip8::Op00FE(const Instruction& instruction) {
+    this->SetExtendedScreen(false);
+    this->programCounter += 2;
+}
+
+void Chip8::Op00FF(const Instruction& instruction) {
+    this->SetExtendedScreen(true);
+    this->programCounter += 2;
+}
+
+void Chip8::Op0010(const Instruction& instruction) {
+    // MEGA-CHIP instructions other than 0011 (which switches the mode on) are unknown to the classic machines.
+
+    if (!this->isMegaChip) {
+        this->OpUnknown(instruction);
+        return;
+    }
+
+    this->SetMegaChip(false);
+    this->programCounter += 2;
+}
+
+void Chip8::Op0011(const Instruction& instruction) {
+    if (!this->SetMegaChip(true)) {
+        this->Halt("Could not enable MEGA-CHIP mode.");
+        return;
+    }
+
+    this->programCounter += 2;
+}
+
+void Chip8::Op01NN(const Instruction& instruction) {
+    if (!this->isMegaChip) {
+        this->OpUnknown(instruction);
+        return;
+    }
+
+    // The low 16 bits of I are the next instruction slot, which is skipped.
+
+    this->addressRegister = (instruction.value << 16) | (this->ReadMemory((this->programCounter + 2) & 0xFFF) << 8) | this->ReadMemory((this->programCounter + 3) & 0xFFF);
+    this->programCounter += 4;
+}
+
+void Chip8::Op02NN(const Instruction& instruction) {
+    if (!this->isMegaChip) {
+        this->OpUnknown(instruction);
+        return;
+    }
+
+    // NN colors from I, four bytes each (alpha, red, green, blue), into the palette from index 1 on.
+
+    for (uint colorIndex = 0; (colorIndex < instruction.value) && (colorIndex < 255); ++colorIndex) {
+        uint32 colorAddress = this->addressRegister + (colorIndex * 4);
+        uint32 colorValue   = 0;
+
+        for (uint byteIndex = 0; byteIndex < 4; ++byteIndex) {
+            colorValue = (colorValue << 8) | this->ReadMemory(colorAddress + byteIndex);
+        }
+
+        this->megaChip->palette[colorIndex + 1] = colorValue;
+    }
+
+    this->programCounter += 2;
+}
+
+void Chip8::Op03NN(const Instruction& instruction) {
+    if (!this->isMegaChip) {
+        this->OpUnknown(instruction);
+        return;
+    }
+
+    this->megaChip->spriteWidth = instruction.value;
+
+    this->programCounter += 2;
+}
+
+void Chip8::Op04NN(const Instruction& instruction) {
+    if (!this->isMegaChip) {
+        this->OpUnknown(instruction);
+        return;
+    }
+
+    this->megaChip->spriteHeight = instruction.value;
+
+    this->programCounter += 2;
+}
+
+void Chip8::Op05NN(const Instruction& instruction) {
+    if (!this->isMegaChip) {
+        this->OpUnknown(instruction);
+        return;
+    }
+
+    this->megaChip->screenAlpha = instruction.value;
+
+    this->programCounter += 2;
+}
+
+void Chip8::Op060N(const Instruction& instruction) {
+    if (!this->isMegaChip) {
+        this->OpUnknown(instruction);
+        return;
+    }
+
+    // There is no sample playback yet, the sound is only tracked.
+
+    this->megaChip->soundAddress   = this->addressRegister;
+    this->megaChip->isSoundPlaying = true;
+    this->megaChip->isSoundLooping = instruction.nibble == 0;
+
+    this->programCounter += 2;
+}
+
+void Chip8::Op0700(const Instruction& instruction) {
+    if (!this->isMegaChip) {
+        this->OpUnknown(instruction);
+        return;
+    }
+
+    this->megaChip->isSoundPlaying = false;
+
+    this->programCounter += 2;
+}
+
+void Chip8::Op080N(const Instruction& instruction) {
+    if (!this->isMegaChip) {
+        this->OpUnknown(instruction);
+        return;
+    }
+
+    this->megaChip->blendMode = instruction.nibble;
+
+    this->programCounter += 2;
+}
+
+void Chip8::Op1NNN(const Instruction& instruction) {
+    this->programCounter = instruction.address;
+}
+
+void Chip8::Op2NNN(const Instruction& instruction) {
+    if (this->stackPointer >= 15) {
+        this->Halt("Stack overflow.");
+        return;
+    }
+
+    this->callStack[this->stackPointer++] = this->programCounter + 2;
+    this->programCounter                  = instruction.address;
+}
+
+void Chip8::Op3XNN(const Instruction& instruction) {
+    this->programCounter += ((this->cpuRegisters[instruction.registerX] == instruction.value) * 2) + 2;
+}
+
+void Chip8::Op4XNN(const Instruction& instruction) {
+    this->programCounter += ((this->cpuRegisters[instruction.registerX] != instruction.value) * 2) + 2;
+}
+
+void Chip8::Op5XY0(const Instruction& instruction) {
+    this->programCounter += ((this->cpuRegisters[instruction.registerX] == this->cpuRegisters[instruction.registerY]) * 2) + 2;
+}
+
+void Chip8::Op6XNN(const Instruction& instruction) {
+    this->cpuRegisters[instruction.registerX] = instruction.value;
+    this->programCounter += 2;
+}
+
+void Chip8::Op7XNN(const Instruction& instruction) {
+    this->cpuRegisters[instruction.registerX] += instruction.value;
+    this->programCounter += 2;
+}
+
+void Chip8::Op8XY0(const Instruction& instruction) {
+    this->cpuRegisters[instruction.registerX] = this->cpuRegisters[instruction.registerY];
+    this->programCounter += 2;
+}
+
+template <Chip8::QuirkProfile Profile> void Chip8::Op8XY1(const Instruction& instruction) {
+    this->cpuRegisters[instruction.registerX] |= this->cpuRegisters[instruction.registerY];
+
+    if (Quirks<Profile>::LogicResetsVF) {
+        this->cpuRegisters[0xF] = 0;
+    }
+
+    this->programCounter += 2;
+}
+
+template <Chip8::QuirkProfile Profile> void Chip8::Op8XY2(const Instruction& instruction) {
+    this->cpuRegisters[instruction.registerX] &= this->cpuRegisters[instruction.registerY];
+
+    if (Quirks<Profile>::LogicResetsVF) {
+        this->cpuRegisters[0xF] = 0;
+    }
+
+    this->programCounter += 2;
+}
+
+template <Chip8::QuirkProfile Profile> void Chip8::Op8XY3(const Instruction& instruction) {
+    this->cpuRegisters[instruction.registerX] ^= this->cpuRegisters[instruction.registerY];
+
+    if (Quirks<Profile>::LogicResetsVF) {
+        this->cpuRegisters[0xF] = 0;
+    }
+
+    this->programCounter += 2;
+}
+
+void Chip8::Op8XY4(const Instruction& instruction) {
+    this->cpuRegisters[0xF] = UINT16(this->cpuRegisters[instruction.registerX] + this->cpuRegisters[instruction.registerY]) > 255;
+    this->cpuRegisters[instruction.registerX] += this->cpuRegisters[instruction.registerY];
+    this->programCounter += 2;
+}
+
+void Chip8::Op8XY5(const Instruction& instruction) {
+    this->cpuRegisters[0xF] = !(this->cpuRegisters[instruction.registerX] < this->cpuRegisters[instruction.registerY]);
+    this->cpuRegisters[instruction.registerX] -= this->cpuRegisters[instruction.registerY];
+    this->programCounter += 2;
+}
+
+template <Chip8::QuirkProfile Profile> void Chip8::Op8XY6(const Instruction& instruction) {
+    uint8 sourceRegister = Quirks<Profile>::ShiftUsesVY ? instruction.registerY : instruction.registerX;
+
+    this->cpuRegisters[0xF]                   = this->cpuRegisters[sourceRegister] & 0x1;
+    this->cpuRegisters[instruction.registerX] = this->cpuRegisters[sourceRegister] >> 1;
+    this->programCounter += 2;
+}
+
+void Chip8::Op8XY7(const Instruction& instruction) {
+    this->cpuRegisters[0xF]                   = !(this->cpuRegisters[instruction.registerY] < this->cpuRegisters[instruction.registerX]);
+    this->cpuRegisters[instruction.registerX] = this->cpuRegisters[instruction.registerY] - this->cpuRegisters[instruction.registerX];
+    this->programCounter += 2;
+}
+
+template <Chip8::QuirkProfile Profile> void Chip8::Op8XYE(const Instruction& instruction) {
+    uint8 sourceRegister = Quirks<Profile>::ShiftUsesVY ? instruction.registerY : instruction.registerX;
+
+    this->cpuRegisters[0xF]                   = this->cpuRegisters[sourceRegister] >> 7;
+    this->cpuRegisters[instruction.registerX] = this->cpuRegisters[sourceRegister] << 1;
+    this->programCounter += 2;
+}
+
+void Chip8::Op9XY0(const Instruction& instruction) {
+    this->programCounter += ((this->cpuRegisters[instruction.registerX] != this->cpuRegisters[instruction.registerY]) * 2) + 2;
+}
+
+void Chip8::OpANNN(const Instruction& instruction) {
+    this->addressRegister = instruction.address;
+    this->programCounter += 2;
+}
+
+template <Chip8::QuirkProfile Profile> void Chip8::OpBNNN(const Instruction& instruction) {
+    this->programCounter = instruction.address + this->cpuRegisters[Quirks<Profile>::JumpUsesVX ? instruction.registerX : 0];
+}
+
+void Chip8::OpCXNN(const Instruction& instruction) {
+    this->cpuRegisters[instruction.registerX] = this->NextRandom() & instruction.value;
+    this->programCounter += 2;
+}
+
+template <Chip8::QuirkProfile Profile> void Chip8::OpDXYN(const Instruction& instruction) {
+    if (this->isMegaChip) {
+        this->BlitSprite(instruction);
+    } else if (this->isExtendedScreen) {
+        this->DrawSprite<Profile, true>(instruction);
+    } else {
+        this->DrawSprite<Profile, false>(instruction);
+    }
+}
+
+template <Chip8::QuirkProfile Profile, bool IsExtended> inline void Chip8::DrawSprite(const Instruction& instruction) {
+    // Each sprite row is placed at the left edge of a word and shifted into position, what spills over goes into the next
+    // word of the row. Clipping profiles drop what falls off the right and bottom edges, the others wrap it around the
+    // screen. The starting position always wraps. The screen size is a constant in each mode, so the low resolution
+    // screen folds down to one word per row.
+
+    constexpr uint ScreenWidth  = IsExtended ? Chip8::ExtendedScreenWidth : Chip8::ScreenWidth;
+    constexpr uint ScreenHeight = IsExtended ? Chip8::ExtendedScreenHeight : Chip8::ScreenHeight;
+    constexpr uint RowWords     = ScreenWidth / 64;
+
+    uint32 lineAddress   = this->addressRegister;
+    uint   xPosition     = this->cpuRegisters[instruction.registerX] % ScreenWidth;
+    uint   yPosition     = this->cpuRegisters[instruction.registerY] % ScreenHeight;
+    uint   firstWord     = xPosition / 64;
+    uint   bitOffset     = xPosition % 64;
+    bool   isLastWord    = (firstWord + 1) == RowWords;
+    uint   nextWord      = isLastWord ? 0 : firstWord + 1;
+    bool   isLargeSprite = (instruction.nibble == 0) && (IsExtended || Quirks<Profile>::LargeSprites);
+    uint   numberOfLines = isLargeSprite ? 16 : instruction.nibble;
+    uint64 collisionMask = 0;
+
+    if (Quirks<Profile>::SpritesClip && ((yPosition + numberOfLines) > ScreenHeight)) {
+        numberOfLines = ScreenHeight - yPosition;
+    }
+
+    for (uint8 spriteLine = 0; spriteLine < numberOfLines; ++spriteLine) {
+        uint64 lineBits = UINT64(this->ReadMemory(lineAddress++)) << 56;
+
+        if (isLargeSprite) {
+            lineBits |= UINT64(this->ReadMemory(lineAddress++)) << 48;
+        }
+
+        uint64  leftBits  = lineBits >> bitOffset;
+        uint64  rightBits = (Quirks<Profile>::SpritesClip && isLastWord) || (bitOffset == 0) ? 0 : lineBits << (64 - bitOffset);
+        uint64* videoLine = &this->videoMemory[yPosition * RowWords];
+
+        if (leftBits | rightBits) {
+            collisionMask |= (videoLine[firstWord] & leftBits) | (videoLine[nextWord] & rightBits);
+            videoLine[firstWord] ^= leftBits;
+            videoLine[nextWord] ^= rightBits;
+            this->MarkDirty(yPosition, yPosition);
+        }
+
+        yPosition = (yPosition + 1) % ScreenHeight;
+    }
+
+    this->cpuRegisters[0xF] = collisionMask != 0;
+    this->programCounter += 2;
+}
+
+void Chip8::BlitSprite(const Instruction& instruction) {
+    // MEGA-CHIP sprites are one palette index per byte, SPRW x SPRH of them at I, clipped at the right and bottom edges.
+    // Sprites in the font area are still 1-bit rows of eight pixels, drawn with the last palette index.
+
+    uint8* screenMemory  = this->megaChip->screenMemory[this->megaChip->drawnScreen];
+    uint   xPosition     = this->cpuRegisters[instruction.registerX];
+    uint   yPosition     = this->cpuRegisters[instruction.registerY];
+    bool   isFontSprite  = this->addressRegister < Chip8::ProgramStartAddress;
+    uint   spriteWidth   = isFontSprite ? 8 : (this->megaChip->spriteWidth ? this->megaChip->spriteWidth : 256);
+    uint   spriteHeight  = isFontSprite ? instruction.nibble : (this->megaChip->spriteHeight ? this->megaChip->spriteHeight : 256);
+    uint32 lineAddress   = this->addressRegister;
+    bool   hasCollision  = false;
+    uint   visibleWidth  = std::min(spriteWidth, Chip8::MegaScreenWidth - xPosition);
+    uint   visibleHeight = yPosition < Chip8::MegaScreenHeight ? std::min(spriteHeight, Chip8::MegaScreenHeight - yPosition) : 0;
+    uint8  lineBuffer[256];
+
+    for (uint spriteLine = 0; spriteLine < visibleHeight; ++spriteLine) {
+        // Rows that stay inside a page are blitted straight from memory, the others are gathered first.
+
+        uint         pageOffset = lineAddress & (Chip8::PageSize - 1);
+        const uint8* linePixels = &this->memoryPages[(lineAddress & this->memoryMask) >> Chip8::PageBits][pageOffset];
+
+        if (isFontSprite) {
+            uint8 lineBits = *linePixels;
+
+            for (uint pixelIndex = 0; pixelIndex < 8; ++pixelIndex) {
+                lineBuffer[pixelIndex] = ((lineBits << pixelIndex) & 0x80) ? 0xFF : 0;
+            }
+
+            linePixels = lineBuffer;
+        } else if ((pageOffset + visibleWidth) > Chip8::PageSize) {
+            this->ReadMemoryBlock(lineAddress, lineBuffer, visibleWidth);
+            linePixels = lineBuffer;
+        }
+
+        hasCollision |= BlitRow(&screenMemory[((yPosition + spriteLine) * Chip8::MegaScreenWidth) + xPosition], linePixels, visibleWidth);
+        lineAddress += isFontSprite ? 1 : spriteWidth;
+    }
+
+    this->cpuRegisters[0xF] = hasCollision;
+    this->programCounter += 2;
+}
+
+void Chip8::OpEX9E(const Instruction& instruction) {
+    uint keyBit = (this->keyStates.load(std::memory_order_acquire) >> (this->cpuRegisters[instruction.registerX] & 0xF)) & 0x1;
+    this->programCounter += 2 + (keyBit << 1);
+}
+
+void Chip8::OpEXA1(const Instruction& instruction) {
+    uint keyBit = (this->keyStates.load(std::memory_order_acquire) >> (this->cpuRegisters[instruction.registerX] & 0xF)) & 0x1;
+    this->programCounter += 4 - (keyBit << 1);
+}
+
+void Chip8::OpFX07(const Instruction& instruction) {
+    this->cpuRegisters[instruction.registerX] = this->delayTimer;
+    this->programCounter += 2;
+}
+
+void Chip8::OpFX0A(const Instruction& instruction) {
+    // Only a key pressed after the wait began counts (the lowest one if several were). Until then the batch stops
+    // here, the CPU loop parks and FX0A runs again when it resumes.
+
+    if (!this->isWaitingForKey) {
+        this->pressedKeys.store(0, std::memory_order_relaxed);
+        this->isWaitingForKey = true;
+    } else {
+        uint16 pressedKeys = this->pressedKeys.exchange(0, std::memory_order_acquire);
+
+        if (pressedKeys) {
+            this->cpuRegisters[instruction.registerX] = __builtin_ctz(pressedKeys);
+            this->isWaitingForKey                     = false;
+            this->keyLatency.RecordInterval(Scheduler::Now() - this->pressTime.load(std::memory_order_relaxed));
+            this->programCounter += 2;
             return;
         }
     }
 
+    this->isRunning = false;
+}
+
+void Chip8::OpFX15(const Instruction& instruction) {
+    this->delayTimer = this->cpuRegisters[instruction.registerX];
+    this->programCounter += 2;
+}
+
+void Chip8::OpFX18(const Instruction& instruction) {
+    // The sink hears about a new tone now rather than at the next tick, a frame is too long to wait.
+
+    this->soundTimer = this->cpuRegisters[instruction.registerX];
+    this->UpdateBeeper();
+    this->programCounter += 2;
+}
+
+void Chip8::OpFX1E(const Instruction& instruction) {
+    this->addressRegister = (this->addressRegister + this->cpuRegisters[instruction.registerX]) & Chip8::AddressMask;
+    this->programCounter += 2;
+}
+
+void Chip8::OpFX29(const Instruction& instruction) {
+    this->addressRegister = Chip8::FontStartAddress + (this->cpuRegisters[instruction.registerX] * 5);
+    this->programCounter += 2;
+}
+
+void Chip8::OpFX30(const Instruction& instruction) {
+    this->addressRegister = Chip8::LargeFontStartAddress + ((this->cpuRegisters[instruction.registerX] & 0xF) * 10);
+    this->programCounter += 2;
+}
+
+void Chip8::OpFX33(const Instruction& instruction) {
+    uint8 registerValue = this->cpuRegisters[instruction.registerX];
+
+    this->WriteMemory(this->addressRegister, registerValue / 100);
+    this->WriteMemory(this->addressRegister + 1, (registerValue % 100) / 10);
+    this->WriteMemory(this->addressRegister + 2, (registerValue % 100) % 10);
+
+    this->InvalidateCode(this->addressRegister, 3);
+    this->programCounter += 2;
+}
+
+template <Chip8::QuirkProfile Profile> void Chip8::OpFX55(const Instruction& instruction) {
+    uint32 storeAddress = this->addressRegister;
+
+    for (uint registerIndex = 0; registerIndex <= instruction.registerX; ++registerIndex) {
+        this->WriteMemory(storeAddress + registerIndex, this->cpuRegisters[registerIndex]);
+    }
+
+    if (Quirks<Profile>::MemoryIncrement != Chip8::IncrementNone) {
+        this->addressRegister = (this->addressRegister + instruction.registerX + (Quirks<Profile>::MemoryIncrement == Chip8::IncrementXPlusOne)) & Chip8::AddressMask;
+    }
+
+    this->InvalidateCode(storeAddress, instruction.registerX + 1);
+    this->programCounter += 2;
+}
+
+template <Chip8::QuirkProfile Profile> void Chip8::OpFX65(const Instruction& instruction) {
+    uint32 loadAddress = this->addressRegister;
+
+    for (uint registerIndex = 0; registerIndex <= instruction.registerX; ++registerIndex) {
+        this->cpuRegisters[registerIndex] = this->ReadMemory(loadAddress + registerIndex);
+    }
+
+    if (Quirks<Profile>::MemoryIncrement != Chip8::IncrementNone) {
+        this->addressRegister = (this->addressRegister + instruction.registerX + (Quirks<Profile>::MemoryIncrement == Chip8::IncrementXPlusOne)) & Chip8::AddressMask;
+    }
+
+    this->programCounter += 2;
+}
+
+void Chip8::OpFX75(const Instruction& instruction) {
+    memcpy(this->flagRegisters, this->cpuRegisters, instruction.registerX + 1);
+    this->programCounter += 2;
+}
+
+void Chip8::OpFX85(const Instruction& instruction) {
+    memcpy(this->cpuRegisters, this->flagRegisters, instruction.registerX + 1);
     this->programCounter += 2;
 }
+
+void Chip8::OpIdleJump(const Instruction& instruction) {
+    // Coming back to the jump with the same V0-VF, I and delay timer as the last time means the loop may be idle. The
+    // batch stops before the jump for the CPU loop to make sure (traced runs record every instruction, they never do).
+
+    IdleLoop& idleLoop = this->idleLoop;
+
+    if (idleLoop.isWatched && (idleLoop.jumpAddress == this->programCounter) && (idleLoop.delayTimer == this->delayTimer) && (idleLoop.addressRegister == this->addressRegister) && (memcmp(idleLoop.cpuRegisters, this->cpuRegisters, sizeof(idleLoop.cpuRegisters)) == 0) && !this->currentTracer) {
+        this->isIdle    = true;
+        this->isRunning = false;
+        return;
+    }
+
+    idleLoop.isWatched       = true;
+    idleLoop.jumpAddress     = this->programCounter;
+    idleLoop.loopAddress     = instruction.address;
+    idleLoop.addressRegister = this->addressRegister;
+    idleLoop.delayTimer      = this->delayTimer;
+    memcpy(idleLoop.cpuRegisters, this->cpuRegisters, sizeof(idleLoop.cpuRegisters));
+
+    this->programCounter = instruction.address;
+}
@@ -9,96 +9,535 @@
 #define CHIP8_H
 
 #include "Core.hxx"
+#include "Profiler.hxx"
+#include "Scheduler.hxx"
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+
+class Rewind;
+class Tracer;
 
 // Chip8
 
 class Chip8 {
     public:
         Chip8(void);
+        ~Chip8();
 
         // Types
-        typedef uint8 RAM[4096];
-        typedef uint8 VRAM[6144];
-        typedef void (Chip8::*Operation)(void);
+        typedef uint8  RAM[4096];                 // The classic machine, larger memories are set with SetMemory
+        typedef uint64 VRAM[128];                 // One bit per pixel, one word per row (two in the extended screen), bit 63 is the leftmost pixel
+        typedef uint8  IndexedVRAM[256 * 192];    // MEGA-CHIP, one palette index per pixel, row after row
+        typedef uint32 Palette[256];              // MEGA-CHIP ARGB colors, index 0 is transparent
+
+        enum Operation {
+            OperationDecode,
+            OperationUnknown,
+            Operation00E0,
+            Operation00EE,
+            Operation00BN,
+            Operation00CN,
+            Operation00FB,
+            Operation00FC,
+            Operation00FD,
+            Operation00FE,
+            Operation00FF,
+            Operation0010,
+            Operation0011,
+            Operation01NN,
+            Operation02NN,
+            Operation03NN,
+            Operation04NN,
+            Operation05NN,
+            Operation060N,
+            Operation0700,
+            Operation080N,
+            Operation1NNN,
+            Operation2NNN,
+            Operation3XNN,
+            Operation4XNN,
+            Operation5XY0,
+            Operation6XNN,
+            Operation7XNN,
+            Operation8XY0,
+            Operation8XY1,
+            Operation8XY2,
+            Operation8XY3,
+            Operation8XY4,
+            Operation8XY5,
+            Operation8XY6,
+            Operation8XY7,
+            Operation8XYE,
+            Operation9XY0,
+            OperationANNN,
+            OperationBNNN,
+            OperationCXNN,
+            OperationDXYN,
+            OperationEX9E,
+            OperationEXA1,
+            OperationFX07,
+            OperationFX0A,
+            OperationFX15,
+            OperationFX18,
+            OperationFX1E,
+            OperationFX29,
+            OperationFX30,
+            OperationFX33,
+            OperationFX55,
+            OperationFX65,
+            OperationFX75,
+            OperationFX85,
+            OperationIdleJump,    // A 1NNN closing a short loop that may idle, only ever in the decoded cache
+            NumberOfOperations
+        };
+
+        struct Instruction {
+                uint16 opCode;
+                uint16 address;      // NNN
+                uint8  registerX;
+                uint8  registerY;
+                uint8  value;        // NN
+                uint8  nibble;       // N
+                uint8  operation;    // Operation
+        };
+
+        enum StopReason {
+            BudgetExhausted,
+            Halted,
+            Stopped,
+            Exited    // The program ran 00FD
+        };
+
+        enum Engine {
+            Interpreter,    // Fetches and decodes every instruction as it runs
+            Predecoded,     // Runs from a cache of decoded instructions that parallels RAM
+            Recompiled,     // Runs straight-line blocks as native code, falls back to the predecoded cache
+            Translated      // Runs a translation of the program linked in ahead of time, falls back to the predecoded cache
+        };
+
+        enum QuirkProfile {
+            QuirksVIP,       // COSMAC VIP
+            QuirksCHIP48,    // HP48 CHIP-48
+            QuirksSCHIP      // SUPER-CHIP 1.1
+        };
+
+        enum MemoryIncrement {
+            IncrementNone,        // FX55/FX65 leave I unchanged
+            IncrementX,           // I += X
+            IncrementXPlusOne     // I += X + 1
+        };
+
+        template <QuirkProfile Profile> struct Quirks;
+
+        class Recompiler;
+        class Translation;
+
+        struct DirtyRegion {
+                bool  isDirty;     // Something was drawn or cleared since the last update
+                uint8 firstRow;
+                uint8 lastRow;     // Inclusive, rows of the current screen mode
+        };
 
         class Interface {
             public:
                 virtual ~Interface() {};
 
                 // General
-                virtual void Update(void) = 0;
+                virtual void Update(const DirtyRegion& dirtyRegion) = 0;
+
+                // Pacing (an interface that follows the display waits for its refresh, false leaves the wait to the scheduler)
+                virtual bool WaitForFrame(uint64 frameDeadline) {
+                    return false;
+                }
+        };
+
+        class Audio {
+            public:
+                virtual ~Audio() {};
+
+                // General
+                virtual void SetBeeper(bool isBeeping) = 0;    // Only called when the state changes, on the emulation thread
         };
 
         // Constants
-        static constexpr charconst Tag                 = "Chip8";
-        static constexpr uint16    FontStartAddress    = 0x000;
-        static constexpr uint16    ProgramStartAddress = 0x200;    // 512
+        static constexpr charconst Tag                   = "Chip8";
+        static constexpr uint16    FontStartAddress      = 0x000;
+        static constexpr uint16    LargeFontStartAddress = 0x050;       // SUPER-CHIP 8x10 digits, right after the small font
+        static constexpr uint16    ProgramStartAddress   = 0x200;       // 512
+        static constexpr uint      FrameRate             = 60;          // Timers and interface updates
+        static constexpr uint      DefaultCpuRate        = 500;         // Instructions per second
+        static constexpr uint32    DefaultRandomSeed     = 0x2545F491;
+        static constexpr uint      ScreenWidth           = 64;
+        static constexpr uint      ScreenHeight          = 32;
+        static constexpr uint      ExtendedScreenWidth   = 128;         // SUPER-CHIP extended screen mode
+        static constexpr uint      ExtendedScreenHeight  = 64;
+        static constexpr uint      MegaScreenWidth       = 256;         // MEGA-CHIP mode
+        static constexpr uint      MegaScreenHeight      = 192;
+        static constexpr uint32    AddressMask           = 0xFFFFFF;    // I is 24 bits wide (MEGA-CHIP), code stays in the first 4 KB
+        static constexpr uint32    MaximumMemorySize     = 0x1000000;
+        static constexpr uint      PageSize              = 256;         // Memory is mapped, and copied on write, in pages
+        static constexpr uint      PageBits              = 8;
+        static constexpr uint      NumberOfKeys          = 16;
 
         // Utilities
-        static bool LoadProgram(const string filePath, RAM& programMemory);
+        static bool         LoadProgram(const string filePath, RAM& programMemory);
+        static bool         LoadProgram(const string filePath, uint8* programMemory, uint32 memorySize);
+        static void         LoadFonts(uint8* programMemory);
+        static uint32       GetMemorySize(const string filePath);    // The power of two a program needs, at least 4 KB
+        static uint32       GetMemorySize(uint64 programSize);
+        static QuirkProfile DetectQuirkProfile(const string filePath, const uint8* programMemory);
+        static void         Decode(uint16 opCode, Instruction& instruction);
+        static void Disassemble(uint16 opCode, char* textBuffer, uint bufferSize);
 
         // CPU
-        void Run(void);
-        void Stop(void);
-        void Reset(void);
+        void       Run(void);
+        uint64     RunCycles(uint64 numberOfCycles);
+        uint64     RunFrames(uint64 numberOfFrames);
+        void       Stop(void);
+        void       Reset(void);
+        void       SetCpuRate(uint instructionsPerSecond);
+        void       SetInstructionsPerFrame(uint instructionsPerFrame);
+        uint       GetInstructionsPerFrame(void) const;
+        StopReason GetStopReason(void) const;
+        uint64     GetMissedDeadlines(void) const;    // Frames Run started late, may be read while it runs
+        void       SetRandomSeed(uint32 newSeed);
+
+        // Registers (V0-VF stay where they are for as long as the machine lives)
+        const uint8* GetRegisters(void) const;
+        uint32       GetAddressRegister(void) const;
+        uint16       GetProgramCounter(void) const;
+        uint8        GetDelayTimer(void) const;
+        uint8        GetSoundTimer(void) const;
+
+        // Idle Loops (a short loop waiting on the delay timer is skipped to the next tick, the frame ends as if it ran)
+        struct IdleStatistics {
+                uint64 skippedLoops;           // Times the passes left in a frame were skipped
+                uint64 skippedInstructions;    // Retired without being run
+        };
+
+        void                  SetIdleSkipping(bool isEnabled);    // On by default, the interpreter always steps
+        const IdleStatistics& GetIdleStatistics(void) const;
+
+        // Memory (the low resolution screen only uses the first 32 words, laid out as before the extended screen existed)
+        struct MemoryFootprint {
+                uint   sharedPages;      // Still read from a shared image
+                uint   privatePages;     // Copied on write, or every page of private memory
+                uint64 instanceBytes;    // The machine, its page table, private pages, decoded code and MEGA-CHIP screens
+        };
+
+        void            SetRAM(RAM* mainMemory);
+        bool            SetMemory(uint8* mainMemory, uint32 memorySize);                  // A power of two from 4 KB to MaximumMemorySize
+        bool            SetSharedMemory(const uint8* sharedMemory, uint32 memorySize);    // Never written, pages are copied instead
+        uint32          GetMemorySize(void) const;
+        MemoryFootprint GetMemoryFootprint(void) const;
+        const VRAM&     GetVRAM(void) const;
+        bool            IsExtendedScreen(void) const;
+        uint            GetScreenWidth(void) const;
+        uint            GetScreenHeight(void) const;
+
+        // MEGA-CHIP (the interface shows the frame completed by the last 00E0 and resolves the palette itself)
+        bool           IsMegaChip(void) const;
+        const uint8*   GetIndexedVRAM(void) const;
+        const Palette& GetPalette(void) const;
+        uint8          GetScreenAlpha(void) const;
+
+        // State (host byte order, no allocations; only machines with 4 KB of memory outside MEGA-CHIP mode)
+        static constexpr uint32 StateMagic   = 0x54533843;    // "C8ST"
+        static constexpr uint16 StateVersion = 3;
+        static constexpr uint   StateSize    = 90 + sizeof(VRAM) + sizeof(RAM);
+
+        uint SaveState(uint8* stateBuffer, uint bufferSize) const;
+        bool LoadState(const uint8* stateBuffer, uint stateSize);
+
+        // Engine
+        bool   SetEngine(Engine newEngine);
+        Engine GetEngine(void) const;
+
+        // Translation (programs translated by Tools/RomTranslator and linked in, see Translation.hxx)
+        struct TranslationStatistics {
+                uint64 nativeInstructions;         // Retired by translated code
+                uint64 interpretedInstructions;    // Left to the predecoded cache
+        };
+
+        charconst             GetTranslatedProgram(void) const;    // NULL unless the Translated engine runs a translation
+        TranslationStatistics GetTranslationStatistics(void) const;
 
-        // Memory
-        void SetRAM(RAM* mainMemory);
-        void SetVRAM(VRAM* videoMemory);
+        // Quirks (chosen per program, every profile runs its own specialized handlers)
+        void         SetQuirkProfile(QuirkProfile newProfile);
+        QuirkProfile GetQuirkProfile(void) const;
 
         // Interface
         void SetInterface(Interface* newInterface);
 
+        // Keypad (keys may be set from any thread, a press wakes a CPU waiting in FX0A)
+        void                      SetKey(uint8 keyIndex, bool isPressed);
+        void                      SetKeyStates(uint16 keyMask);    // Every key at once, the ones going down are presses
+        uint16                    GetKeyStates(void) const;
+        const IntervalStatistics& GetKeyLatency(void) const;    // From a press to FX0A storing it in VX
+
+        // Audio
+        void SetAudio(Audio* newAudio);
+
+        // Rewind
+        void SetRewind(Rewind* newRewind);
+
+        // Tracing
+        void SetTracer(Tracer* newTracer);
+
+#ifdef CHIP8_PROFILE
+        // Profiling
+        Profiler&       GetProfiler(void);
+        const Profiler& GetProfiler(void) const;
+#endif
+
     private:
         // CPU
-        uint16  addressRegister;
-        uint8   cpuRegisters[16];
-        bool    cpuWait;
-        timeval lastCpuTick;
+        uint32 addressRegister;
+        uint8  cpuRegisters[16];
+        uint8  flagRegisters[16];    // SUPER-CHIP RPL user flags, kept across resets
+
+        // Memory (a page table over the caller's memory; pages of shared memory are copied the first time they are written)
+        uint8**             memoryPages;
+        uint                numberOfPages;
+        uint32              memoryMask;
+        const uint8*        sharedMemory;
+        std::vector<uint8*> copiedPages;
+        VRAM                videoMemory;
+        DirtyRegion         dirtyRegion;
+        bool                isExtendedScreen;
+
+        inline uint8 ReadMemory(uint32 address) const {
+            return this->memoryPages[(address & this->memoryMask) >> Chip8::PageBits][address & (Chip8::PageSize - 1)];
+        }
+
+        inline uint8* GetWritablePage(uint32 address) {
+            uint8* memoryPage = this->memoryPages[(address & this->memoryMask) >> Chip8::PageBits];
+
+            if (this->sharedMemory && (memoryPage == (this->sharedMemory + (address & this->memoryMask & ~(Chip8::PageSize - 1))))) {
+                memoryPage = this->CopyPage(address);
+            }
+
+            return memoryPage;
+        }
 
-        // Memory
-        RAM*  mainMemory;
-        VRAM* videoMemory;
+        inline void WriteMemory(uint32 address, uint8 value) {
+            uint8* memoryPage = this->GetWritablePage(address);
+
+            if (memoryPage) {
+                memoryPage[address & (Chip8::PageSize - 1)] = value;
+            }
+        }
+
+        bool   MapMemory(const uint8* memoryData, uint32 memorySize, bool isShared);
+        uint8* CopyPage(uint32 address);
+        void   ReadMemoryBlock(uint32 address, uint8* blockData, uint blockSize) const;
+        void   ReleasePages(void);
+        void   MarkDirty(uint firstRow, uint lastRow);
+        void   SetExtendedScreen(bool isExtended);
+
+        // MEGA-CHIP (allocated the first time the mode is enabled)
+        struct MegaChipState {
+                IndexedVRAM screenMemory[2];    // Swapped at every 00E0, the other one is being drawn
+                uint        drawnScreen;
+                Palette     palette;
+                uint        spriteWidth;
+                uint        spriteHeight;
+                uint8       screenAlpha;
+                uint8       blendMode;          // Kept for the program, sprites are always drawn opaque
+                uint32      soundAddress;
+                bool        isSoundPlaying;
+                bool        isSoundLooping;
+        };
+
+        bool           isMegaChip;
+        MegaChipState* megaChip;
+
+        bool SetMegaChip(bool isEnabled);
+        void BlitSprite(const Instruction& instruction);
 
         // Execution
-        bool   isRunning;
-        uint16 programCounter;
-        uint8  stackPointer;
-        uint16 callStack[16];
-        uint16 opCode;
+        bool       isRunning;
+        StopReason stopReason;
+        uint       frameCycles;
+        uint       instructionsPerFrame;
+        Scheduler  frameScheduler;
+        uint16     programCounter;
+        uint8      stackPointer;
+        uint16     callStack[16];
+        uint16     opCode;
+        uint32     randomSeed;
+        uint32     randomState;
+
+        uint16 FetchOpCode(void) const;
+        uint64 Execute(uint64 numberOfCycles);
+        uint64 ExecuteInterpreted(uint64 numberOfCycles);
+        uint64 ExecutePredecoded(uint64 numberOfCycles);
+
+        template <QuirkProfile Profile> uint64 ExecuteInterpreted(uint64 numberOfCycles);
+        template <QuirkProfile Profile> uint64 ExecutePredecoded(uint64 numberOfCycles);
+        uint8  NextRandom(void);
+        void   Halt(const string haltMessage, ...);
+
+        // Idle Loops (only instructions that touch nothing but V0-VF and I, and read memory and the delay timer)
+        static constexpr uint MaximumIdleLoopLength = 16;    // Instructions, the jump back included
 
-        void DebugOpCode(const string debugMessage, ...);
-        void Halt(const string haltMessage, ...);
+        struct IdleLoop {
+                bool   isWatched;           // The jump was taken once, the next time it is compared
+                uint16 jumpAddress;
+                uint16 loopAddress;
+                uint8  cpuRegisters[16];    // When the jump was last taken
+                uint32 addressRegister;
+                uint8  delayTimer;
+        };
+
+        bool           isIdleSkipping;
+        bool           isIdle;    // A loop came back unchanged and stopped the batch at its jump, the CPU loop skips it
+        IdleLoop       idleLoop;
+        IdleStatistics idleStatistics;
+
+        bool   IsIdleLoop(uint16 jumpAddress, uint16 loopAddress) const;
+        uint64 SkipIdleLoop(uint64 numberOfCycles);
 
         // Timers
-        uint8   delayTimer;
-        uint8   soundTimer;
-        timeval lastTick;
+        uint8 delayTimer;
+        uint8 soundTimer;
+        bool  isBeeping;    // What the audio sink was last told
 
         void Tick(void);
+        void UpdateBeeper(void);
+
+        // Decoding
+        Engine       currentEngine;
+        QuirkProfile quirkProfile;
+        Instruction* decodedMemory;
+        Recompiler*  recompiler;
+        Translation* translation;
+
+        void InvalidateCode(uint32 address, uint length);
+        void InvalidateAllCode(void);
+
+        template <QuirkProfile Profile> void Dispatch(const Instruction& instruction);
+        template <QuirkProfile Profile> void DispatchOperation(const Instruction& instruction);
+        template <QuirkProfile Profile> void DispatchTraced(const Instruction& instruction);
 
         // Operations
-        Operation operationsTable[16];
-
-        void Op0x0(void);
-        void Op0x1(void);
-        void Op0x2(void);
-        void Op0x3(void);
-        void Op0x4(void);
-        void Op0x5(void);
-        void Op0x6(void);
-        void Op0x7(void);
-        void Op0x8(void);
-        void Op0x9(void);
-        void Op0xA(void);
-        void Op0xB(void);
-        void Op0xC(void);
-        void Op0xD(void);
-        void Op0xE(void);
-        void Op0xF(void);
+        template <QuirkProfile Profile> void OpDecode(const Instruction& instruction);
+        void OpUnknown(const Instruction& instruction);
+        void Op00E0(const Instruction& instruction);
+        void Op00EE(const Instruction& instruction);
+        void Op00BN(const Instruction& instruction);
+        void Op00CN(const Instruction& instruction);
+        void Op00FB(const Instruction& instruction);
+        void Op00FC(const Instruction& instruction);
+        void Op00FD(const Instruction& instruction);
+        void Op00FE(const Instruction& instruction);
+        void Op00FF(const Instruction& instruction);
+        void Op0010(const Instruction& instruction);
+        void Op0011(const Instruction& instruction);
+        void Op01NN(const Instruction& instruction);
+        void Op02NN(const Instruction& instruction);
+        void Op03NN(const Instruction& instruction);
+        void Op04NN(const Instruction& instruction);
+        void Op05NN(const Instruction& instruction);
+        void Op060N(const Instruction& instruction);
+        void Op0700(const Instruction& instruction);
+        void Op080N(const Instruction& instruction);
+        void Op1NNN(const Instruction& instruction);
+        void Op2NNN(const Instruction& instruction);
+        void Op3XNN(const Instruction& instruction);
+        void Op4XNN(const Instruction& instruction);
+        void Op5XY0(const Instruction& instruction);
+        void Op6XNN(const Instruction& instruction);
+        void Op7XNN(const Instruction& instruction);
+        void Op8XY0(const Instruction& instruction);
+        template <QuirkProfile Profile> void Op8XY1(const Instruction& instruction);
+        template <QuirkProfile Profile> void Op8XY2(const Instruction& instruction);
+        template <QuirkProfile Profile> void Op8XY3(const Instruction& instruction);
+        void Op8XY4(const Instruction& instruction);
+        void Op8XY5(const Instruction& instruction);
+        template <QuirkProfile Profile> void Op8XY6(const Instruction& instruction);
+        void Op8XY7(const Instruction& instruction);
+        template <QuirkProfile Profile> void Op8XYE(const Instruction& instruction);
+        void Op9XY0(const Instruction& instruction);
+        void OpANNN(const Instruction& instruction);
+        template <QuirkProfile Profile> void OpBNNN(const Instruction& instruction);
+        void OpCXNN(const Instruction& instruction);
+        template <QuirkProfile Profile> void OpDXYN(const Instruction& instruction);
+        template <QuirkProfile Profile, bool IsExtended> void DrawSprite(const Instruction& instruction);
+        void OpEX9E(const Instruction& instruction);
+        void OpEXA1(const Instruction& instruction);
+        void OpFX07(const Instruction& instruction);
+        void OpFX0A(const Instruction& instruction);
+        void OpFX15(const Instruction& instruction);
+        void OpFX18(const Instruction& instruction);
+        void OpFX1E(const Instruction& instruction);
+        void OpFX29(const Instruction& instruction);
+        void OpFX30(const Instruction& instruction);
+        void OpFX33(const Instruction& instruction);
+        template <QuirkProfile Profile> void OpFX55(const Instruction& instruction);
+        template <QuirkProfile Profile> void OpFX65(const Instruction& instruction);
+        void OpFX75(const Instruction& instruction);
+        void OpFX85(const Instruction& instruction);
+        void OpIdleJump(const Instruction& instruction);
 
         // Interface
         Interface* currentInterface;
+
+        // Keypad (one bit per key, presses are also latched until FX0A takes them)
+        std::atomic<uint16>     keyStates;
+        std::atomic<uint16>     pressedKeys;
+        std::atomic<uint64>     pressTime;          // When the last press was published
+        std::mutex              keyLock;            // Only taken to publish a press and to park
+        std::condition_variable keyCondition;
+        bool                    isWaitingForKey;    // FX0A stopped the batch, the CPU loop parks
+        IntervalStatistics      keyLatency;
+
+        bool WaitForKey(uint64 wakeTime);
+
+        // Audio
+        Audio* currentAudio;
+
+        // Rewind
+        Rewind* currentRewind;
+
+        // Tracing
+        Tracer* currentTracer;
+
+#ifdef CHIP8_PROFILE
+        // Profiling
+        Profiler profiler;
+#endif
+};
+
+// Quirk Profiles
+
+template <> struct Chip8::Quirks<Chip8::QuirksVIP> {
+        static constexpr bool  ShiftUsesVY     = true;                       // 8XY6/8XYE shift VY into VX
+        static constexpr bool  LogicResetsVF   = true;                       // 8XY1/8XY2/8XY3 clear VF
+        static constexpr uint8 MemoryIncrement = Chip8::IncrementXPlusOne;    // What FX55/FX65 leave in I
+        static constexpr bool  JumpUsesVX      = false;                      // BXNN jumps to XNN + VX instead of NNN + V0
+        static constexpr bool  SpritesClip     = true;                       // Sprites stop at the screen edges instead of wrapping
+        static constexpr bool  LargeSprites    = false;                      // DXY0 draws 16x16 in the low resolution screen too
+};
+
+template <> struct Chip8::Quirks<Chip8::QuirksCHIP48> {
+        static constexpr bool  ShiftUsesVY     = false;
+        static constexpr bool  LogicResetsVF   = false;
+        static constexpr uint8 MemoryIncrement = Chip8::IncrementX;
+        static constexpr bool  JumpUsesVX      = true;
+        static constexpr bool  SpritesClip     = true;
+        static constexpr bool  LargeSprites    = false;
+};
+
+template <> struct Chip8::Quirks<Chip8::QuirksSCHIP> {
+        static constexpr bool  ShiftUsesVY     = false;
+        static constexpr bool  LogicResetsVF   = false;
+        static constexpr uint8 MemoryIncrement = Chip8::IncrementNone;
+        static constexpr bool  JumpUsesVX      = true;
+        static constexpr bool  SpritesClip     = true;
+        static constexpr bool  LargeSprites    = true;
 };
 
 #endif    // CHIP8_H
@@ -16,6 +16,7 @@
 
 // C
 
+#include <cerrno>
 #include <cinttypes>
 #include <cmath>
 #include <cstdarg>
@@ -35,6 +36,7 @@
 
 extern "C" {
 #include <sys/time.h>
+#include <time.h>
 #include <unistd.h>
 }
 
@@ -58,6 +60,8 @@ typedef unsigned short ushort;
 
 #define UINT8(value)  static_cast<uint8>(value)
 #define UINT16(value) static_cast<uint16>(value)
+#define UINT32(value) static_cast<uint32>(value)
+#define UINT64(value) static_cast<uint64>(value)
 
 // Integer Union Types
 
@@ -0,0 +1,155 @@
+/*
+ * Fleet.cxx
+ *
+ * This file is part of the Chip8++ source code.
+ * Copyright 2023 Patrick Melo <patrick@patrickmelo.com.br>
+ */
+
+#include "Fleet.hxx"
+
+#include <thread>
+
+// Fleet
+
+Fleet::Fleet(uint numberOfWorkers, uint sliceFrames) :
+    numberOfWorkers(numberOfWorkers > 0 ? numberOfWorkers : 1),
+    sliceFrames(sliceFrames > 0 ? sliceFrames : 1),
+    workQueues(NULL),
+    pendingSessions(0),
+    stolenSlices(0) {
+    this->workQueues = new WorkQueue[this->numberOfWorkers];
+}
+
+Fleet::~Fleet() {
+    for (uint sessionIndex = 0; sessionIndex < this->sessions.size(); ++sessionIndex) {
+        this->sessions[sessionIndex]->nullInterface.Finalize();
+        delete this->sessions[sessionIndex];
+    }
+
+    delete[] this->workQueues;
+}
+
+// Sessions
+
+uint Fleet::AddSession(const Chip8::RAM& programMemory, uint64 numberOfFrames, uint32 randomSeed) {
+    Session* newSession = new Session();
+
+    newSession->remainingFrames     = numberOfFrames;
+    newSession->retiredInstructions = 0;
+
+    newSession->nullInterface.Initialize(&newSession->chip8);
+    newSession->chip8.SetSharedMemory(programMemory, sizeof(Chip8::RAM));
+    newSession->chip8.SetRandomSeed(randomSeed);
+    newSession->chip8.Reset();
+
+    this->sessions.push_back(newSession);
+    return this->sessions.size() - 1;
+}
+
+uint Fleet::GetSessionCount(void) const {
+    return this->sessions.size();
+}
+
+Fleet::Session* Fleet::GetSession(uint sessionIndex) const {
+    return sessionIndex < this->sessions.size() ? this->sessions[sessionIndex] : NULL;
+}
+
+// Execution
+
+void Fleet::Run(void) {
+    // Deal the sessions round-robin; idle workers steal from the others.
+
+    for (uint sessionIndex = 0; sessionIndex < this->sessions.size(); ++sessionIndex) {
+        if (this->sessions[sessionIndex]->remainingFrames == 0) {
+            continue;
+        }
+
+        this->workQueues[sessionIndex % this->numberOfWorkers].sessionIndexes.push_back(sessionIndex);
+        this->pendingSessions++;
+    }
+
+    std::vector<std::thread> workerThreads;
+
+    for (uint workerIndex = 1; workerIndex < this->numberOfWorkers; ++workerIndex) {
+        workerThreads.push_back(std::thread(&Fleet::Work, this, workerIndex));
+    }
+
+    this->Work(0);
+
+    for (uint threadIndex = 0; threadIndex < workerThreads.size(); ++threadIndex) {
+        workerThreads[threadIndex].join();
+    }
+}
+
+uint64 Fleet::GetRetiredInstructions(void) const {
+    uint64 retiredInstructions = 0;
+
+    for (uint sessionIndex = 0; sessionIndex < this->sessions.size(); ++sessionIndex) {
+        retiredInstructions += this->sessions[sessionIndex]->retiredInstructions;
+    }
+
+    return retiredInstructions;
+}
+
+uint64 Fleet::GetStolenSlices(void) const {
+    return this->stolenSlices;
+}
+
+void Fleet::Work(uint workerIndex) {
+    uint sessionIndex;
+
+    while (this->pendingSessions.load(std::memory_order_acquire) > 0) {
+        if (!this->PopSession(workerIndex, sessionIndex) && !this->StealSession(workerIndex, sessionIndex)) {
+            std::this_thread::yield();
+            continue;
+        }
+
+        Session* currentSession = this->sessions[sessionIndex];
+        uint64   sliceFrames    = currentSession->remainingFrames < this->sliceFrames ? currentSession->remainingFrames : this->sliceFrames;
+
+        currentSession->retiredInstructions += currentSession->chip8.RunFrames(sliceFrames);
+        currentSession->remainingFrames -= sliceFrames;
+
+        if ((currentSession->remainingFrames == 0) || (currentSession->chip8.GetStopReason() != Chip8::BudgetExhausted)) {
+            this->pendingSessions.fetch_sub(1, std::memory_order_release);
+            continue;
+        }
+
+        WorkQueue&                  ownQueue = this->workQueues[workerIndex];
+        std::lock_guard<std::mutex> queueGuard(ownQueue.queueLock);
+        ownQueue.sessionIndexes.push_back(sessionIndex);
+    }
+}
+
+bool Fleet::PopSession(uint workerIndex, uint& sessionIndex) {
+    WorkQueue&                  ownQueue = this->workQueues[workerIndex];
+    std::lock_guard<std::mutex> queueGuard(ownQueue.queueLock);
+
+    if (ownQueue.sessionIndexes.empty()) {
+        return false;
+    }
+
+    sessionIndex = ownQueue.sessionIndexes.front();
+    ownQueue.sessionIndexes.pop_front();
+    return true;
+}
+
+bool Fleet::StealSession(uint workerIndex, uint& sessionIndex) {
+    // Take from the back of the victim's queue: that is the session its owner would run last.
+
+    for (uint victimOffset = 1; victimOffset < this->numberOfWorkers; ++victimOffset) {
+        WorkQueue&                  victimQueue = this->workQueues[(workerIndex + victimOffset) % this->numberOfWorkers];
+        std::lock_guard<std::mutex> queueGuard(victimQueue.queueLock);
+
+        if (victimQueue.sessionIndexes.empty()) {
+            continue;
+        }
+
+        sessionIndex = victimQueue.sessionIndexes.back();
+        victimQueue.sessionIndexes.pop_back();
+        this->stolenSlices++;
+        return true;
+    }
+
+    return false;
+}
@@ -0,0 +1,71 @@
+/*
+ * Fleet.hxx
+ *
+ * This file is part of the Chip8++ source code.
+ * Copyright 2023 Patrick Melo <patrick@patrickmelo.com.br>
+ */
+
+#ifndef CHIP8_FLEET_H
+#define CHIP8_FLEET_H
+
+#include "Chip8.hxx"
+#include "NullInterface.hxx"
+
+#include <atomic>
+#include <deque>
+#include <mutex>
+
+// Fleet (many headless sessions scheduled across worker threads)
+
+class Fleet {
+    public:
+        Fleet(uint numberOfWorkers, uint sliceFrames = 1);
+        ~Fleet();
+
+        // Types
+        struct Session {
+                Chip8         chip8;
+                NullInterface nullInterface;
+                uint64        remainingFrames;
+                uint64        retiredInstructions;
+        };
+
+        // Constants
+        static constexpr charconst Tag = "Fleet";
+
+        // Sessions (the program memory is shared by every session started from it, and has to outlive them)
+        uint     AddSession(const Chip8::RAM& programMemory, uint64 numberOfFrames, uint32 randomSeed = Chip8::DefaultRandomSeed);
+        uint     GetSessionCount(void) const;
+        Session* GetSession(uint sessionIndex) const;
+
+        // Execution
+        void   Run(void);
+        uint64 GetRetiredInstructions(void) const;
+        uint64 GetStolenSlices(void) const;
+
+    private:
+        // Types
+        struct WorkQueue {
+                std::mutex       queueLock;
+                std::deque<uint> sessionIndexes;
+                uint8            cacheLinePadding[64];    // Keeps neighbouring queues off each other's cache lines
+        };
+
+        // Configuration
+        uint numberOfWorkers;
+        uint sliceFrames;
+
+        // Sessions
+        std::vector<Session*> sessions;
+
+        // Execution
+        WorkQueue*          workQueues;
+        std::atomic<uint>   pendingSessions;
+        std::atomic<uint64> stolenSlices;
+
+        void Work(uint workerIndex);
+        bool PopSession(uint workerIndex, uint& sessionIndex);
+        bool StealSession(uint workerIndex, uint& sessionIndex);
+};
+
+#endif    // CHIP8_FLEET_H
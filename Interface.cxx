@@ -7,6 +7,49 @@
 
 #include "Interface.hxx"
 
+// Constants
+
+static const SDL_Scancode KeyScancodes[Chip8::NumberOfKeys] = {
+    // The COSMAC VIP keypad on the left of a QWERTY keyboard (by position, the layout does not matter):
+    //   1 2 3 C    1 2 3 4
+    //   4 5 6 D    Q W E R
+    //   7 8 9 E    A S D F
+    //   A 0 B F    Z X C V
+
+    SDL_SCANCODE_X, SDL_SCANCODE_1, SDL_SCANCODE_2, SDL_SCANCODE_3,
+    SDL_SCANCODE_Q, SDL_SCANCODE_W, SDL_SCANCODE_E, SDL_SCANCODE_A,
+    SDL_SCANCODE_S, SDL_SCANCODE_D, SDL_SCANCODE_Z, SDL_SCANCODE_C,
+    SDL_SCANCODE_4, SDL_SCANCODE_R, SDL_SCANCODE_F, SDL_SCANCODE_V};
+
+static const SDL_Scancode ReportScancode = SDL_SCANCODE_F1;    // Logs the frame pacing while running
+
+// Statistics
+
+static void PrintHistogram(charconst histogramName, const IntervalHistogram& intervalHistogram) {
+    uint64 intervalCount = intervalHistogram.GetCount();
+
+    if (intervalCount == 0) {
+        return;
+    }
+
+    Info(Interface::Tag, "%s (%" PRIu64 " intervals):", histogramName, intervalCount);
+
+    for (uint bucketIndex = 0; bucketIndex < IntervalHistogram::NumberOfBuckets; ++bucketIndex) {
+        uint64 bucketCount = intervalHistogram.GetBucketCount(bucketIndex);
+        double bucketStart = (bucketIndex * IntervalHistogram::BucketWidth) / 1e6;
+
+        if (bucketCount == 0) {
+            continue;
+        }
+
+        if (bucketIndex == (IntervalHistogram::NumberOfBuckets - 1)) {
+            printf("    %6.2f ms and longer %10" PRIu64 " %6.2f%%\n", bucketStart, bucketCount, (bucketCount * 100.0) / intervalCount);
+        } else {
+            printf("    %6.2f - %6.2f ms    %10" PRIu64 " %6.2f%%\n", bucketStart, bucketStart + (IntervalHistogram::BucketWidth / 1e6), bucketCount, (bucketCount * 100.0) / intervalCount);
+        }
+    }
+}
+
 // Interface
 
 Interface::Interface(void) :
@@ -15,12 +58,27 @@ Interface::Interface(void) :
     chip8(NULL),
     sdlWindow(NULL),
     sdlWindowSurface(NULL),
-    screenSurface(NULL) {
-    // Empty
+    sdlRenderer(NULL),
+    sdlTexture(NULL),
+    screenSurface(NULL),
+    isRendering(false),
+    isExposed(true),
+    isQuitPending(false),
+    presentationMode(Interface::SurfacePresentation),
+    isPresentPending(false),
+    pendingPublishTime(0),
+    presentedFrames(0),
+    skippedFrames(0) {
+    memset(&this->presentedFrame, 0, sizeof(this->presentedFrame));
+    memset(&this->screenRect, 0, sizeof(this->screenRect));
 }
 
 // General
 
+void Interface::SetPresentationMode(PresentationMode newMode) {
+    this->presentationMode = newMode;
+}
+
 bool Interface::Initialize(Chip8* chip8) {
     if (this->isInitialized) {
         return false;
@@ -39,21 +97,59 @@ bool Interface::Initialize(Chip8* chip8) {
         return false;
     }
 
-    this->sdlWindowSurface = SDL_GetWindowSurface(this->sdlWindow);
-    this->screenSurface    = SDL_CreateRGBSurface(0, 64, 32, 24, 0x000000FF, 0x0000FF00, 0x00FF0000, 0xFF000000);
+    // A window with a renderer has no surface to blit to, so the surface is only taken without one.
+
+    if ((this->presentationMode == Interface::VsyncPresentation) && !this->CreateRenderer()) {
+        Warning(Interface::Tag, "No renderer that waits for the display (%s), frames are blitted to the window.", SDL_GetError());
+    }
+
+    this->sdlWindowSurface = this->sdlRenderer ? NULL : SDL_GetWindowSurface(this->sdlWindow);
+    this->screenSurface    = SDL_CreateRGBSurface(0, Chip8::MegaScreenWidth, Chip8::MegaScreenHeight, 24, 0x000000FF, 0x0000FF00, 0x00FF0000, 0xFF000000);
 
-    if (!this->sdlWindowSurface || !this->screenSurface) {
+    if ((!this->sdlWindowSurface && !this->sdlRenderer) || !this->screenSurface) {
         Error(Interface::Tag, "%s", SDL_GetError());
         SDL_FreeSurface(this->screenSurface);
+        SDL_DestroyTexture(this->sdlTexture);
+        SDL_DestroyRenderer(this->sdlRenderer);
         SDL_DestroyWindow(this->sdlWindow);
+        this->sdlTexture  = NULL;
+        this->sdlRenderer = NULL;
         return false;
     }
 
-    memset(this->screenSurface->pixels, 0, 6144);
+    // Frames follow the display when it refreshes at a multiple of the frame rate, the scheduler paces them otherwise.
+
+    SDL_DisplayMode displayMode;
+    int             refreshRate = (this->sdlRenderer && (SDL_GetCurrentDisplayMode(SDL_GetWindowDisplayIndex(this->sdlWindow), &displayMode) == 0)) ? displayMode.refresh_rate : 0;
+
+    if (this->displayClock.Start(refreshRate > 0 ? refreshRate : 0, Chip8::FrameRate)) {
+        Info(Interface::Tag, "Presenting on every refresh at %d Hz, frames start on them.", refreshRate);
+    } else if (this->sdlRenderer) {
+        Warning(Interface::Tag, "The display refreshes at %d Hz, frames are presented on its refreshes but paced by the scheduler.", refreshRate);
+    }
+
+    memset(this->screenSurface->pixels, 0, this->screenSurface->pitch * this->screenSurface->h);
+    memset(&this->presentedFrame, 0, sizeof(this->presentedFrame));
+
+    this->screenRect.w = Chip8::ScreenWidth;
+    this->screenRect.h = Chip8::ScreenHeight;
 
-    this->chip8->SetVRAM(reinterpret_cast<Chip8::VRAM*>(this->screenSurface->pixels));
     this->chip8->SetInterface(this);
 
+    this->isRendering        = true;
+    this->isExposed          = true;
+    this->isQuitPending      = false;
+    this->isPresentPending   = false;
+    this->pendingPublishTime = 0;
+    this->presentedFrames    = 0;
+    this->skippedFrames      = 0;
+    this->updateIntervals.Reset();
+    this->presentIntervals.Reset();
+    this->presentLatency.Reset();
+    this->updateHistogram.Reset();
+    this->presentHistogram.Reset();
+    this->latencyHistogram.Reset();
+
     Info(Interface::Tag, "Initialized.");
     return this->isInitialized = true;
 }
@@ -63,32 +159,409 @@ void Interface::Finalize(void) {
         return;
     }
 
+    this->chip8->SetInterface(NULL);
+
     SDL_FreeSurface(this->screenSurface);
+
+    if (this->sdlRenderer) {
+        SDL_DestroyTexture(this->sdlTexture);
+        SDL_DestroyRenderer(this->sdlRenderer);
+    }
+
     SDL_DestroyWindow(this->sdlWindow);
     SDL_Quit();
 
+    this->sdlTexture    = NULL;
+    this->sdlRenderer   = NULL;
     this->isInitialized = false;
+
+    Info(Interface::Tag, "%" PRIu64 " frames presented, %" PRIu64 " skipped.", this->presentedFrames, this->skippedFrames);
+    Info(Interface::Tag, "Emulation frame interval %.3f ms (jitter %.3f ms, worst %.3f ms).", this->updateIntervals.GetMean() / 1e6, this->updateIntervals.GetDeviation() / 1e6, this->updateIntervals.GetMaximum() / 1e6);
+    Info(Interface::Tag, "Present interval %.3f ms (jitter %.3f ms, worst %.3f ms).", this->presentIntervals.GetMean() / 1e6, this->presentIntervals.GetDeviation() / 1e6, this->presentIntervals.GetMaximum() / 1e6);
+    Info(Interface::Tag, "Present latency %.3f ms (jitter %.3f ms, worst %.3f ms).", this->presentLatency.GetMean() / 1e6, this->presentLatency.GetDeviation() / 1e6, this->presentLatency.GetMaximum() / 1e6);
+
+    this->ReportPacing();
+
+    PrintHistogram("Emulation frame intervals", this->updateHistogram);
+    PrintHistogram("Present intervals", this->presentHistogram);
+    PrintHistogram("Present latencies", this->latencyHistogram);
+
+    const IntervalStatistics& keyLatency = this->chip8->GetKeyLatency();
+
+    if (keyLatency.GetCount() > 0) {
+        Info(Interface::Tag, "%" PRIu64 " waited keys, latency %.3f ms (jitter %.3f ms, worst %.3f ms).", keyLatency.GetCount(), keyLatency.GetMean() / 1e6, keyLatency.GetDeviation() / 1e6, keyLatency.GetMaximum() / 1e6);
+    }
     printf("Interface finalized.\n");
 }
 
-// Chip8
+// Chip8 (emulation thread: never blocks on SDL)
+
+void Interface::Update(const Chip8::DirtyRegion& dirtyRegion) {
+    uint64 updateTime = Scheduler::Now();
+
+    this->updateIntervals.Record(updateTime);
+    this->updateHistogram.Record(updateTime);
+
+    // Hand the finished frame to the renderer, clean frames need no copy.
+
+    if (dirtyRegion.isDirty) {
+        Frame& backFrame = this->frameBuffer.GetBackBuffer();
+
+        backFrame.isExtendedScreen = this->chip8->IsExtendedScreen();
+        backFrame.isMegaChip       = this->chip8->IsMegaChip();
+
+        if (backFrame.isMegaChip) {
+            memcpy(backFrame.indexedMemory, this->chip8->GetIndexedVRAM(), sizeof(Chip8::IndexedVRAM));
+            memcpy(backFrame.palette, this->chip8->GetPalette(), sizeof(Chip8::Palette));
+            backFrame.screenAlpha = this->chip8->GetScreenAlpha();
+        } else {
+            memcpy(backFrame.videoMemory, this->chip8->GetVRAM(), sizeof(Chip8::VRAM));
+        }
+
+        backFrame.publishTime = updateTime;
+        this->frameBuffer.Publish();
+    } else {
+        this->skippedFrames++;
+    }
+
+    // Apply the events the renderer collected.
 
-void Interface::Update(void) {
-    // Update the events
+    Event nextEvent;
 
+    while (this->eventQueue.Pop(nextEvent)) {
+        switch (nextEvent.eventType) {
+            case Interface::QuitEvent: {
+                this->chip8->Stop();
+                break;
+            }
+        }
+    }
+}
+
+bool Interface::WaitForFrame(uint64 frameDeadline) {
+    return this->displayClock.WaitForFrame(frameDeadline);
+}
+
+// Rendering (window thread)
+
+void Interface::Render(void) {
+    if (this->sdlRenderer) {
+        this->RenderSynchronized();
+        return;
+    }
+
+    while (this->isRendering.load(std::memory_order_acquire)) {
+        if (this->frameBuffer.Acquire()) {
+            this->PollEvents(0);
+            this->Present(this->frameBuffer.GetFrontBuffer());
+        } else {
+            this->PollEvents(Interface::IdleWait);
+        }
+    }
+}
+
+void Interface::RenderSynchronized(void) {
+    // Present on every refresh, with or without a new frame, so the emulation thread keeps getting them. It starts a
+    // frame on a refresh and has half a refresh to hand it over before the next present.
+
+    uint64 blankTime = Scheduler::Now();
+
+    while (this->isRendering.load(std::memory_order_acquire)) {
+        uint64 handoverTime = blankTime + (this->displayClock.GetRefreshPeriod() / 2);
+        bool   isNewFrame   = this->frameBuffer.Acquire();
+
+        while (!isNewFrame && (Scheduler::Now() < handoverTime)) {
+            this->PollEvents(Interface::IdleWait);
+            isNewFrame = this->frameBuffer.Acquire();
+        }
+
+        this->PollEvents(0);
+
+        if (isNewFrame) {
+            this->Present(this->frameBuffer.GetFrontBuffer());
+        }
+
+        SDL_RenderClear(this->sdlRenderer);
+        SDL_RenderCopy(this->sdlRenderer, this->sdlTexture, &this->screenRect, NULL);
+        SDL_RenderPresent(this->sdlRenderer);
+
+        blankTime = Scheduler::Now();
+        this->displayClock.Signal(blankTime);
+
+        if (this->isPresentPending) {
+            this->CompletePresent(blankTime, this->pendingPublishTime);
+            this->isPresentPending = false;
+        }
+    }
+}
+
+bool Interface::CreateRenderer(void) {
+    // SDL may hand out a renderer without vsync when asked for one, that one would present as fast as it is called.
+
+    SDL_RendererInfo rendererInfo;
+
+    this->sdlRenderer = SDL_CreateRenderer(this->sdlWindow, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC);
+
+    if (this->sdlRenderer && (SDL_GetRendererInfo(this->sdlRenderer, &rendererInfo) == 0) && (rendererInfo.flags & SDL_RENDERER_PRESENTVSYNC)) {
+        this->sdlTexture = SDL_CreateTexture(this->sdlRenderer, SDL_PIXELFORMAT_RGB24, SDL_TEXTUREACCESS_STREAMING, Chip8::MegaScreenWidth, Chip8::MegaScreenHeight);
+
+        if (this->sdlTexture) {
+            return true;
+        }
+    }
+
+    if (this->sdlRenderer) {
+        SDL_DestroyRenderer(this->sdlRenderer);
+        this->sdlRenderer = NULL;
+    }
+
+    return false;
+}
+
+void Interface::StopRendering(void) {
+    this->isRendering.store(false, std::memory_order_release);
+}
+
+void Interface::PollEvents(uint waitTime) {
     SDL_Event sdlEvent;
+    bool      hasEvent = waitTime > 0 ? SDL_WaitEventTimeout(&sdlEvent, waitTime) : SDL_PollEvent(&sdlEvent);
 
-    while (SDL_PollEvent(&sdlEvent)) {
+    while (hasEvent) {
         switch (sdlEvent.type) {
             case SDL_QUIT: {
-                this->chip8->Stop();
+                this->isQuitPending = true;
                 break;
             }
+
+            case SDL_WINDOWEVENT: {
+                if (sdlEvent.window.event == SDL_WINDOWEVENT_EXPOSED) {
+                    this->isExposed = true;
+                }
+
+                break;
+            }
+
+            // Keys go straight to the machine: the emulation thread may be parked in FX0A, and a press wakes it.
+
+            case SDL_KEYDOWN:
+            case SDL_KEYUP: {
+                if (sdlEvent.key.repeat) {
+                    break;
+                }
+
+                if ((sdlEvent.type == SDL_KEYDOWN) && (sdlEvent.key.keysym.scancode == ReportScancode)) {
+                    this->ReportPacing();
+                    break;
+                }
+
+                for (uint keyIndex = 0; keyIndex < Chip8::NumberOfKeys; ++keyIndex) {
+                    if (sdlEvent.key.keysym.scancode == KeyScancodes[keyIndex]) {
+                        this->chip8->SetKey(keyIndex, sdlEvent.type == SDL_KEYDOWN);
+                        break;
+                    }
+                }
+
+                break;
+            }
+        }
+
+        hasEvent = SDL_PollEvent(&sdlEvent);
+    }
+
+    // A full queue only delays the quit until the next poll.
+
+    if (this->isQuitPending) {
+        Event quitEvent = {Interface::QuitEvent, 0};
+        this->isQuitPending = !this->eventQueue.Push(quitEvent);
+    }
+
+    if (this->isExposed) {
+        this->Present(this->presentedFrame);
+    }
+}
+
+void Interface::Present(const Frame& newFrame) {
+    // Find the rows that differ from what the window shows (frames skipped by the triple buffer included), a mode
+    // switch redraws everything.
+
+    if (newFrame.isMegaChip) {
+        this->PresentIndexed(newFrame);
+        return;
+    }
+
+    uint screenWidth  = newFrame.isExtendedScreen ? Chip8::ExtendedScreenWidth : Chip8::ScreenWidth;
+    uint screenHeight = newFrame.isExtendedScreen ? Chip8::ExtendedScreenHeight : Chip8::ScreenHeight;
+    uint rowWords     = screenWidth / 64;
+    bool isRedrawn    = this->isExposed || this->presentedFrame.isMegaChip || (newFrame.isExtendedScreen != this->presentedFrame.isExtendedScreen);
+    uint firstRow     = screenHeight;
+    uint lastRow      = 0;
+
+    for (uint yPosition = 0; yPosition < screenHeight; ++yPosition) {
+        if (isRedrawn || (memcmp(&newFrame.videoMemory[yPosition * rowWords], &this->presentedFrame.videoMemory[yPosition * rowWords], rowWords * sizeof(uint64)) != 0)) {
+            firstRow = firstRow < yPosition ? firstRow : yPosition;
+            lastRow  = yPosition;
+        }
+    }
+
+    if (firstRow > lastRow) {
+        return;
+    }
+
+    // Expand the dirty rows to RGB (the machine only keeps one bit per pixel).
+
+    for (uint yPosition = firstRow; yPosition <= lastRow; ++yPosition) {
+        uint8*        surfaceLine = reinterpret_cast<uint8*>(this->screenSurface->pixels) + (yPosition * this->screenSurface->pitch);
+        const uint64* lineWords   = &newFrame.videoMemory[yPosition * rowWords];
+
+        for (uint xPosition = 0; xPosition < screenWidth; ++xPosition) {
+            memset(&surfaceLine[xPosition * 3], ((lineWords[xPosition / 64] >> (63 - (xPosition % 64))) & 0x1) * 0xFF, 3);
+        }
+
+        memcpy(&this->presentedFrame.videoMemory[yPosition * rowWords], lineWords, rowWords * sizeof(uint64));
+    }
+
+    this->presentedFrame.isExtendedScreen = newFrame.isExtendedScreen;
+    this->presentedFrame.isMegaChip       = false;
+
+    // Only scale and present the rows that changed.
+
+    SDL_Rect sourceRect = {0, static_cast<int>(firstRow), static_cast<int>(screenWidth), static_cast<int>(lastRow - firstRow + 1)};
+    this->Show(newFrame, sourceRect, screenHeight);
+}
+
+void Interface::PresentIndexed(const Frame& newFrame) {
+    // The palette is resolved once per frame (alpha scales the colors, the window has no background to blend with), a
+    // palette or alpha change redraws everything like a mode switch.
+
+    bool isRedrawn = this->isExposed || !this->presentedFrame.isMegaChip || (newFrame.screenAlpha != this->presentedFrame.screenAlpha) || (memcmp(newFrame.palette, this->presentedFrame.palette, sizeof(Chip8::Palette)) != 0);
+    uint firstRow  = Chip8::MegaScreenHeight;
+    uint lastRow   = 0;
+
+    for (uint yPosition = 0; yPosition < Chip8::MegaScreenHeight; ++yPosition) {
+        uint rowOffset = yPosition * Chip8::MegaScreenWidth;
+
+        if (isRedrawn || (memcmp(&newFrame.indexedMemory[rowOffset], &this->presentedFrame.indexedMemory[rowOffset], Chip8::MegaScreenWidth) != 0)) {
+            firstRow = firstRow < yPosition ? firstRow : yPosition;
+            lastRow  = yPosition;
+        }
+    }
+
+    if (firstRow > lastRow) {
+        return;
+    }
+
+    uint8 colorTable[256][3];
+
+    for (uint colorIndex = 0; colorIndex < 256; ++colorIndex) {
+        uint32 colorValue = newFrame.palette[colorIndex];
+        uint   colorAlpha = ((colorValue >> 24) * newFrame.screenAlpha) / 0xFF;
+
+        colorTable[colorIndex][0] = (((colorValue >> 16) & 0xFF) * colorAlpha) / 0xFF;
+        colorTable[colorIndex][1] = (((colorValue >> 8) & 0xFF) * colorAlpha) / 0xFF;
+        colorTable[colorIndex][2] = ((colorValue & 0xFF) * colorAlpha) / 0xFF;
+    }
+
+    for (uint yPosition = firstRow; yPosition <= lastRow; ++yPosition) {
+        uint8*       surfaceLine = reinterpret_cast<uint8*>(this->screenSurface->pixels) + (yPosition * this->screenSurface->pitch);
+        const uint8* lineIndices = &newFrame.indexedMemory[yPosition * Chip8::MegaScreenWidth];
+
+        for (uint xPosition = 0; xPosition < Chip8::MegaScreenWidth; ++xPosition) {
+            memcpy(&surfaceLine[xPosition * 3], colorTable[lineIndices[xPosition]], 3);
         }
+
+        memcpy(&this->presentedFrame.indexedMemory[yPosition * Chip8::MegaScreenWidth], lineIndices, Chip8::MegaScreenWidth);
+    }
+
+    memcpy(this->presentedFrame.palette, newFrame.palette, sizeof(Chip8::Palette));
+    this->presentedFrame.screenAlpha = newFrame.screenAlpha;
+    this->presentedFrame.isMegaChip  = true;
+
+    SDL_Rect sourceRect = {0, static_cast<int>(firstRow), Chip8::MegaScreenWidth, static_cast<int>(lastRow - firstRow + 1)};
+    this->Show(newFrame, sourceRect, Chip8::MegaScreenHeight);
+}
+
+void Interface::Show(const Frame& newFrame, const SDL_Rect& sourceRect, uint screenHeight) {
+    // A redraw of what the window already shows has no latency to measure.
+
+    uint64 publishTime = (&newFrame != &this->presentedFrame) ? newFrame.publishTime : 0;
+
+    this->isExposed = false;
+
+    // With vsync the rows only go to the texture, the next refresh presents the whole screen.
+
+    if (this->sdlRenderer) {
+        const uint8* sourceLine = reinterpret_cast<const uint8*>(this->screenSurface->pixels) + (sourceRect.y * this->screenSurface->pitch);
+
+        SDL_UpdateTexture(this->sdlTexture, &sourceRect, sourceLine, this->screenSurface->pitch);
+
+        this->screenRect.w       = sourceRect.w;
+        this->screenRect.h       = screenHeight;
+        this->isPresentPending   = true;
+        this->pendingPublishTime = publishTime;
+        return;
     }
 
-    // Update the screen
+    SDL_Rect destinationRect = {0, static_cast<int>((sourceRect.y * Interface::Height) / screenHeight), Interface::Width, static_cast<int>((sourceRect.h * Interface::Height) / screenHeight)};
+
+    SDL_BlitScaled(this->screenSurface, &sourceRect, this->sdlWindowSurface, &destinationRect);
+    SDL_UpdateWindowSurfaceRects(this->sdlWindow, &destinationRect, 1);
+
+    this->CompletePresent(Scheduler::Now(), publishTime);
+}
+
+// Statistics
 
-    SDL_BlitScaled(this->screenSurface, NULL, this->sdlWindowSurface, NULL);
-    SDL_UpdateWindowSurface(this->sdlWindow);
+uint64 Interface::GetPresentedFrames(void) const {
+    return this->presentedFrames;
+}
+
+uint64 Interface::GetSkippedFrames(void) const {
+    return this->skippedFrames;
+}
+
+uint64 Interface::GetMissedRefreshes(void) const {
+    return this->displayClock.GetMissedRefreshes();
+}
+
+const IntervalStatistics& Interface::GetUpdateIntervals(void) const {
+    return this->updateIntervals;
+}
+
+const IntervalStatistics& Interface::GetPresentIntervals(void) const {
+    return this->presentIntervals;
+}
+
+const IntervalStatistics& Interface::GetPresentLatency(void) const {
+    return this->presentLatency;
+}
+
+const IntervalHistogram& Interface::GetUpdateHistogram(void) const {
+    return this->updateHistogram;
+}
+
+const IntervalHistogram& Interface::GetPresentHistogram(void) const {
+    return this->presentHistogram;
+}
+
+const IntervalHistogram& Interface::GetLatencyHistogram(void) const {
+    return this->latencyHistogram;
+}
+
+void Interface::ReportPacing(void) const {
+    Info(Interface::Tag, "Frames every %.2f ms (median), %.2f ms (99%%), %.2f ms (worst), %" PRIu64 " deadlines missed.", this->updateHistogram.GetPercentile(50.0) / 1e6, this->updateHistogram.GetPercentile(99.0) / 1e6, this->updateHistogram.GetMaximum() / 1e6, this->chip8->GetMissedDeadlines());
+    Info(Interface::Tag, "Presents every %.2f ms (median), %.2f ms (99%%), %.2f ms (worst), %" PRIu64 " refreshes missed.", this->presentHistogram.GetPercentile(50.0) / 1e6, this->presentHistogram.GetPercentile(99.0) / 1e6, this->presentHistogram.GetMaximum() / 1e6, this->displayClock.GetMissedRefreshes());
+    Info(Interface::Tag, "Frames shown %.2f ms (median), %.2f ms (99%%), %.2f ms (worst) after they were handed over.", this->latencyHistogram.GetPercentile(50.0) / 1e6, this->latencyHistogram.GetPercentile(99.0) / 1e6, this->latencyHistogram.GetMaximum() / 1e6);
+}
+
+// Statistics (window thread)
+
+void Interface::CompletePresent(uint64 presentTime, uint64 publishTime) {
+    this->presentedFrames++;
+    this->presentIntervals.Record(presentTime);
+    this->presentHistogram.Record(presentTime);
+
+    if (publishTime) {
+        this->presentLatency.RecordInterval(presentTime - publishTime);
+        this->latencyHistogram.RecordInterval(presentTime - publishTime);
+    }
 }
@@ -9,24 +9,72 @@
 #define CHIP8_INTERFACE_H
 
 #include "Chip8.hxx"
+#include "Scheduler.hxx"
+#include "SpscQueue.hxx"
+#include "TripleBuffer.hxx"
 
 #include <SDL2/SDL.h>
 
-// Interface
+// Interface (SDL; Update and WaitForFrame run on the emulation thread, Render on the thread that owns the window)
 
 class Interface : public Chip8::Interface {
     public:
         Interface(void);
 
+        // Types
+        enum PresentationMode {
+            SurfacePresentation,    // Changed rows are blitted to the window as soon as a frame arrives
+            VsyncPresentation       // A renderer presents on every refresh, frames start on them when the rate allows
+        };
+
+        enum EventType {
+            QuitEvent
+        };
+
+        struct Event {
+                uint8 eventType;
+                uint8 eventValue;
+        };
+
+        struct Frame {
+                Chip8::VRAM        videoMemory;
+                bool               isExtendedScreen;
+                bool               isMegaChip;       // The indexed screen below is shown instead of the bits above
+                Chip8::IndexedVRAM indexedMemory;
+                Chip8::Palette     palette;
+                uint8              screenAlpha;
+                uint64             publishTime;      // When Update handed it over
+        };
+
         // Constants
-        static constexpr charconst Tag    = "Interface";
-        static constexpr uint      Width  = 720;
-        static constexpr uint      Height = 360;
+        static constexpr charconst Tag           = "Interface";
+        static constexpr uint      Width         = 720;
+        static constexpr uint      Height        = 360;
+        static constexpr uint      EventCapacity = 64;
+        static constexpr uint      IdleWait      = 1;    // Milliseconds to wait for events when no frame is ready
 
         // General
+        void SetPresentationMode(PresentationMode newMode);    // Before Initialize
         bool Initialize(Chip8* chip8);
         void Finalize(void);
-        void Update(void);
+        void Update(const Chip8::DirtyRegion& dirtyRegion);
+        bool WaitForFrame(uint64 frameDeadline);
+
+        // Rendering
+        void Render(void);
+        void StopRendering(void);
+
+        // Statistics (the histograms and missed counts may be read while running, F1 logs them)
+        uint64                    GetPresentedFrames(void) const;
+        uint64                    GetSkippedFrames(void) const;
+        uint64                    GetMissedRefreshes(void) const;
+        const IntervalStatistics& GetUpdateIntervals(void) const;
+        const IntervalStatistics& GetPresentIntervals(void) const;
+        const IntervalStatistics& GetPresentLatency(void) const;    // From Update handing a frame over to it being shown
+        const IntervalHistogram&  GetUpdateHistogram(void) const;
+        const IntervalHistogram&  GetPresentHistogram(void) const;
+        const IntervalHistogram&  GetLatencyHistogram(void) const;
+        void                      ReportPacing(void) const;
 
     private:
         // General
@@ -36,9 +84,49 @@ class Interface : public Chip8::Interface {
         Chip8* chip8;
 
         // SDL
-        SDL_Window*  sdlWindow;
-        SDL_Surface* sdlWindowSurface;
-        SDL_Surface* screenSurface;
+        SDL_Window*   sdlWindow;
+        SDL_Surface*  sdlWindowSurface;
+        SDL_Renderer* sdlRenderer;    // With vsync, the window surface is not used then
+        SDL_Texture*  sdlTexture;
+        SDL_Surface*  screenSurface;
+
+        bool CreateRenderer(void);
+
+        // Threads (frames go to the renderer, events come back to the emulation thread; keys are set on the machine directly)
+        TripleBuffer<Frame>             frameBuffer;
+        SpscQueue<Event, EventCapacity> eventQueue;
+        std::atomic<bool>               isRendering;
+
+        // Rendering
+        Frame presentedFrame;
+        bool  isExposed;    // The window contents were lost and need a full redraw
+        bool  isQuitPending;
+
+        void PollEvents(uint waitTime);
+        void Present(const Frame& newFrame);
+        void PresentIndexed(const Frame& newFrame);
+        void Show(const Frame& newFrame, const SDL_Rect& sourceRect, uint screenHeight);
+
+        // Pacing
+        PresentationMode presentationMode;
+        DisplayClock     displayClock;
+        SDL_Rect         screenRect;            // The part of the texture the current screen mode uses
+        bool             isPresentPending;      // Rows went to the texture and are shown on the next refresh
+        uint64           pendingPublishTime;    // 0 for a redraw of what was already shown
+
+        void RenderSynchronized(void);
+
+        // Statistics
+        uint64             presentedFrames;
+        uint64             skippedFrames;
+        IntervalStatistics updateIntervals;
+        IntervalStatistics presentIntervals;
+        IntervalStatistics presentLatency;
+        IntervalHistogram  updateHistogram;
+        IntervalHistogram  presentHistogram;
+        IntervalHistogram  latencyHistogram;
+
+        void CompletePresent(uint64 presentTime, uint64 publishTime);
 };
 
 #endif    // CHIP8_INTERFACE_H
@@ -0,0 +1,158 @@
+/*
+ * LibChip8.cxx
+ *
+ * This file is part of the Chip8++ source code.
+ * Copyright 2023 Patrick Melo <patrick@patrickmelo.com.br>
+ */
+
+#include "Chip8.hxx"
+#include "Core.hxx"
+#include "LibChip8.h"
+
+// Constants
+
+static constexpr charconst Tag = "LibChip8";
+
+// Machines
+
+struct Chip8_Machine {
+        Chip8  chip8;
+        uint8* mainMemory;
+        uint32 memorySize;
+};
+
+Chip8_Machine* Chip8_Create(void) {
+    Chip8_Machine* newMachine = new (std::nothrow) Chip8_Machine;
+
+    if (!newMachine) {
+        Error(Tag, "Could not allocate a machine.");
+        return NULL;
+    }
+
+    newMachine->memorySize = sizeof(Chip8::RAM);
+    newMachine->mainMemory = new (std::nothrow) uint8[newMachine->memorySize]();
+
+    if (!newMachine->mainMemory) {
+        Error(Tag, "Could not allocate %u bytes of memory.", newMachine->memorySize);
+        delete newMachine;
+        return NULL;
+    }
+
+    // The decoded cache is allocated here rather than on the first step.
+
+    Chip8::LoadFonts(newMachine->mainMemory);
+    newMachine->chip8.SetMemory(newMachine->mainMemory, newMachine->memorySize);
+    newMachine->chip8.SetEngine(Chip8::Predecoded);
+    newMachine->chip8.Reset();
+
+    return newMachine;
+}
+
+void Chip8_Destroy(Chip8_Machine* machine) {
+    if (machine) {
+        delete[] machine->mainMemory;
+        delete machine;
+    }
+}
+
+int Chip8_LoadProgram(Chip8_Machine* machine, const uint8_t* programData, size_t programSize) {
+    if (!programData || (programSize == 0) || (programSize > (Chip8::MaximumMemorySize - Chip8::ProgramStartAddress))) {
+        Error(Tag, "The program does not fit in %u bytes of memory.", Chip8::MaximumMemorySize);
+        return 0;
+    }
+
+    // MEGA-CHIP programs get a larger memory, nothing else is reallocated.
+
+    uint32 memorySize = Chip8::GetMemorySize(UINT64(programSize));
+
+    if (memorySize != machine->memorySize) {
+        uint8* newMemory = new (std::nothrow) uint8[memorySize];
+
+        if (!newMemory) {
+            Error(Tag, "Could not allocate %u bytes of memory.", memorySize);
+            return 0;
+        }
+
+        machine->chip8.SetMemory(newMemory, memorySize);
+        delete[] machine->mainMemory;
+
+        machine->mainMemory = newMemory;
+        machine->memorySize = memorySize;
+    }
+
+    memset(machine->mainMemory, 0, machine->memorySize);
+    memcpy(&machine->mainMemory[Chip8::ProgramStartAddress], programData, programSize);
+    Chip8::LoadFonts(machine->mainMemory);
+
+    machine->chip8.SetQuirkProfile(Chip8::DetectQuirkProfile("", machine->mainMemory));
+    machine->chip8.Reset();
+    return 1;
+}
+
+void Chip8_Reset(Chip8_Machine* machine) {
+    machine->chip8.Reset();
+}
+
+void Chip8_SetQuirkProfile(Chip8_Machine* machine, int quirkProfile) {
+    if ((quirkProfile >= CHIP8_QUIRKS_VIP) && (quirkProfile <= CHIP8_QUIRKS_SCHIP)) {
+        machine->chip8.SetQuirkProfile(static_cast<Chip8::QuirkProfile>(quirkProfile));
+    }
+}
+
+void Chip8_SetInstructionsPerFrame(Chip8_Machine* machine, unsigned int instructionsPerFrame) {
+    machine->chip8.SetInstructionsPerFrame(instructionsPerFrame);
+}
+
+void Chip8_SetRandomSeed(Chip8_Machine* machine, uint32_t randomSeed) {
+    machine->chip8.SetRandomSeed(randomSeed);
+}
+
+// Stepping
+
+uint64_t Chip8_StepFrames(Chip8_Machine* machine, uint64_t numberOfFrames, uint16_t keyMask) {
+    // Only a change of the mask touches the keypad.
+
+    if (keyMask != machine->chip8.GetKeyStates()) {
+        machine->chip8.SetKeyStates(keyMask);
+    }
+
+    return machine->chip8.RunFrames(numberOfFrames);
+}
+
+int Chip8_GetStopReason(const Chip8_Machine* machine) {
+    return machine->chip8.GetStopReason();
+}
+
+// Observing
+
+const uint64_t* Chip8_GetFramebuffer(const Chip8_Machine* machine) {
+    return machine->chip8.GetVRAM();
+}
+
+unsigned int Chip8_GetScreenWidth(const Chip8_Machine* machine) {
+    return machine->chip8.GetScreenWidth();
+}
+
+unsigned int Chip8_GetScreenHeight(const Chip8_Machine* machine) {
+    return machine->chip8.GetScreenHeight();
+}
+
+const uint8_t* Chip8_GetRegisters(const Chip8_Machine* machine) {
+    return machine->chip8.GetRegisters();
+}
+
+uint32_t Chip8_GetAddressRegister(const Chip8_Machine* machine) {
+    return machine->chip8.GetAddressRegister();
+}
+
+uint16_t Chip8_GetProgramCounter(const Chip8_Machine* machine) {
+    return machine->chip8.GetProgramCounter();
+}
+
+uint8_t Chip8_GetDelayTimer(const Chip8_Machine* machine) {
+    return machine->chip8.GetDelayTimer();
+}
+
+uint8_t Chip8_GetSoundTimer(const Chip8_Machine* machine) {
+    return machine->chip8.GetSoundTimer();
+}
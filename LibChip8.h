@@ -0,0 +1,69 @@
+/*
+ * LibChip8.h
+ *
+ * This file is part of the Chip8++ source code.
+ * Copyright 2023 Patrick Melo <patrick@patrickmelo.com.br>
+ */
+
+#ifndef LIBCHIP8_H
+#define LIBCHIP8_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CHIP8_API __attribute__((visibility("default")))
+
+/*
+ * libchip8, the emulator core without SDL, for programs that drive machines themselves. A machine only allocates when it
+ * is created and when a program is loaded; stepping and observing never do. One machine is used from one thread at a time.
+ */
+
+typedef struct Chip8_Machine Chip8_Machine;
+
+enum Chip8_QuirkProfile {
+    CHIP8_QUIRKS_VIP    = 0,    /* COSMAC VIP */
+    CHIP8_QUIRKS_CHIP48 = 1,    /* HP48 CHIP-48 */
+    CHIP8_QUIRKS_SCHIP  = 2     /* SUPER-CHIP 1.1 */
+};
+
+enum Chip8_StopReason {
+    CHIP8_BUDGET_EXHAUSTED = 0,    /* Every frame asked for ran */
+    CHIP8_HALTED           = 1,    /* Unknown instruction, stack overflow or underflow */
+    CHIP8_STOPPED          = 2,
+    CHIP8_EXITED           = 3     /* The program ran 00FD */
+};
+
+#define CHIP8_SCREEN_WORDS 128    /* One word per row, two in the extended screen, bit 63 is the leftmost pixel */
+
+/* Machines */
+CHIP8_API Chip8_Machine* Chip8_Create(void);
+CHIP8_API void           Chip8_Destroy(Chip8_Machine* machine);
+CHIP8_API int            Chip8_LoadProgram(Chip8_Machine* machine, const uint8_t* programData, size_t programSize);    /* 1 when loaded, then resets and detects the quirk profile */
+CHIP8_API void           Chip8_Reset(Chip8_Machine* machine);
+CHIP8_API void           Chip8_SetQuirkProfile(Chip8_Machine* machine, int quirkProfile);
+CHIP8_API void           Chip8_SetInstructionsPerFrame(Chip8_Machine* machine, unsigned int instructionsPerFrame);
+CHIP8_API void           Chip8_SetRandomSeed(Chip8_Machine* machine, uint32_t randomSeed);    /* Takes effect at the next reset */
+
+/* Stepping (the key mask holds one bit per key, bit 0 is key 0; keys going down are presses FX0A can take) */
+CHIP8_API uint64_t Chip8_StepFrames(Chip8_Machine* machine, uint64_t numberOfFrames, uint16_t keyMask);    /* Instructions retired */
+CHIP8_API int      Chip8_GetStopReason(const Chip8_Machine* machine);
+
+/* Observing (the pointers stay valid, and keep changing, for as long as the machine lives) */
+CHIP8_API const uint64_t* Chip8_GetFramebuffer(const Chip8_Machine* machine);    /* CHIP8_SCREEN_WORDS words */
+CHIP8_API unsigned int    Chip8_GetScreenWidth(const Chip8_Machine* machine);
+CHIP8_API unsigned int    Chip8_GetScreenHeight(const Chip8_Machine* machine);
+CHIP8_API const uint8_t*  Chip8_GetRegisters(const Chip8_Machine* machine);      /* V0-VF */
+CHIP8_API uint32_t        Chip8_GetAddressRegister(const Chip8_Machine* machine);
+CHIP8_API uint16_t        Chip8_GetProgramCounter(const Chip8_Machine* machine);
+CHIP8_API uint8_t         Chip8_GetDelayTimer(const Chip8_Machine* machine);
+CHIP8_API uint8_t         Chip8_GetSoundTimer(const Chip8_Machine* machine);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif    /* LIBCHIP8_H */
@@ -5,32 +5,322 @@
  * Copyright 2023 Patrick Melo <patrick@patrickmelo.com.br>
  */
 
+#include "Audio.hxx"
 #include "Chip8.hxx"
 #include "Core.hxx"
 #include "Interface.hxx"
+#include "NullAudio.hxx"
+#include "NullInterface.hxx"
+#include "RomPack.hxx"
+#include "Tracer.hxx"
+
+#include <thread>
+
+// Constants
+
+static constexpr charconst Tag = "Main";
+
+// Options
+
+struct Options {
+        bool                isHeadless;
+        uint64              cycleBudget;
+        uint64              frameBudget;
+        bool                hasCpuRate;         // Otherwise a packed program may recommend one
+        uint                cpuRate;
+        Chip8::Engine       engine;
+        bool                isIdleSkipping;
+        bool                isVsync;            // Present on the display's refreshes and start frames on them
+        bool                hasQuirkProfile;    // Otherwise the pack names it or it is detected from the program
+        Chip8::QuirkProfile quirkProfile;
+        charconst           profilePath;
+        charconst           tracePath;
+        charconst           packPath;           // The program is then a name in the pack
+        charconst           keysPath;           // Scripted keys for headless runs
+        charconst           programPath;
+};
+
+static bool ParseOptions(int numberOfArguments, char** argumentsValues, Options& options) {
+    options.isHeadless      = false;
+    options.cycleBudget     = 0;
+    options.frameBudget     = 0;
+    options.hasCpuRate      = false;
+    options.cpuRate         = Chip8::DefaultCpuRate;
+    options.engine          = Chip8::Predecoded;
+    options.isIdleSkipping  = true;
+    options.isVsync         = false;
+    options.hasQuirkProfile = false;
+    options.quirkProfile    = Chip8::QuirksVIP;
+    options.profilePath     = Profiler::DefaultOutputPath;
+    options.tracePath       = NULL;
+    options.packPath        = NULL;
+    options.keysPath        = NULL;
+    options.programPath     = NULL;
+
+    for (int argumentIndex = 1; argumentIndex < numberOfArguments; ++argumentIndex) {
+        charconst argumentValue = argumentsValues[argumentIndex];
+        bool      hasValue      = (argumentIndex + 1) < numberOfArguments;
+
+        if (strcmp(argumentValue, "--headless") == 0) {
+            options.isHeadless = true;
+        } else if ((strcmp(argumentValue, "--cycles") == 0) && hasValue) {
+            options.cycleBudget = strtoull(argumentsValues[++argumentIndex], NULL, 10);
+        } else if ((strcmp(argumentValue, "--frames") == 0) && hasValue) {
+            options.frameBudget = strtoull(argumentsValues[++argumentIndex], NULL, 10);
+        } else if ((strcmp(argumentValue, "--cpu-rate") == 0) && hasValue) {
+            options.hasCpuRate = true;
+            options.cpuRate    = strtoul(argumentsValues[++argumentIndex], NULL, 10);
+        } else if ((strcmp(argumentValue, "--engine") == 0) && hasValue) {
+            charconst engineName = argumentsValues[++argumentIndex];
+
+            if (strcmp(engineName, "interpreter") == 0) {
+                options.engine = Chip8::Interpreter;
+            } else if (strcmp(engineName, "predecoded") == 0) {
+                options.engine = Chip8::Predecoded;
+            } else if (strcmp(engineName, "recompiled") == 0) {
+                options.engine = Chip8::Recompiled;
+            } else if (strcmp(engineName, "translated") == 0) {
+                options.engine = Chip8::Translated;
+            } else {
+                Error(Tag, "Unknown engine: %s", engineName);
+                return false;
+            }
+        } else if (strcmp(argumentValue, "--no-idle-skip") == 0) {
+            options.isIdleSkipping = false;
+        } else if (strcmp(argumentValue, "--vsync") == 0) {
+            options.isVsync = true;
+        } else if ((strcmp(argumentValue, "--quirks") == 0) && hasValue) {
+            charconst profileName = argumentsValues[++argumentIndex];
+
+            options.hasQuirkProfile = true;
+
+            if (strcmp(profileName, "vip") == 0) {
+                options.quirkProfile = Chip8::QuirksVIP;
+            } else if (strcmp(profileName, "chip48") == 0) {
+                options.quirkProfile = Chip8::QuirksCHIP48;
+            } else if (strcmp(profileName, "schip") == 0) {
+                options.quirkProfile = Chip8::QuirksSCHIP;
+            } else {
+                Error(Tag, "Unknown quirk profile: %s", profileName);
+                return false;
+            }
+        } else if ((strcmp(argumentValue, "--profile-output") == 0) && hasValue) {
+            options.profilePath = argumentsValues[++argumentIndex];
+        } else if ((strcmp(argumentValue, "--trace") == 0) && hasValue) {
+            options.tracePath = argumentsValues[++argumentIndex];
+        } else if ((strcmp(argumentValue, "--pack") == 0) && hasValue) {
+            options.packPath = argumentsValues[++argumentIndex];
+        } else if ((strcmp(argumentValue, "--keys") == 0) && hasValue) {
+            options.keysPath = argumentsValues[++argumentIndex];
+        } else if (argumentValue[0] == '-') {
+            Error(Tag, "Unknown option: %s", argumentValue);
+            return false;
+        } else {
+            options.programPath = argumentValue;
+        }
+    }
+
+    if (!options.programPath) {
+        printf("Usage: %s [--cpu-rate <hz>] [--engine <interpreter|predecoded|recompiled|translated>] [--no-idle-skip] [--vsync] [--quirks <vip|chip48|schip>] [--profile-output <path>] [--trace <path>] [--pack <path>] [--headless [--keys <script>] [--cycles <count> | --frames <count>]] <program>\n", argumentsValues[0]);
+        return false;
+    }
+
+    return true;
+}
+
+// Headless
+
+static charconst StopReasonName(Chip8::StopReason stopReason) {
+    switch (stopReason) {
+        case Chip8::BudgetExhausted: return "budget exhausted";
+        case Chip8::Halted: return "halted";
+        case Chip8::Stopped: return "stopped";
+        case Chip8::Exited: return "exited";
+    }
+
+    return "unknown";
+}
+
+static int RunHeadless(Chip8* chip8, const Options& options) {
+    NullInterface nullInterface;
+    NullAudio     nullAudio;
+
+    nullInterface.Initialize(chip8);
+    nullAudio.Initialize(chip8);
+
+    if (options.keysPath && !nullInterface.LoadKeyScript(options.keysPath)) {
+        nullAudio.Finalize();
+        nullInterface.Finalize();
+        return 1;
+    }
+
+    timeval startTime, endTime;
+    uint64  retiredInstructions = 0;
+
+    chip8->Reset();
+    gettimeofday(&startTime, NULL);
+
+    if (options.cycleBudget > 0) {
+        retiredInstructions = chip8->RunCycles(options.cycleBudget);
+    } else if (options.frameBudget > 0) {
+        retiredInstructions = chip8->RunFrames(options.frameBudget);
+    } else {
+        do {
+            retiredInstructions += chip8->RunFrames(60);
+        } while (chip8->GetStopReason() == Chip8::BudgetExhausted);
+    }
+
+    gettimeofday(&endTime, NULL);
+    nullAudio.Finalize();
+    nullInterface.Finalize();
+
+    uint64 elapsedTime = ((endTime.tv_sec * 1000000) + endTime.tv_usec) - ((startTime.tv_sec * 1000000) + startTime.tv_usec);
+
+    Info(Tag, "%" PRIu64 " instructions retired in %" PRIu64 " us (%" PRIu64 " frames, %s).", retiredInstructions, elapsedTime, nullInterface.GetFrameCount(), StopReasonName(chip8->GetStopReason()));
+    Info(Tag, "%" PRIu64 " frames would be presented, %" PRIu64 " skipped.", nullInterface.GetDirtyFrameCount(), nullInterface.GetFrameCount() - nullInterface.GetDirtyFrameCount());
+    Info(Tag, "%" PRIu64 " tones would be played.", nullAudio.GetToneCount());
+    Info(Tag, "%" PRIu64 " instructions skipped in %" PRIu64 " idle loops.", chip8->GetIdleStatistics().skippedInstructions, chip8->GetIdleStatistics().skippedLoops);
+
+    if (chip8->GetTranslatedProgram()) {
+        Chip8::TranslationStatistics translationStatistics = chip8->GetTranslationStatistics();
+        Info(Tag, "%" PRIu64 " instructions ran as translated code, %" PRIu64 " from the predecoded cache.", translationStatistics.nativeInstructions, translationStatistics.interpretedInstructions);
+    }
+
+    if (options.keysPath) {
+        Info(Tag, "%" PRIu64 " scripted key events applied, %" PRIu64 " keys taken by FX0A.", nullInterface.GetAppliedKeyEvents(), chip8->GetKeyLatency().GetCount());
+    }
+    return chip8->GetStopReason() == Chip8::Halted ? 1 : 0;
+}
+
+// Main
 
 int main(int numberOfArguments, char** argumentsValues) {
-    Chip8*     chip8 = new Chip8();
-    Chip8::RAM chip8Memory;
+    Options options;
 
-    if (!Chip8::LoadProgram(argumentsValues[1], chip8Memory)) {
+    if (!ParseOptions(numberOfArguments, argumentsValues, options)) {
+        return 1;
+    }
+
+    // A packed program comes with its profile and speed, the command line still wins.
+
+    RomPack               romPack;
+    const RomPack::Entry* romEntry = NULL;
+
+    if (options.packPath) {
+        if (!romPack.Open(options.packPath)) {
+            return 1;
+        }
+
+        romEntry = romPack.FindByName(options.programPath);
+
+        if (!romEntry) {
+            Error(Tag, "%s is not in %s.", options.programPath, options.packPath);
+            return 1;
+        }
+    }
+
+    // Programs larger than the classic 4 KB (MEGA-CHIP) get the power of two that fits them.
+
+    uint32 memorySize  = romEntry ? Chip8::GetMemorySize(UINT64(romEntry->dataSize)) : Chip8::GetMemorySize(options.programPath);
+    uint8* chip8Memory = memorySize ? new (std::nothrow) uint8[memorySize]() : NULL;
+
+    if (memorySize && !chip8Memory) {
+        Error(Tag, "Could not allocate %u bytes of memory.", memorySize);
+    }
+
+    bool isLoaded = chip8Memory && (romEntry ? romPack.LoadProgram(*romEntry, chip8Memory, memorySize) : Chip8::LoadProgram(options.programPath, chip8Memory, memorySize));
+
+    if (!isLoaded) {
+        delete[] chip8Memory;
+        return 1;
+    }
+
+    Chip8*              chip8        = new Chip8();
+    uint                cpuRate      = options.cpuRate;
+    Chip8::QuirkProfile quirkProfile = options.quirkProfile;
+
+    if (!options.hasCpuRate && romEntry && romEntry->instructionsPerFrame) {
+        cpuRate = romEntry->instructionsPerFrame * Chip8::FrameRate;
+    }
+
+    if (!options.hasQuirkProfile) {
+        quirkProfile = romEntry ? static_cast<Chip8::QuirkProfile>(romEntry->quirkProfile) : Chip8::DetectQuirkProfile(options.programPath, chip8Memory);
+    }
+
+    chip8->SetMemory(chip8Memory, memorySize);
+    chip8->SetCpuRate(cpuRate);
+    chip8->SetEngine(options.engine);
+    chip8->SetIdleSkipping(options.isIdleSkipping);
+    chip8->SetQuirkProfile(quirkProfile);
+
+    // Only programs translated for this profile and linked in run as translated code, anything else still runs.
+
+    if ((options.engine == Chip8::Translated) && !chip8->GetTranslatedProgram()) {
+        Warning(Tag, "No translation of %s is linked in, it runs from the predecoded cache.", options.programPath);
+    }
+
+    Tracer chip8Tracer;
+
+    if (options.tracePath && (!chip8Tracer.Initialize(chip8) || !chip8Tracer.StartWriter(options.tracePath))) {
         delete chip8;
+        delete[] chip8Memory;
         return 1;
     }
 
+    if (options.isHeadless) {
+        int exitCode = RunHeadless(chip8, options);
+        chip8Tracer.Finalize();
+
+#ifdef CHIP8_PROFILE
+        chip8->GetProfiler().WriteJson(options.profilePath);
+#endif
+
+        delete chip8;
+        delete[] chip8Memory;
+        return exitCode;
+    }
+
     Interface* chip8Interface = new Interface();
 
+    chip8Interface->SetPresentationMode(options.isVsync ? Interface::VsyncPresentation : Interface::SurfacePresentation);
+
     if (!chip8Interface->Initialize(chip8)) {
+        chip8Tracer.Finalize();
         delete chip8Interface;
         delete chip8;
+        delete[] chip8Memory;
         return 1;
     }
 
-    chip8->SetRAM(&chip8Memory);
-    chip8->Run();
+    // No sound device is not a reason to stop, the program just runs silently.
+
+    Audio chip8Audio;
+
+    if (!chip8Audio.Initialize(chip8)) {
+        Warning(Tag, "Running without sound.");
+    }
+
+    // The window stays on this thread (SDL wants its events pumped where the video was initialized), the emulation runs on
+    // its own thread and only hands frames over, so a slow present never delays instructions.
+
+    std::thread emulationThread([chip8, chip8Interface]() {
+        chip8->Run();
+        chip8Interface->StopRendering();
+    });
+
+    chip8Interface->Render();
+    emulationThread.join();
+    chip8Audio.Finalize();
+    chip8Interface->Finalize();
+    chip8Tracer.Finalize();
+
+#ifdef CHIP8_PROFILE
+    chip8->GetProfiler().WriteJson(options.profilePath);
+#endif
 
     delete chip8;
     delete chip8Interface;
+    delete[] chip8Memory;
 
     return 0;
 }
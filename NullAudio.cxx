@@ -0,0 +1,54 @@
+/*
+ * NullAudio.cxx
+ *
+ * This file is part of the Chip8++ source code.
+ * Copyright 2023 Patrick Melo <patrick@patrickmelo.com.br>
+ */
+
+#include "NullAudio.hxx"
+
+// Null Audio
+
+NullAudio::NullAudio(void) :
+    Chip8::Audio(),
+    isInitialized(false),
+    chip8(NULL),
+    toneCount(0) {
+    // Empty
+}
+
+// General
+
+bool NullAudio::Initialize(Chip8* chip8) {
+    if (this->isInitialized) {
+        return false;
+    }
+
+    this->chip8     = chip8;
+    this->toneCount = 0;
+
+    this->chip8->SetAudio(this);
+
+    return this->isInitialized = true;
+}
+
+void NullAudio::Finalize(void) {
+    if (!this->isInitialized) {
+        return;
+    }
+
+    this->chip8->SetAudio(NULL);
+    this->isInitialized = false;
+}
+
+// Chip8
+
+void NullAudio::SetBeeper(bool isBeeping) {
+    this->toneCount += isBeeping;
+}
+
+// Statistics
+
+uint64 NullAudio::GetToneCount(void) const {
+    return this->toneCount;
+}
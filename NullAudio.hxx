@@ -0,0 +1,41 @@
+/*
+ * NullAudio.hxx
+ *
+ * This file is part of the Chip8++ source code.
+ * Copyright 2023 Patrick Melo <patrick@patrickmelo.com.br>
+ */
+
+#ifndef CHIP8_NULL_AUDIO_H
+#define CHIP8_NULL_AUDIO_H
+
+#include "Chip8.hxx"
+
+// Null Audio (headless, no SDL; counts what would have been heard)
+
+class NullAudio : public Chip8::Audio {
+    public:
+        NullAudio(void);
+
+        // Constants
+        static constexpr charconst Tag = "NullAudio";
+
+        // General
+        bool Initialize(Chip8* chip8);
+        void Finalize(void);
+        void SetBeeper(bool isBeeping);
+
+        // Statistics
+        uint64 GetToneCount(void) const;
+
+    private:
+        // General
+        bool isInitialized;
+
+        // Chip8
+        Chip8* chip8;
+
+        // Statistics
+        uint64 toneCount;
+};
+
+#endif    // CHIP8_NULL_AUDIO_H
@@ -0,0 +1,134 @@
+/*
+ * NullInterface.cxx
+ *
+ * This file is part of the Chip8++ source code.
+ * Copyright 2023 Patrick Melo <patrick@patrickmelo.com.br>
+ */
+
+#include "NullInterface.hxx"
+
+// Null Interface
+
+NullInterface::NullInterface(void) :
+    Chip8::Interface(),
+    isInitialized(false),
+    chip8(NULL),
+    nextKeyEvent(0),
+    frameCount(0),
+    dirtyFrameCount(0) {
+    // Empty
+}
+
+// General
+
+bool NullInterface::Initialize(Chip8* chip8) {
+    if (this->isInitialized) {
+        return false;
+    }
+
+    this->chip8           = chip8;
+    this->nextKeyEvent    = 0;
+    this->frameCount      = 0;
+    this->dirtyFrameCount = 0;
+
+    this->chip8->SetInterface(this);
+
+    return this->isInitialized = true;
+}
+
+void NullInterface::Finalize(void) {
+    if (!this->isInitialized) {
+        return;
+    }
+
+    this->chip8->SetInterface(NULL);
+    this->isInitialized = false;
+}
+
+// Chip8
+
+void NullInterface::Update(const Chip8::DirtyRegion& dirtyRegion) {
+    this->frameCount++;
+    this->dirtyFrameCount += dirtyRegion.isDirty;
+
+    // The keys scheduled for this frame are down (or up) before the next one runs.
+
+    while ((this->nextKeyEvent < this->keyEvents.size()) && (this->keyEvents[this->nextKeyEvent].frameNumber <= this->frameCount)) {
+        const KeyEvent& keyEvent = this->keyEvents[this->nextKeyEvent++];
+        this->chip8->SetKey(keyEvent.keyIndex, keyEvent.isPressed);
+    }
+}
+
+// Input
+
+bool NullInterface::LoadKeyScript(const string filePath) {
+    // One change per line: <frame> <key in hex> <down|up>, lines starting with # are comments.
+
+    FILE* scriptFile = fopen(filePath.c_str(), "r");
+
+    if (!scriptFile) {
+        Error(NullInterface::Tag, "Could not open %s.", filePath.c_str());
+        return false;
+    }
+
+    char lineBuffer[256];
+    uint lineNumber = 0;
+    bool isLoaded   = true;
+
+    while (isLoaded && fgets(lineBuffer, sizeof(lineBuffer), scriptFile)) {
+        KeyEvent keyEvent;
+        char     actionName[8];
+        uint     keyIndex;
+
+        lineNumber++;
+
+        if ((lineBuffer[0] == '#') || (strspn(lineBuffer, " \t\r\n") == strlen(lineBuffer))) {
+            continue;
+        }
+
+        if ((sscanf(lineBuffer, "%" SCNu64 " %x %7s", &keyEvent.frameNumber, &keyIndex, actionName) != 3) || (keyIndex >= Chip8::NumberOfKeys) || ((strcmp(actionName, "down") != 0) && (strcmp(actionName, "up") != 0))) {
+            Error(NullInterface::Tag, "%s:%u: expected <frame> <key> <down|up>.", filePath.c_str(), lineNumber);
+            isLoaded = false;
+            break;
+        }
+
+        keyEvent.keyIndex  = keyIndex;
+        keyEvent.isPressed = strcmp(actionName, "down") == 0;
+
+        if (!this->AddKeyEvent(keyEvent)) {
+            Error(NullInterface::Tag, "%s:%u: frames have to be in order.", filePath.c_str(), lineNumber);
+            isLoaded = false;
+        }
+    }
+
+    fclose(scriptFile);
+
+    if (isLoaded) {
+        Info(NullInterface::Tag, "%u key events loaded from %s.", static_cast<uint>(this->keyEvents.size()), filePath.c_str());
+    }
+
+    return isLoaded;
+}
+
+bool NullInterface::AddKeyEvent(const KeyEvent& keyEvent) {
+    if (!this->keyEvents.empty() && (keyEvent.frameNumber < this->keyEvents.back().frameNumber)) {
+        return false;
+    }
+
+    this->keyEvents.push_back(keyEvent);
+    return true;
+}
+
+// Statistics
+
+uint64 NullInterface::GetFrameCount(void) const {
+    return this->frameCount;
+}
+
+uint64 NullInterface::GetDirtyFrameCount(void) const {
+    return this->dirtyFrameCount;
+}
+
+uint64 NullInterface::GetAppliedKeyEvents(void) const {
+    return this->nextKeyEvent;
+}
@@ -0,0 +1,59 @@
+/*
+ * NullInterface.hxx
+ *
+ * This file is part of the Chip8++ source code.
+ * Copyright 2023 Patrick Melo <patrick@patrickmelo.com.br>
+ */
+
+#ifndef CHIP8_NULL_INTERFACE_H
+#define CHIP8_NULL_INTERFACE_H
+
+#include "Chip8.hxx"
+
+// Null Interface (headless, no SDL)
+
+class NullInterface : public Chip8::Interface {
+    public:
+        NullInterface(void);
+
+        // Types
+        struct KeyEvent {
+                uint64 frameNumber;    // Applied by the update that ends this frame (counted from 1)
+                uint8  keyIndex;
+                bool   isPressed;
+        };
+
+        // Constants
+        static constexpr charconst Tag = "NullInterface";
+
+        // General
+        bool Initialize(Chip8* chip8);
+        void Finalize(void);
+        void Update(const Chip8::DirtyRegion& dirtyRegion);
+
+        // Input (scripted key changes in frame order, so a headless run is repeatable)
+        bool LoadKeyScript(const string filePath);
+        bool AddKeyEvent(const KeyEvent& keyEvent);
+
+        // Statistics
+        uint64 GetFrameCount(void) const;
+        uint64 GetDirtyFrameCount(void) const;
+        uint64 GetAppliedKeyEvents(void) const;
+
+    private:
+        // General
+        bool isInitialized;
+
+        // Chip8
+        Chip8* chip8;
+
+        // Input
+        std::vector<KeyEvent> keyEvents;
+        uint                  nextKeyEvent;
+
+        // Statistics
+        uint64 frameCount;
+        uint64 dirtyFrameCount;
+};
+
+#endif    // CHIP8_NULL_INTERFACE_H
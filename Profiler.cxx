@@ -0,0 +1,168 @@
+/*
+ * Profiler.cxx
+ *
+ * This file is part of the Chip8++ source code.
+ * Copyright 2023 Patrick Melo <patrick@patrickmelo.com.br>
+ */
+
+#include "Profiler.hxx"
+#include "Chip8.hxx"
+
+#include <algorithm>
+
+// Constants
+
+static_assert(Chip8::NumberOfOperations <= Profiler::MaximumOperations, "Too many operations for the profiler counters.");
+
+static const charconst OperationNames[Chip8::NumberOfOperations] = {
+    "decode", "unknown", "00E0", "00EE", "00BN", "00CN", "00FB", "00FC", "00FD", "00FE", "00FF", "0010",
+    "0011", "01NN", "02NN", "03NN", "04NN", "05NN", "060N", "0700", "080N", "1NNN", "2NNN", "3XNN",
+    "4XNN", "5XY0", "6XNN", "7XNN", "8XY0", "8XY1", "8XY2", "8XY3", "8XY4", "8XY5", "8XY6", "8XY7",
+    "8XYE", "9XY0", "ANNN", "BNNN", "CXNN", "DXYN", "EX9E", "EXA1", "FX07", "FX0A", "FX15", "FX18",
+    "FX1E", "FX29", "FX30", "FX33", "FX55", "FX65", "FX75", "FX85", "1NNN idle"};
+
+// Profiler
+
+Profiler::Profiler(void) {
+    this->Reset();
+}
+
+// Counters
+
+void Profiler::Reset(void) {
+    memset(this->operationCounts, 0, sizeof(this->operationCounts));
+    memset(this->addressCounts, 0, sizeof(this->addressCounts));
+
+    this->retiredInstructions      = 0;
+    this->frameCount               = 0;
+    this->lastFrameInstructions    = 0;
+    this->minimumFrameInstructions = 0;
+    this->maximumFrameInstructions = 0;
+    this->executionCount           = 0;
+    this->timedInstructions        = 0;
+    this->cpuTicks                 = 0;
+    this->updateCount              = 0;
+    this->timedUpdates             = 0;
+    this->updateTicks              = 0;
+    this->clockOverhead            = UINT64(-1);
+
+    // What a back-to-back pair of clock reads costs is taken off every timed sample.
+
+    for (uint sampleIndex = 0; sampleIndex < Profiler::TimingInterval; ++sampleIndex) {
+        uint64 firstTicks = Profiler::ReadClock();
+        this->clockOverhead = std::min(this->clockOverhead, Profiler::ReadClock() - firstTicks);
+    }
+
+    this->startTicks = Profiler::ReadClock();
+    this->startTime  = Scheduler::Now();
+}
+
+void Profiler::RecordFrame(void) {
+    uint64 totalInstructions = this->retiredInstructions;
+    uint64 frameInstructions = totalInstructions - this->lastFrameInstructions;
+
+    if ((this->frameCount == 0) || (frameInstructions < this->minimumFrameInstructions)) {
+        this->minimumFrameInstructions = frameInstructions;
+    }
+
+    if (frameInstructions > this->maximumFrameInstructions) {
+        this->maximumFrameInstructions = frameInstructions;
+    }
+
+    this->lastFrameInstructions = totalInstructions;
+    this->frameCount++;
+}
+
+// Results
+
+uint64 Profiler::GetRetiredInstructions(void) const {
+    return this->retiredInstructions;
+}
+
+bool Profiler::WriteJson(const string filePath) const {
+    FILE* outputFile = fopen(filePath.c_str(), "w");
+
+    if (!outputFile) {
+        Error(Profiler::Tag, "Could not write %s.", filePath.c_str());
+        return false;
+    }
+
+    uint64 instructionCount = this->retiredInstructions;
+    uint64 elapsedTicks     = Profiler::ReadClock() - this->startTicks;
+    uint64 elapsedTime      = Scheduler::Now() - this->startTime;
+    double ticksPerNanosecond = elapsedTime > 0 ? static_cast<double>(elapsedTicks) / elapsedTime : 1.0;
+    double cpuTime    = this->timedInstructions > 0 ? (this->cpuTicks / ticksPerNanosecond) * instructionCount / this->timedInstructions : 0.0;
+    double updateTime = this->timedUpdates > 0 ? (this->updateTicks / ticksPerNanosecond) * this->updateCount / this->timedUpdates : 0.0;
+
+    fprintf(outputFile, "{\n");
+    fprintf(outputFile, "  \"instructions\": %" PRIu64 ",\n", instructionCount);
+    fprintf(outputFile, "  \"time_ns\": {\"cpu\": %.0f, \"update\": %.0f, \"wall\": %" PRIu64 ", \"sample_interval\": %u},\n", cpuTime, updateTime, elapsedTime, Profiler::TimingInterval);
+    fprintf(outputFile,
+            "  \"frames\": {\"count\": %" PRIu64 ", \"instructions\": {\"minimum\": %" PRIu64 ", \"mean\": %.2f, \"maximum\": %" PRIu64 "}},\n",
+            this->frameCount,
+            this->minimumFrameInstructions,
+            this->frameCount > 0 ? static_cast<double>(this->lastFrameInstructions) / this->frameCount : 0.0,
+            this->maximumFrameInstructions);
+
+    // Opcode classes (the leading nibble) and their subcases
+
+    uint64 classCounts[16];
+    memset(classCounts, 0, sizeof(classCounts));
+
+    for (uint operationIndex = Chip8::Operation00E0; operationIndex < Chip8::NumberOfOperations; ++operationIndex) {
+        classCounts[strtoul(string(OperationNames[operationIndex], 1).c_str(), NULL, 16)] += this->operationCounts[operationIndex];
+    }
+
+    fprintf(outputFile, "  \"classes\": {");
+
+    for (uint classIndex = 0; classIndex < 16; ++classIndex) {
+        fprintf(outputFile, "%s\"%X\": %" PRIu64, classIndex > 0 ? ", " : "", classIndex, classCounts[classIndex]);
+    }
+
+    fprintf(outputFile, "},\n  \"operations\": {");
+
+    for (uint operationIndex = Chip8::OperationUnknown; operationIndex < Chip8::NumberOfOperations; ++operationIndex) {
+        fprintf(outputFile, "%s\"%s\": %" PRIu64, operationIndex > Chip8::OperationUnknown ? ", " : "", OperationNames[operationIndex], this->operationCounts[operationIndex]);
+    }
+
+    // Hotspots first, then the whole histogram (only the addresses that ran)
+
+    std::vector<uint> hotAddresses;
+
+    for (uint address = 0; address < Profiler::AddressSpaceSize; ++address) {
+        if (this->addressCounts[address] > 0) {
+            hotAddresses.push_back(address);
+        }
+    }
+
+    std::vector<uint> sortedAddresses(hotAddresses);
+
+    std::stable_sort(sortedAddresses.begin(), sortedAddresses.end(), [this](uint leftAddress, uint rightAddress) {
+        return this->addressCounts[leftAddress] > this->addressCounts[rightAddress];
+    });
+
+    fprintf(outputFile, "},\n  \"hotspots\": [");
+
+    for (uint hotspotIndex = 0; (hotspotIndex < sortedAddresses.size()) && (hotspotIndex < Profiler::NumberOfHotspots); ++hotspotIndex) {
+        uint address = sortedAddresses[hotspotIndex];
+
+        fprintf(outputFile,
+                "%s{\"address\": \"0x%03X\", \"count\": %" PRIu64 ", \"share\": %.4f}",
+                hotspotIndex > 0 ? ", " : "",
+                address,
+                this->addressCounts[address],
+                instructionCount > 0 ? static_cast<double>(this->addressCounts[address]) / instructionCount : 0.0);
+    }
+
+    fprintf(outputFile, "],\n  \"pc_histogram\": {");
+
+    for (uint addressIndex = 0; addressIndex < hotAddresses.size(); ++addressIndex) {
+        fprintf(outputFile, "%s\"0x%03X\": %" PRIu64, addressIndex > 0 ? ", " : "", hotAddresses[addressIndex], this->addressCounts[hotAddresses[addressIndex]]);
+    }
+
+    fprintf(outputFile, "}\n}\n");
+    fclose(outputFile);
+
+    Info(Profiler::Tag, "%" PRIu64 " instructions profiled, written to %s.", instructionCount, filePath.c_str());
+    return true;
+}
@@ -0,0 +1,102 @@
+/*
+ * Profiler.hxx
+ *
+ * This file is part of the Chip8++ source code.
+ * Copyright 2023 Patrick Melo <patrick@patrickmelo.com.br>
+ */
+
+#ifndef CHIP8_PROFILER_H
+#define CHIP8_PROFILER_H
+
+#include "Core.hxx"
+#include "Scheduler.hxx"
+
+#if defined(__x86_64__) || defined(__i386__)
+    #include <x86intrin.h>
+#endif
+
+// Profiler (counters compiled in with CHIP8_PROFILE, dumped as JSON)
+
+class Profiler {
+    public:
+        Profiler(void);
+
+        // Constants
+        static constexpr charconst Tag               = "Profiler";
+        static constexpr uint      MaximumOperations = 64;
+        static constexpr uint      AddressSpaceSize  = 4096;
+        static constexpr uint      NumberOfHotspots  = 16;
+        static constexpr uint      TimingInterval    = 16;    // Only every 16th engine call and update reads the clock
+        static constexpr charconst DefaultOutputPath = "Chip8.profile.json";
+
+        // Clock (time stamp counter where there is one, a clock_gettime costs more than a few instructions)
+        static inline uint64 ReadClock(void) {
+#if defined(__x86_64__) || defined(__i386__)
+            return __rdtsc();
+#else
+            return Scheduler::Now();
+#endif
+        }
+
+        // Counters
+        void Reset(void);
+        void RecordFrame(void);
+
+        inline uint64 StartExecution(void) {
+            return (this->executionCount++ % Profiler::TimingInterval) == 0 ? Profiler::ReadClock() : 0;
+        }
+
+        inline void StopExecution(uint64 startTicks, uint64 retiredInstructions) {
+            this->retiredInstructions += retiredInstructions;
+
+            if (startTicks != 0) {
+                this->cpuTicks += Profiler::ReadClock() - startTicks - this->clockOverhead;
+                this->timedInstructions += retiredInstructions;
+            }
+        }
+
+        inline uint64 StartUpdate(void) {
+            return (this->updateCount++ % Profiler::TimingInterval) == 0 ? Profiler::ReadClock() : 0;
+        }
+
+        inline void StopUpdate(uint64 startTicks) {
+            if (startTicks != 0) {
+                this->updateTicks += Profiler::ReadClock() - startTicks - this->clockOverhead;
+                this->timedUpdates++;
+            }
+        }
+
+        inline void RecordInstruction(uint16 address, uint8 operation, uint64 instructionCount = 1) {
+            this->operationCounts[operation] += instructionCount;
+            this->addressCounts[address & (Profiler::AddressSpaceSize - 1)] += instructionCount;
+        }
+
+        // Results
+        uint64 GetRetiredInstructions(void) const;
+        bool   WriteJson(const string filePath) const;
+
+    private:
+        // Instructions
+        uint64 operationCounts[Profiler::MaximumOperations];
+        uint64 addressCounts[Profiler::AddressSpaceSize];
+        uint64 retiredInstructions;
+
+        // Frames
+        uint64 frameCount;
+        uint64 lastFrameInstructions;
+        uint64 minimumFrameInstructions;
+        uint64 maximumFrameInstructions;
+
+        // Time (sampled clock ticks, scaled up and converted against the monotonic clock when written)
+        uint64 executionCount;
+        uint64 timedInstructions;
+        uint64 cpuTicks;
+        uint64 updateCount;
+        uint64 timedUpdates;
+        uint64 updateTicks;
+        uint64 clockOverhead;    // Ticks a back-to-back pair of clock reads takes, taken off every timed sample
+        uint64 startTicks;
+        uint64 startTime;
+};
+
+#endif    // CHIP8_PROFILER_H
@@ -0,0 +1,788 @@
+/*
+ * Recompiler.cxx
+ *
+ * This file is part of the Chip8++ source code.
+ * Copyright 2023 Patrick Melo <patrick@patrickmelo.com.br>
+ */
+
+#include "Recompiler.hxx"
+
+#if defined(__x86_64__) && defined(__linux__)
+    #define CHIP8_RECOMPILER_SUPPORTED 1
+
+extern "C" {
+    #include <sys/mman.h>
+}
+#endif
+
+#ifdef CHIP8_RECOMPILER_SUPPORTED
+
+// Host Registers (x86-64 encoding)
+
+enum HostRegister {
+    RAX,
+    RCX,
+    RDX,
+    RBX,
+    RSP,
+    RBP,
+    RSI,
+    RDI,
+    R8,
+    R9,
+    R10,
+    R11,
+    R12,
+    R13,
+    R14,
+    R15
+};
+
+// RAX is the scratch register and RDI holds the Chip8 pointer for the whole block.
+static const uint8 AllocatableRegisters[] = {RCX, RDX, RSI, R8, R9, R10, R11, RBX, RBP, R12, R13, R14, R15};
+static const uint  NumberOfAllocatableRegisters = sizeof(AllocatableRegisters);
+
+static bool IsCalleeSaved(uint hostRegister) {
+    return (hostRegister == RBX) || (hostRegister == RBP) || (hostRegister >= R12);
+}
+
+// Code Emitter
+
+class CodeEmitter {
+    public:
+        CodeEmitter(uint8* codeBuffer, uint bufferSize) :
+            codeBuffer(codeBuffer),
+            bufferSize(bufferSize),
+            codeSize(0) {
+            // Empty
+        }
+
+        // Instruction groups (r/m32, r32 forms and /digit extensions)
+        static constexpr uint8 Add = 0x01, Or = 0x09, And = 0x21, Sub = 0x29, Xor = 0x31, Cmp = 0x39, Mov = 0x89;
+        static constexpr uint8 AddImmediate = 0, AndImmediate = 4, CmpImmediate = 7, ShiftLeft = 4, ShiftRight = 5;
+        static constexpr uint8 SetEqual = 0x94, SetNotEqual = 0x95, SetAboveOrEqual = 0x93;
+
+        uint GetSize(void) const {
+            return this->codeSize;
+        }
+
+        bool HasOverflowed(void) const {
+            return this->codeSize > this->bufferSize;
+        }
+
+        void Operation(uint8 opCode, uint destinationRegister, uint sourceRegister) {
+            this->Rex(sourceRegister, destinationRegister);
+            this->Byte(opCode);
+            this->Byte(0xC0 | ((sourceRegister & 7) << 3) | (destinationRegister & 7));
+        }
+
+        void OperationImmediate(uint8 extension, uint destinationRegister, uint32 immediateValue) {
+            this->Rex(0, destinationRegister);
+            this->Byte(0x81);
+            this->Byte(0xC0 | (extension << 3) | (destinationRegister & 7));
+            this->Dword(immediateValue);
+        }
+
+        void MoveImmediate(uint destinationRegister, uint32 immediateValue) {
+            this->Rex(0, destinationRegister);
+            this->Byte(0xB8 + (destinationRegister & 7));
+            this->Dword(immediateValue);
+        }
+
+        void Shift(uint8 extension, uint destinationRegister, uint8 shiftCount) {
+            this->Rex(0, destinationRegister);
+            this->Byte(0xC1);
+            this->Byte(0xC0 | (extension << 3) | (destinationRegister & 7));
+            this->Byte(shiftCount);
+        }
+
+        void MultiplyImmediate(uint destinationRegister, uint sourceRegister, uint8 immediateValue) {
+            this->Rex(destinationRegister, sourceRegister);
+            this->Byte(0x6B);
+            this->Byte(0xC0 | ((destinationRegister & 7) << 3) | (sourceRegister & 7));
+            this->Byte(immediateValue);
+        }
+
+        void LoadByte(uint destinationRegister, uint32 stateOffset) {
+            this->Rex(destinationRegister, RDI);
+            this->Byte(0x0F);
+            this->Byte(0xB6);
+            this->Byte(0x80 | ((destinationRegister & 7) << 3) | RDI);
+            this->Dword(stateOffset);
+        }
+
+        void LoadDword(uint destinationRegister, uint32 stateOffset) {
+            this->Rex(destinationRegister, RDI);
+            this->Byte(0x8B);
+            this->Byte(0x80 | ((destinationRegister & 7) << 3) | RDI);
+            this->Dword(stateOffset);
+        }
+
+        void StoreByte(uint32 stateOffset, uint sourceRegister) {
+            if (sourceRegister != RAX) {
+                this->Operation(Mov, RAX, sourceRegister);
+            }
+
+            this->Byte(0x88);
+            this->Byte(0x80 | RDI);
+            this->Dword(stateOffset);
+        }
+
+        void StoreWord(uint32 stateOffset, uint sourceRegister) {
+            if (sourceRegister != RAX) {
+                this->Operation(Mov, RAX, sourceRegister);
+            }
+
+            this->Byte(0x66);
+            this->Byte(0x89);
+            this->Byte(0x80 | RDI);
+            this->Dword(stateOffset);
+        }
+
+        void StoreDword(uint32 stateOffset, uint sourceRegister) {
+            this->Rex(sourceRegister, RDI);
+            this->Byte(0x89);
+            this->Byte(0x80 | ((sourceRegister & 7) << 3) | RDI);
+            this->Dword(stateOffset);
+        }
+
+        void StoreWordImmediate(uint32 stateOffset, uint16 immediateValue) {
+            this->Byte(0x66);
+            this->Byte(0xC7);
+            this->Byte(0x80 | RDI);
+            this->Dword(stateOffset);
+            this->Byte(immediateValue & 0xFF);
+            this->Byte(immediateValue >> 8);
+        }
+
+        void SetOnCondition(uint8 conditionCode) {
+            // setcc al (the caller clears eax first, with a mov that leaves the flags alone)
+            this->Byte(0x0F);
+            this->Byte(conditionCode);
+            this->Byte(0xC0);
+        }
+
+        void SkipAddress(uint32 baseAddress) {
+            // lea eax, [rax * 2 + baseAddress]
+            this->Byte(0x8D);
+            this->Byte(0x04);
+            this->Byte(0x45);
+            this->Dword(baseAddress);
+        }
+
+        void Push(uint hostRegister) {
+            this->Rex(0, hostRegister);
+            this->Byte(0x50 + (hostRegister & 7));
+        }
+
+        void Pop(uint hostRegister) {
+            this->Rex(0, hostRegister);
+            this->Byte(0x58 + (hostRegister & 7));
+        }
+
+        void Return(void) {
+            this->Byte(0xC3);
+        }
+
+    private:
+        uint8* codeBuffer;
+        uint   bufferSize;
+        uint   codeSize;
+
+        void Byte(uint8 byteValue) {
+            if (this->codeSize < this->bufferSize) {
+                this->codeBuffer[this->codeSize] = byteValue;
+            }
+
+            this->codeSize++;
+        }
+
+        void Dword(uint32 dwordValue) {
+            for (uint byteIndex = 0; byteIndex < 4; ++byteIndex) {
+                this->Byte((dwordValue >> (byteIndex * 8)) & 0xFF);
+            }
+        }
+
+        void Rex(uint registerField, uint rmField) {
+            uint8 rexPrefix = 0x40 | (((registerField >> 3) & 1) << 2) | ((rmField >> 3) & 1);
+
+            if (rexPrefix != 0x40) {
+                this->Byte(rexPrefix);
+            }
+        }
+};
+
+#endif    // CHIP8_RECOMPILER_SUPPORTED
+
+// Recompiler
+
+Chip8::Recompiler::Recompiler(Chip8* chip8) :
+    chip8(chip8),
+    codeCache(NULL),
+    codeCacheUsed(0),
+    compiledBlocks(0),
+    nativeInstructions(0),
+    interpretedInstructions(0) {
+    memset(this->blocks, 0, sizeof(this->blocks));
+    memset(this->blockCoverage, 0, sizeof(this->blockCoverage));
+    memset(this->invalidationCount, 0, sizeof(this->invalidationCount));
+}
+
+Chip8::Recompiler::~Recompiler() {
+#ifdef CHIP8_RECOMPILER_SUPPORTED
+    if (this->codeCache) {
+        munmap(this->codeCache, Recompiler::CodeCacheSize);
+    }
+#endif
+}
+
+// General
+
+bool Chip8::Recompiler::IsSupported(void) {
+#ifdef CHIP8_RECOMPILER_SUPPORTED
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool Chip8::Recompiler::Initialize(void) {
+#ifdef CHIP8_RECOMPILER_SUPPORTED
+    // The cache is only writable while a block is being copied into it (W^X).
+
+    void* mappedMemory = mmap(NULL, Recompiler::CodeCacheSize, PROT_READ | PROT_EXEC, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+    if (mappedMemory == MAP_FAILED) {
+        Error(Recompiler::Tag, "Could not map the code cache.");
+        return false;
+    }
+
+    this->codeCache = reinterpret_cast<uint8*>(mappedMemory);
+    this->Flush();
+    return true;
+#else
+    Error(Recompiler::Tag, "The recompiler is only available on x86-64 Linux.");
+    return false;
+#endif
+}
+
+// Execution
+
+uint64 Chip8::Recompiler::Execute(uint64 numberOfCycles) {
+    uint64 retiredInstructions = 0;
+
+    while (retiredInstructions < numberOfCycles) {
+        uint16 blockAddress = this->chip8->programCounter;
+
+        if (blockAddress < sizeof(Chip8::RAM)) {
+            Block& currentBlock = this->blocks[blockAddress];
+
+            if (currentBlock.state == Recompiler::Uncompiled) {
+                this->Compile(blockAddress);
+            }
+
+            // A block only runs if it fits in the budget, so frame boundaries land where the interpreter puts them.
+
+            if ((currentBlock.state == Recompiler::Compiled) && (currentBlock.instructionCount <= (numberOfCycles - retiredInstructions))) {
+#ifdef CHIP8_PROFILE
+                currentBlock.runCount++;
+#endif
+
+                currentBlock.code(this->chip8);
+                retiredInstructions += currentBlock.instructionCount;
+                this->nativeInstructions += currentBlock.instructionCount;
+                continue;
+            }
+        }
+
+        if (this->chip8->ExecutePredecoded(1) == 0) {
+            break;
+        }
+
+        retiredInstructions++;
+        this->interpretedInstructions++;
+    }
+
+    return retiredInstructions;
+}
+
+// Cache
+
+void Chip8::Recompiler::Invalidate(uint16 address, uint length) {
+    for (uint byteIndex = 0; byteIndex < length; ++byteIndex) {
+        uint16 writtenAddress = (address + byteIndex) & 0xFFF;
+
+        // Instructions left to the interpreter may become compilable after the write.
+
+        for (uint16 entryAddress = writtenAddress > 0 ? writtenAddress - 1 : 0; entryAddress <= writtenAddress; ++entryAddress) {
+            if ((this->blocks[entryAddress].state == Recompiler::Interpreted) && (this->invalidationCount[entryAddress] < Recompiler::MaximumInvalidations)) {
+                this->blocks[entryAddress].state = Recompiler::Uncompiled;
+            }
+        }
+
+        if (this->blockCoverage[writtenAddress] == 0) {
+            continue;
+        }
+
+        uint16 firstAddress = writtenAddress >= ((Recompiler::MaximumBlockInstructions * 2) - 1) ? writtenAddress - ((Recompiler::MaximumBlockInstructions * 2) - 1) : 0;
+
+        for (uint16 blockAddress = firstAddress; blockAddress <= writtenAddress; ++blockAddress) {
+            const Block& currentBlock = this->blocks[blockAddress];
+
+            if ((currentBlock.state == Recompiler::Compiled) && ((blockAddress + currentBlock.length) > writtenAddress)) {
+                this->Discard(blockAddress);
+            }
+        }
+    }
+}
+
+void Chip8::Recompiler::Flush(void) {
+#ifdef CHIP8_PROFILE
+    this->FlushProfile();
+#endif
+
+    this->codeCacheUsed = 0;
+
+    memset(this->blocks, 0, sizeof(this->blocks));
+    memset(this->blockCoverage, 0, sizeof(this->blockCoverage));
+    memset(this->invalidationCount, 0, sizeof(this->invalidationCount));
+}
+
+void Chip8::Recompiler::Discard(uint16 address) {
+    Block& discardedBlock = this->blocks[address];
+
+#ifdef CHIP8_PROFILE
+    this->ProfileBlock(address);
+#endif
+
+    for (uint byteIndex = 0; byteIndex < discardedBlock.length; ++byteIndex) {
+        this->blockCoverage[address + byteIndex]--;
+    }
+
+    discardedBlock.state = Recompiler::Uncompiled;
+
+    // Code that keeps rewriting itself is cheaper to interpret than to recompile.
+
+    if (++this->invalidationCount[address] >= Recompiler::MaximumInvalidations) {
+        discardedBlock.state = Recompiler::Interpreted;
+    }
+}
+
+#ifdef CHIP8_PROFILE
+
+// Profiling (native blocks skip Dispatch, so they count their runs and the instructions are attributed in bulk)
+
+void Chip8::Recompiler::FlushProfile(void) {
+    for (uint blockAddress = 0; blockAddress < sizeof(Chip8::RAM); ++blockAddress) {
+        if (this->blocks[blockAddress].state == Recompiler::Compiled) {
+            this->ProfileBlock(blockAddress);
+        }
+    }
+}
+
+void Chip8::Recompiler::ProfileBlock(uint16 address) {
+    Block& profiledBlock = this->blocks[address];
+
+    if (profiledBlock.runCount == 0) {
+        return;
+    }
+
+    for (uint instructionIndex = 0; instructionIndex < profiledBlock.instructionCount; ++instructionIndex) {
+        this->chip8->profiler.RecordInstruction(address + (instructionIndex * 2), profiledBlock.operations[instructionIndex], profiledBlock.runCount);
+    }
+
+    profiledBlock.runCount = 0;
+}
+
+#endif    // CHIP8_PROFILE
+
+bool Chip8::Recompiler::Compile(uint16 address) {
+    Block& newBlock = this->blocks[address];
+
+    newBlock.state = Recompiler::Interpreted;
+
+#ifdef CHIP8_RECOMPILER_SUPPORTED
+    // Scan: collect the supported instructions and give every guest register a host register.
+    // Guest registers 0x0-0xF are V0-VF, 0x10 is I.
+
+    static const uint AddressRegister = 0x10;
+
+    Instruction blockInstructions[Recompiler::MaximumBlockInstructions];
+    uint8       hostRegisters[17];
+    bool        isDirty[17];
+    uint        usedRegisters        = 0;
+    uint        numberOfInstructions = 0;
+    bool        hasTerminator        = false;
+    bool        isBlockEnd           = false;
+
+    memset(hostRegisters, 0xFF, sizeof(hostRegisters));
+    memset(isDirty, 0, sizeof(isDirty));
+
+    // The quirks that change what the native code does, for the profile the block is compiled for.
+
+    bool isShiftFromY   = false;
+    bool isLogicResetVF = false;
+
+    switch (this->chip8->quirkProfile) {
+        case Chip8::QuirksVIP: isShiftFromY = Quirks<Chip8::QuirksVIP>::ShiftUsesVY, isLogicResetVF = Quirks<Chip8::QuirksVIP>::LogicResetsVF; break;
+        case Chip8::QuirksCHIP48: isShiftFromY = Quirks<Chip8::QuirksCHIP48>::ShiftUsesVY, isLogicResetVF = Quirks<Chip8::QuirksCHIP48>::LogicResetsVF; break;
+        case Chip8::QuirksSCHIP: isShiftFromY = Quirks<Chip8::QuirksSCHIP>::ShiftUsesVY, isLogicResetVF = Quirks<Chip8::QuirksSCHIP>::LogicResetsVF; break;
+    }
+
+    for (uint16 instructionAddress = address; (numberOfInstructions < Recompiler::MaximumBlockInstructions) && !hasTerminator && !isBlockEnd && (instructionAddress < (sizeof(Chip8::RAM) - 1)); instructionAddress += 2) {
+        Instruction currentInstruction;
+        Chip8::Decode((this->chip8->ReadMemory(instructionAddress) << 8) | this->chip8->ReadMemory(instructionAddress + 1), currentInstruction);
+
+        uint readRegisters[2]    = {0xFF, 0xFF};
+        uint writtenRegisters[2] = {0xFF, 0xFF};
+
+        switch (currentInstruction.operation) {
+            case Chip8::Operation6XNN:
+            case Chip8::Operation7XNN:
+            case Chip8::OperationFX07: writtenRegisters[0] = currentInstruction.registerX; break;
+            case Chip8::Operation8XY0: writtenRegisters[0] = currentInstruction.registerX, readRegisters[0] = currentInstruction.registerY; break;
+            case Chip8::Operation8XY1:
+            case Chip8::Operation8XY2:
+            case Chip8::Operation8XY3: writtenRegisters[0] = currentInstruction.registerX, writtenRegisters[1] = isLogicResetVF ? 0xF : 0xFF, readRegisters[0] = currentInstruction.registerY; break;
+            case Chip8::Operation8XY4:
+            case Chip8::Operation8XY5:
+            case Chip8::Operation8XY7: writtenRegisters[0] = currentInstruction.registerX, writtenRegisters[1] = 0xF, readRegisters[0] = currentInstruction.registerY; break;
+            case Chip8::Operation8XY6:
+            case Chip8::Operation8XYE: writtenRegisters[0] = currentInstruction.registerX, writtenRegisters[1] = 0xF, readRegisters[0] = isShiftFromY ? currentInstruction.registerY : 0xFF; break;
+            case Chip8::OperationANNN: writtenRegisters[0] = AddressRegister; break;
+            case Chip8::OperationFX1E:
+            case Chip8::OperationFX29: writtenRegisters[0] = AddressRegister, readRegisters[0] = currentInstruction.registerX; break;
+            case Chip8::OperationFX15: readRegisters[0] = currentInstruction.registerX; break;
+            case Chip8::Operation1NNN: isBlockEnd = this->chip8->IsIdleLoop(instructionAddress, currentInstruction.address), hasTerminator = !isBlockEnd; break;
+            case Chip8::Operation3XNN:
+            case Chip8::Operation4XNN: readRegisters[0] = currentInstruction.registerX, hasTerminator = true; break;
+            case Chip8::Operation5XY0:
+            case Chip8::Operation9XY0: readRegisters[0] = currentInstruction.registerX, readRegisters[1] = currentInstruction.registerY, hasTerminator = true; break;
+            default: {
+                // Calls, returns, sprites, keys, memory transfers, random numbers and the sound timer (the audio sink is told
+                // as soon as it changes) stay in the interpreter, as do the jumps back of loops that may idle (above).
+                isBlockEnd = true;
+                break;
+            }
+        }
+
+        if (isBlockEnd) {
+            break;
+        }
+
+        // Make sure every register this instruction touches fits in the host register file.
+
+        uint newRegisters = 0;
+        uint touchedRegisters[4] = {readRegisters[0], readRegisters[1], writtenRegisters[0], writtenRegisters[1]};
+
+        for (uint touchedIndex = 0; touchedIndex < 4; ++touchedIndex) {
+            uint guestRegister = touchedRegisters[touchedIndex];
+
+            if ((guestRegister != 0xFF) && (hostRegisters[guestRegister] == 0xFF)) {
+                bool isRepeated = false;
+
+                for (uint previousIndex = 0; previousIndex < touchedIndex; ++previousIndex) {
+                    isRepeated |= touchedRegisters[previousIndex] == guestRegister;
+                }
+
+                newRegisters += !isRepeated;
+            }
+        }
+
+        if ((usedRegisters + newRegisters) > NumberOfAllocatableRegisters) {
+            hasTerminator = false;
+            isBlockEnd    = true;
+            break;
+        }
+
+        for (uint touchedIndex = 0; touchedIndex < 4; ++touchedIndex) {
+            uint guestRegister = touchedRegisters[touchedIndex];
+
+            if ((guestRegister != 0xFF) && (hostRegisters[guestRegister] == 0xFF)) {
+                hostRegisters[guestRegister] = AllocatableRegisters[usedRegisters++];
+            }
+        }
+
+        for (uint writtenIndex = 0; writtenIndex < 2; ++writtenIndex) {
+            if (writtenRegisters[writtenIndex] != 0xFF) {
+                isDirty[writtenRegisters[writtenIndex]] = true;
+            }
+        }
+
+        blockInstructions[numberOfInstructions++] = currentInstruction;
+    }
+
+    if (numberOfInstructions == 0) {
+        return false;
+    }
+
+    // Emit: prologue, body, write-back, next program counter, epilogue.
+
+    uint8       blockCode[Recompiler::MaximumBlockCodeSize];
+    CodeEmitter codeEmitter(blockCode, sizeof(blockCode));
+
+    const uint32 registersOffset = offsetof(Chip8, cpuRegisters);
+    const uint32 addressOffset   = offsetof(Chip8, addressRegister);
+    const uint32 counterOffset   = offsetof(Chip8, programCounter);
+    const uint32 delayOffset     = offsetof(Chip8, delayTimer);
+
+    for (uint registerIndex = 0; registerIndex < usedRegisters; ++registerIndex) {
+        if (IsCalleeSaved(AllocatableRegisters[registerIndex])) {
+            codeEmitter.Push(AllocatableRegisters[registerIndex]);
+        }
+    }
+
+    for (uint guestRegister = 0; guestRegister < 0x10; ++guestRegister) {
+        if (hostRegisters[guestRegister] != 0xFF) {
+            codeEmitter.LoadByte(hostRegisters[guestRegister], registersOffset + guestRegister);
+        }
+    }
+
+    if (hostRegisters[AddressRegister] != 0xFF) {
+        codeEmitter.LoadDword(hostRegisters[AddressRegister], addressOffset);
+    }
+
+    uint numberOfBodyInstructions = numberOfInstructions - (hasTerminator ? 1 : 0);
+
+    for (uint instructionIndex = 0; instructionIndex < numberOfBodyInstructions; ++instructionIndex) {
+        const Instruction& currentInstruction = blockInstructions[instructionIndex];
+
+        uint hostX = hostRegisters[currentInstruction.registerX];
+        uint hostY = hostRegisters[currentInstruction.registerY];
+        uint hostF = hostRegisters[0xF];
+        uint hostI = hostRegisters[AddressRegister];
+
+        switch (currentInstruction.operation) {
+            case Chip8::Operation6XNN: {
+                codeEmitter.MoveImmediate(hostX, currentInstruction.value);
+                break;
+            }
+
+            case Chip8::Operation7XNN: {
+                codeEmitter.OperationImmediate(CodeEmitter::AddImmediate, hostX, currentInstruction.value);
+                codeEmitter.OperationImmediate(CodeEmitter::AndImmediate, hostX, 0xFF);
+                break;
+            }
+
+            case Chip8::Operation8XY0: codeEmitter.Operation(CodeEmitter::Mov, hostX, hostY); break;
+            case Chip8::Operation8XY1:
+            case Chip8::Operation8XY2:
+            case Chip8::Operation8XY3: {
+                static const uint8 LogicOperations[3] = {CodeEmitter::Or, CodeEmitter::And, CodeEmitter::Xor};
+                codeEmitter.Operation(LogicOperations[currentInstruction.operation - Chip8::Operation8XY1], hostX, hostY);
+
+                if (isLogicResetVF) {
+                    codeEmitter.MoveImmediate(hostF, 0);
+                }
+
+                break;
+            }
+
+            case Chip8::Operation8XY4: {
+                // VF is written first, then VX += VY reads the updated registers, like the interpreter does.
+                codeEmitter.Operation(CodeEmitter::Mov, RAX, hostX);
+                codeEmitter.Operation(CodeEmitter::Add, RAX, hostY);
+                codeEmitter.Shift(CodeEmitter::ShiftRight, RAX, 8);
+                codeEmitter.Operation(CodeEmitter::Mov, hostF, RAX);
+                codeEmitter.Operation(CodeEmitter::Add, hostX, hostY);
+                codeEmitter.OperationImmediate(CodeEmitter::AndImmediate, hostX, 0xFF);
+                break;
+            }
+
+            case Chip8::Operation8XY5: {
+                codeEmitter.MoveImmediate(RAX, 0);
+                codeEmitter.Operation(CodeEmitter::Cmp, hostX, hostY);
+                codeEmitter.SetOnCondition(CodeEmitter::SetAboveOrEqual);
+                codeEmitter.Operation(CodeEmitter::Mov, hostF, RAX);
+                codeEmitter.Operation(CodeEmitter::Sub, hostX, hostY);
+                codeEmitter.OperationImmediate(CodeEmitter::AndImmediate, hostX, 0xFF);
+                break;
+            }
+
+            case Chip8::Operation8XY6: {
+                // VF is written before the source is read again, like the interpreter does.
+                uint hostSource = isShiftFromY ? hostY : hostX;
+
+                codeEmitter.Operation(CodeEmitter::Mov, RAX, hostSource);
+                codeEmitter.OperationImmediate(CodeEmitter::AndImmediate, RAX, 0x1);
+                codeEmitter.Operation(CodeEmitter::Mov, hostF, RAX);
+
+                if (hostSource != hostX) {
+                    codeEmitter.Operation(CodeEmitter::Mov, hostX, hostSource);
+                }
+
+                codeEmitter.Shift(CodeEmitter::ShiftRight, hostX, 1);
+                break;
+            }
+
+            case Chip8::Operation8XY7: {
+                codeEmitter.MoveImmediate(RAX, 0);
+                codeEmitter.Operation(CodeEmitter::Cmp, hostY, hostX);
+                codeEmitter.SetOnCondition(CodeEmitter::SetAboveOrEqual);
+                codeEmitter.Operation(CodeEmitter::Mov, hostF, RAX);
+                codeEmitter.Operation(CodeEmitter::Mov, RAX, hostY);
+                codeEmitter.Operation(CodeEmitter::Sub, RAX, hostX);
+                codeEmitter.OperationImmediate(CodeEmitter::AndImmediate, RAX, 0xFF);
+                codeEmitter.Operation(CodeEmitter::Mov, hostX, RAX);
+                break;
+            }
+
+            case Chip8::Operation8XYE: {
+                uint hostSource = isShiftFromY ? hostY : hostX;
+
+                codeEmitter.Operation(CodeEmitter::Mov, RAX, hostSource);
+                codeEmitter.Shift(CodeEmitter::ShiftRight, RAX, 7);
+                codeEmitter.Operation(CodeEmitter::Mov, hostF, RAX);
+
+                if (hostSource != hostX) {
+                    codeEmitter.Operation(CodeEmitter::Mov, hostX, hostSource);
+                }
+
+                codeEmitter.Shift(CodeEmitter::ShiftLeft, hostX, 1);
+                codeEmitter.OperationImmediate(CodeEmitter::AndImmediate, hostX, 0xFF);
+                break;
+            }
+
+            case Chip8::OperationANNN: {
+                codeEmitter.MoveImmediate(hostI, currentInstruction.address);
+                break;
+            }
+
+            case Chip8::OperationFX07: {
+                codeEmitter.LoadByte(hostX, delayOffset);
+                break;
+            }
+
+            case Chip8::OperationFX15: {
+                codeEmitter.StoreByte(delayOffset, hostX);
+                break;
+            }
+
+            case Chip8::OperationFX1E: {
+                codeEmitter.Operation(CodeEmitter::Add, hostI, hostX);
+                codeEmitter.OperationImmediate(CodeEmitter::AndImmediate, hostI, Chip8::AddressMask);
+                break;
+            }
+
+            case Chip8::OperationFX29: {
+                codeEmitter.MultiplyImmediate(hostI, hostX, 5);
+                codeEmitter.OperationImmediate(CodeEmitter::AddImmediate, hostI, Chip8::FontStartAddress);
+                break;
+            }
+        }
+    }
+
+    for (uint guestRegister = 0; guestRegister < 0x10; ++guestRegister) {
+        if (isDirty[guestRegister]) {
+            codeEmitter.StoreByte(registersOffset + guestRegister, hostRegisters[guestRegister]);
+        }
+    }
+
+    if (isDirty[AddressRegister]) {
+        codeEmitter.StoreDword(addressOffset, hostRegisters[AddressRegister]);
+    }
+
+    uint16 lastAddress = address + ((numberOfInstructions - 1) * 2);
+
+    if (!hasTerminator) {
+        codeEmitter.StoreWordImmediate(counterOffset, lastAddress + 2);
+    } else {
+        const Instruction& lastInstruction = blockInstructions[numberOfInstructions - 1];
+
+        uint hostX = hostRegisters[lastInstruction.registerX];
+        uint hostY = hostRegisters[lastInstruction.registerY];
+
+        switch (lastInstruction.operation) {
+            case Chip8::Operation1NNN: {
+                codeEmitter.StoreWordImmediate(counterOffset, lastInstruction.address);
+                break;
+            }
+
+            case Chip8::Operation3XNN:
+            case Chip8::Operation4XNN: {
+                codeEmitter.MoveImmediate(RAX, 0);
+                codeEmitter.OperationImmediate(CodeEmitter::CmpImmediate, hostX, lastInstruction.value);
+                codeEmitter.SetOnCondition(lastInstruction.operation == Chip8::Operation3XNN ? CodeEmitter::SetEqual : CodeEmitter::SetNotEqual);
+                codeEmitter.SkipAddress(lastAddress + 2);
+                codeEmitter.StoreWord(counterOffset, RAX);
+                break;
+            }
+
+            case Chip8::Operation5XY0:
+            case Chip8::Operation9XY0: {
+                codeEmitter.MoveImmediate(RAX, 0);
+                codeEmitter.Operation(CodeEmitter::Cmp, hostX, hostY);
+                codeEmitter.SetOnCondition(lastInstruction.operation == Chip8::Operation5XY0 ? CodeEmitter::SetEqual : CodeEmitter::SetNotEqual);
+                codeEmitter.SkipAddress(lastAddress + 2);
+                codeEmitter.StoreWord(counterOffset, RAX);
+                break;
+            }
+        }
+    }
+
+    for (uint registerIndex = usedRegisters; registerIndex > 0; --registerIndex) {
+        if (IsCalleeSaved(AllocatableRegisters[registerIndex - 1])) {
+            codeEmitter.Pop(AllocatableRegisters[registerIndex - 1]);
+        }
+    }
+
+    codeEmitter.Return();
+
+    if (codeEmitter.HasOverflowed()) {
+        Warning(Recompiler::Tag, "Block at $%03x does not fit in the code buffer.", address);
+        return false;
+    }
+
+    // Copy the block into the cache, starting over when it is full.
+
+    if ((this->codeCacheUsed + codeEmitter.GetSize()) > Recompiler::CodeCacheSize) {
+        this->Flush();
+    }
+
+    if (mprotect(this->codeCache, Recompiler::CodeCacheSize, PROT_READ | PROT_WRITE) != 0) {
+        Error(Recompiler::Tag, "Could not make the code cache writable.");
+        return false;
+    }
+
+    memcpy(this->codeCache + this->codeCacheUsed, blockCode, codeEmitter.GetSize());
+    mprotect(this->codeCache, Recompiler::CodeCacheSize, PROT_READ | PROT_EXEC);
+
+    newBlock.code             = reinterpret_cast<BlockCode>(this->codeCache + this->codeCacheUsed);
+    newBlock.length           = numberOfInstructions * 2;
+    newBlock.instructionCount = numberOfInstructions;
+    newBlock.state            = Recompiler::Compiled;
+
+#ifdef CHIP8_PROFILE
+    newBlock.runCount = 0;
+
+    for (uint instructionIndex = 0; instructionIndex < numberOfInstructions; ++instructionIndex) {
+        newBlock.operations[instructionIndex] = blockInstructions[instructionIndex].operation;
+    }
+#endif
+
+    this->codeCacheUsed += (codeEmitter.GetSize() + 15) & ~15;
+    this->compiledBlocks++;
+
+    for (uint byteIndex = 0; byteIndex < newBlock.length; ++byteIndex) {
+        this->blockCoverage[address + byteIndex]++;
+    }
+
+    return true;
+#else
+    return false;
+#endif    // CHIP8_RECOMPILER_SUPPORTED
+}
+
+// Statistics
+
+uint64 Chip8::Recompiler::GetCompiledBlocks(void) const {
+    return this->compiledBlocks;
+}
+
+uint64 Chip8::Recompiler::GetNativeInstructions(void) const {
+    return this->nativeInstructions;
+}
+
+uint64 Chip8::Recompiler::GetInterpretedInstructions(void) const {
+    return this->interpretedInstructions;
+}
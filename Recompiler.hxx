@@ -0,0 +1,92 @@
+/*
+ * Recompiler.hxx
+ *
+ * This file is part of the Chip8++ source code.
+ * Copyright 2023 Patrick Melo <patrick@patrickmelo.com.br>
+ */
+
+#ifndef CHIP8_RECOMPILER_H
+#define CHIP8_RECOMPILER_H
+
+#include "Chip8.hxx"
+
+// Recompiler (translates straight-line CHIP-8 blocks into x86-64 code)
+
+class Chip8::Recompiler {
+    public:
+        Recompiler(Chip8* chip8);
+        ~Recompiler();
+
+        // Constants
+        static constexpr charconst Tag                      = "Recompiler";
+        static constexpr uint      CodeCacheSize            = 1024 * 1024;
+        static constexpr uint      MaximumBlockInstructions = 32;
+        static constexpr uint      MaximumBlockCodeSize     = 4096;
+        static constexpr uint8     MaximumInvalidations     = 8;
+
+        // General
+        static bool IsSupported(void);
+        bool        Initialize(void);
+
+        // Execution
+        uint64 Execute(uint64 numberOfCycles);
+
+        // Cache
+        void Invalidate(uint16 address, uint length);
+        void Flush(void);
+
+#ifdef CHIP8_PROFILE
+        // Profiling
+        void FlushProfile(void);
+#endif
+
+        // Statistics
+        uint64 GetCompiledBlocks(void) const;
+        uint64 GetNativeInstructions(void) const;
+        uint64 GetInterpretedInstructions(void) const;
+
+    private:
+        // Types
+        typedef void (*BlockCode)(Chip8* chip8);
+
+        enum BlockState {
+            Uncompiled,
+            Compiled,
+            Interpreted    // Starts with an instruction the recompiler leaves to the interpreter
+        };
+
+        struct Block {
+                BlockCode code;
+                uint16    length;
+                uint16    instructionCount;
+                uint8     state;
+#ifdef CHIP8_PROFILE
+                uint64 runCount;    // Attributed to the profiler per instruction when the block goes away
+                uint8  operations[MaximumBlockInstructions];
+#endif
+        };
+
+        // Chip8
+        Chip8* chip8;
+
+        // Cache
+        uint8* codeCache;
+        uint   codeCacheUsed;
+        Block  blocks[sizeof(Chip8::RAM)];
+        uint8  blockCoverage[sizeof(Chip8::RAM)];
+        uint8  invalidationCount[sizeof(Chip8::RAM)];
+
+        bool Compile(uint16 address);
+        void Discard(uint16 address);
+
+#ifdef CHIP8_PROFILE
+        void ProfileBlock(uint16 address);
+#endif
+
+        // Statistics
+        uint64 compiledBlocks;
+        uint64 nativeInstructions;
+        uint64 interpretedInstructions;
+};
+
+#endif    // CHIP8_RECOMPILER_H
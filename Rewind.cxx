@@ -0,0 +1,361 @@
+/*
+ * Rewind.cxx
+ *
+ * This file is part of the Chip8++ source code.
+ * Copyright 2023 Patrick Melo <patrick@patrickmelo.com.br>
+ */
+
+#include "Rewind.hxx"
+
+// Constants
+
+static constexpr uint MinimumZeroRun = 4;         // Shorter runs of unchanged bytes are cheaper to keep as literals
+static constexpr uint MaximumRun     = 0xFFFF;    // Run lengths are stored as 16-bit values
+
+// Encoding Helpers
+
+static inline uint8 DeltaByte(const uint8* stateData, const uint8* referenceData, uint byteIndex) {
+    return referenceData ? stateData[byteIndex] ^ referenceData[byteIndex] : stateData[byteIndex];
+}
+
+// Rewind
+
+Rewind::Rewind(uint memoryLimit, uint keyframeInterval) :
+    isInitialized(false),
+    chip8(NULL),
+    memoryLimit(memoryLimit),
+    keyframeInterval(keyframeInterval > 0 ? keyframeInterval : 1),
+    frames(NULL),
+    frameCapacity(0),
+    firstFrame(0),
+    frameCount(0),
+    keyframeCount(0),
+    framesSinceKeyframe(0),
+    frameData(NULL),
+    dataCapacity(0),
+    dataTail(0),
+    dataUsed(0),
+    currentState(NULL),
+    previousState(NULL),
+    encodedState(NULL),
+    evictedFrames(0) {
+    // Empty
+}
+
+Rewind::~Rewind() {
+    this->Finalize();
+}
+
+// General
+
+bool Rewind::Initialize(Chip8* chip8) {
+    if (this->isInitialized) {
+        return false;
+    }
+
+    // Everything comes out of the memory limit: the frame index, the three working states and the encoded data.
+
+    uint encodedCapacity = (Chip8::StateSize * 2) + 8;
+    uint fixedSize;
+
+    this->frameCapacity = this->memoryLimit / Rewind::BytesPerFrame;
+    fixedSize           = (this->frameCapacity * sizeof(Frame)) + (Chip8::StateSize * 2) + encodedCapacity;
+
+    if ((this->frameCapacity < 2) || (this->memoryLimit < (fixedSize + encodedCapacity))) {
+        Error(Rewind::Tag, "A memory limit of %u bytes is too small.", this->memoryLimit);
+        return false;
+    }
+
+    this->dataCapacity  = this->memoryLimit - fixedSize;
+    this->frames        = new (std::nothrow) Frame[this->frameCapacity];
+    this->frameData     = new (std::nothrow) uint8[this->dataCapacity];
+    this->currentState  = new (std::nothrow) uint8[Chip8::StateSize];
+    this->previousState = new (std::nothrow) uint8[Chip8::StateSize];
+    this->encodedState  = new (std::nothrow) uint8[encodedCapacity];
+
+    if (!this->frames || !this->frameData || !this->currentState || !this->previousState || !this->encodedState) {
+        Error(Rewind::Tag, "Could not allocate the rewind buffers.");
+        this->isInitialized = true;
+        this->Finalize();
+        return false;
+    }
+
+    this->chip8 = chip8;
+    this->Clear();
+    this->chip8->SetRewind(this);
+
+    return this->isInitialized = true;
+}
+
+void Rewind::Finalize(void) {
+    if (!this->isInitialized) {
+        return;
+    }
+
+    if (this->chip8) {
+        this->chip8->SetRewind(NULL);
+    }
+
+    delete[] this->frames;
+    delete[] this->frameData;
+    delete[] this->currentState;
+    delete[] this->previousState;
+    delete[] this->encodedState;
+
+    this->frames        = NULL;
+    this->frameData     = NULL;
+    this->currentState  = NULL;
+    this->previousState = NULL;
+    this->encodedState  = NULL;
+    this->chip8         = NULL;
+    this->isInitialized = false;
+}
+
+void Rewind::Clear(void) {
+    this->firstFrame          = 0;
+    this->frameCount          = 0;
+    this->keyframeCount       = 0;
+    this->framesSinceKeyframe = 0;
+    this->dataTail            = 0;
+    this->dataUsed            = 0;
+}
+
+// Recording
+
+void Rewind::Capture(void) {
+    // Machines without a fixed-size state (MEGA-CHIP mode, larger memories) are not recorded.
+
+    if (!this->isInitialized || (this->chip8->SaveState(this->currentState, Chip8::StateSize) == 0)) {
+        return;
+    }
+
+    bool   isKeyframe = (this->frameCount == 0) || ((this->framesSinceKeyframe + 1) >= this->keyframeInterval);
+    uint   encodedSize;
+    uint8* frameAddress;
+
+    for (;;) {
+        encodedSize = this->Encode(this->currentState, isKeyframe ? NULL : this->previousState, this->encodedState);
+
+        if (encodedSize > this->dataCapacity) {
+            Warning(Rewind::Tag, "A %u bytes frame does not fit in the rewind buffer.", encodedSize);
+            this->Clear();
+            return;
+        }
+
+        frameAddress = this->Reserve(encodedSize);
+
+        // Making room may have evicted the keyframe this delta depends on.
+
+        if (isKeyframe || (this->frameCount > 0)) {
+            break;
+        }
+
+        isKeyframe = true;
+    }
+
+    memcpy(frameAddress, this->encodedState, encodedSize);
+
+    Frame& newFrame = this->frames[(this->firstFrame + this->frameCount) % this->frameCapacity];
+
+    newFrame.offset     = frameAddress - this->frameData;
+    newFrame.size       = encodedSize;
+    newFrame.isKeyframe = isKeyframe;
+
+    this->frameCount++;
+    this->keyframeCount += isKeyframe;
+    this->framesSinceKeyframe = isKeyframe ? 0 : this->framesSinceKeyframe + 1;
+    this->dataTail            = newFrame.offset + encodedSize;
+    this->dataUsed += encodedSize;
+
+    uint8* swapState    = this->previousState;
+    this->previousState = this->currentState;
+    this->currentState  = swapState;
+}
+
+uint Rewind::StepBack(uint numberOfFrames) {
+    if (!this->isInitialized || (this->frameCount == 0)) {
+        return 0;
+    }
+
+    // The newest frame is the state at the last frame boundary, so stepping back zero frames restores it.
+
+    if (numberOfFrames > (this->frameCount - 1)) {
+        numberOfFrames = this->frameCount - 1;
+    }
+
+    uint targetFrame   = this->frameCount - 1 - numberOfFrames;
+    uint keyframeIndex = targetFrame;
+
+    while (!this->GetFrame(keyframeIndex).isKeyframe) {
+        keyframeIndex--;
+    }
+
+    memset(this->currentState, 0, Chip8::StateSize);
+
+    for (uint frameIndex = keyframeIndex; frameIndex <= targetFrame; ++frameIndex) {
+        const Frame& currentFrame = this->GetFrame(frameIndex);
+        this->Decode(this->frameData + currentFrame.offset, currentFrame.size, this->currentState);
+    }
+
+    if (!this->chip8->LoadState(this->currentState, Chip8::StateSize)) {
+        return 0;
+    }
+
+    // Drop the frames after the target, recording continues from there.
+
+    for (uint frameIndex = targetFrame + 1; frameIndex < this->frameCount; ++frameIndex) {
+        const Frame& droppedFrame = this->GetFrame(frameIndex);
+
+        this->dataUsed -= droppedFrame.size;
+        this->keyframeCount -= droppedFrame.isKeyframe;
+    }
+
+    const Frame& targetFrameInfo = this->GetFrame(targetFrame);
+
+    this->frameCount          = targetFrame + 1;
+    this->framesSinceKeyframe = targetFrame - keyframeIndex;
+    this->dataTail            = targetFrameInfo.offset + targetFrameInfo.size;
+
+    memcpy(this->previousState, this->currentState, Chip8::StateSize);
+    return numberOfFrames;
+}
+
+// Encoding
+
+uint Rewind::Encode(const uint8* stateData, const uint8* referenceData, uint8* encodedData) const {
+    // A sequence of (zero run, literal length, literal bytes) over the XOR of the state and its reference.
+    // Keyframes have no reference and are encoded against zeros, which still packs the empty RAM.
+
+    uint8* encodedCursor = encodedData;
+    uint   byteIndex     = 0;
+
+    while (byteIndex < Chip8::StateSize) {
+        uint16 zeroRun = 0;
+
+        while ((byteIndex < Chip8::StateSize) && (zeroRun < MaximumRun) && (DeltaByte(stateData, referenceData, byteIndex) == 0)) {
+            zeroRun++;
+            byteIndex++;
+        }
+
+        uint   literalStart  = byteIndex;
+        uint16 literalLength = 0;
+
+        while ((byteIndex < Chip8::StateSize) && (literalLength < MaximumRun)) {
+            uint zeroCount = 0;
+
+            while (((byteIndex + zeroCount) < Chip8::StateSize) && (zeroCount < MinimumZeroRun) && (DeltaByte(stateData, referenceData, byteIndex + zeroCount) == 0)) {
+                zeroCount++;
+            }
+
+            if ((zeroCount == MinimumZeroRun) || ((byteIndex + zeroCount) == Chip8::StateSize)) {
+                break;
+            }
+
+            literalLength++;
+            byteIndex++;
+        }
+
+        // Trailing unchanged bytes need no token.
+
+        if (literalLength == 0) {
+            break;
+        }
+
+        memcpy(encodedCursor, &zeroRun, sizeof(zeroRun));
+        memcpy(encodedCursor + sizeof(zeroRun), &literalLength, sizeof(literalLength));
+        encodedCursor += sizeof(zeroRun) + sizeof(literalLength);
+
+        for (uint literalIndex = 0; literalIndex < literalLength; ++literalIndex) {
+            *encodedCursor++ = DeltaByte(stateData, referenceData, literalStart + literalIndex);
+        }
+    }
+
+    return encodedCursor - encodedData;
+}
+
+void Rewind::Decode(const uint8* encodedData, uint encodedSize, uint8* stateData) const {
+    const uint8* encodedCursor = encodedData;
+    const uint8* encodedEnd    = encodedData + encodedSize;
+    uint         byteIndex     = 0;
+
+    while (encodedCursor < encodedEnd) {
+        uint16 zeroRun;
+        uint16 literalLength;
+
+        memcpy(&zeroRun, encodedCursor, sizeof(zeroRun));
+        memcpy(&literalLength, encodedCursor + sizeof(zeroRun), sizeof(literalLength));
+        encodedCursor += sizeof(zeroRun) + sizeof(literalLength);
+        byteIndex += zeroRun;
+
+        for (uint literalIndex = 0; literalIndex < literalLength; ++literalIndex) {
+            stateData[byteIndex++] ^= *encodedCursor++;
+        }
+    }
+}
+
+// Storage
+
+uint8* Rewind::Reserve(uint dataSize) {
+    if (this->frameCount == this->frameCapacity) {
+        this->EvictOldest();
+    }
+
+    if (this->frameCount == 0) {
+        this->dataTail = 0;
+    }
+
+    uint dataOffset = this->dataTail;
+
+    // Frames are never split across the end of the ring. When wrapping, the frames between the tail and the end are the
+    // oldest ones and go first.
+
+    if ((dataOffset + dataSize) > this->dataCapacity) {
+        while ((this->frameCount > 0) && (this->GetFrame(0).offset >= this->dataTail)) {
+            this->EvictOldest();
+        }
+
+        dataOffset = 0;
+    }
+
+    while ((this->frameCount > 0) && (this->GetFrame(0).offset >= dataOffset) && (this->GetFrame(0).offset < (dataOffset + dataSize))) {
+        this->EvictOldest();
+    }
+
+    return this->frameData + dataOffset;
+}
+
+void Rewind::EvictOldest(void) {
+    // Deltas are useless without their keyframe, so a whole group leaves at once.
+
+    do {
+        const Frame& oldestFrame = this->GetFrame(0);
+
+        this->dataUsed -= oldestFrame.size;
+        this->keyframeCount -= oldestFrame.isKeyframe;
+        this->firstFrame = (this->firstFrame + 1) % this->frameCapacity;
+        this->frameCount--;
+        this->evictedFrames++;
+    } while ((this->frameCount > 0) && !this->GetFrame(0).isKeyframe);
+}
+
+Rewind::Frame& Rewind::GetFrame(uint frameIndex) const {
+    return this->frames[(this->firstFrame + frameIndex) % this->frameCapacity];
+}
+
+// Statistics
+
+uint Rewind::GetFrameCount(void) const {
+    return this->frameCount;
+}
+
+uint Rewind::GetKeyframeCount(void) const {
+    return this->keyframeCount;
+}
+
+uint Rewind::GetMemoryUsage(void) const {
+    return this->dataUsed + (this->frameCount * sizeof(Frame));
+}
+
+uint64 Rewind::GetEvictedFrames(void) const {
+    return this->evictedFrames;
+}
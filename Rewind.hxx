@@ -0,0 +1,88 @@
+/*
+ * Rewind.hxx
+ *
+ * This file is part of the Chip8++ source code.
+ * Copyright 2023 Patrick Melo <patrick@patrickmelo.com.br>
+ */
+
+#ifndef CHIP8_REWIND_H
+#define CHIP8_REWIND_H
+
+#include "Chip8.hxx"
+
+// Rewind (per-frame machine states kept as keyframes and XOR/RLE deltas in a bounded ring)
+
+class Rewind {
+    public:
+        Rewind(uint memoryLimit = Rewind::DefaultMemoryLimit, uint keyframeInterval = Rewind::DefaultKeyframeInterval);
+        ~Rewind();
+
+        // Constants
+        static constexpr charconst Tag                     = "Rewind";
+        static constexpr uint      DefaultMemoryLimit      = 1024 * 1024;
+        static constexpr uint      DefaultKeyframeInterval = 60;     // Frames
+        static constexpr uint      BytesPerFrame           = 256;    // Sizes the frame index, a quiet frame takes a few bytes
+
+        // General
+        bool Initialize(Chip8* chip8);
+        void Finalize(void);
+        void Clear(void);
+
+        // Recording
+        void Capture(void);
+        uint StepBack(uint numberOfFrames);
+
+        // Statistics
+        uint   GetFrameCount(void) const;
+        uint   GetKeyframeCount(void) const;
+        uint   GetMemoryUsage(void) const;
+        uint64 GetEvictedFrames(void) const;
+
+    private:
+        // Types
+        struct Frame {
+                uint32 offset;
+                uint32 size;
+                bool   isKeyframe;
+        };
+
+        // General
+        bool isInitialized;
+
+        // Chip8
+        Chip8* chip8;
+
+        // Configuration
+        uint memoryLimit;
+        uint keyframeInterval;
+
+        // Frames (a ring of descriptors over a ring of encoded bytes)
+        Frame* frames;
+        uint   frameCapacity;
+        uint   firstFrame;
+        uint   frameCount;
+        uint   keyframeCount;
+        uint   framesSinceKeyframe;
+
+        // Data
+        uint8* frameData;
+        uint   dataCapacity;
+        uint   dataTail;
+        uint   dataUsed;
+
+        // States
+        uint8* currentState;
+        uint8* previousState;
+        uint8* encodedState;
+
+        uint   Encode(const uint8* stateData, const uint8* referenceData, uint8* encodedData) const;
+        void   Decode(const uint8* encodedData, uint encodedSize, uint8* stateData) const;
+        uint8* Reserve(uint dataSize);
+        void   EvictOldest(void);
+        Frame& GetFrame(uint frameIndex) const;
+
+        // Statistics
+        uint64 evictedFrames;
+};
+
+#endif    // CHIP8_REWIND_H
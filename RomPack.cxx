@@ -0,0 +1,207 @@
+/*
+ * RomPack.cxx
+ *
+ * This file is part of the Chip8++ source code.
+ * Copyright 2023 Patrick Melo <patrick@patrickmelo.com.br>
+ */
+
+#include "RomPack.hxx"
+
+#include <algorithm>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static_assert(sizeof(RomPack::Header) == 32, "ROM pack headers are expected to be 32 bytes.");
+static_assert(sizeof(RomPack::Entry) == 24, "ROM pack entries are expected to be 24 bytes.");
+
+// ROM Pack
+
+RomPack::RomPack(void) :
+    packData(NULL),
+    packSize(0),
+    packHeader(NULL),
+    entries(NULL),
+    nameIndex(NULL),
+    names(NULL) {
+    // Empty
+}
+
+RomPack::~RomPack() {
+    this->Close();
+}
+
+// General
+
+bool RomPack::Open(const string filePath) {
+    this->Close();
+
+    int packFile = open(filePath.c_str(), O_RDONLY);
+
+    if (packFile < 0) {
+        Error(RomPack::Tag, "Could not open %s.", filePath.c_str());
+        return false;
+    }
+
+    struct stat fileStatus;
+
+    if ((fstat(packFile, &fileStatus) != 0) || (fileStatus.st_size < static_cast<off_t>(sizeof(Header))) || (fileStatus.st_size > 0xFFFFFFFF)) {
+        Error(RomPack::Tag, "%s is not a ROM pack.", filePath.c_str());
+        close(packFile);
+        return false;
+    }
+
+    // The mapping outlives the descriptor.
+
+    void* mappedData = mmap(NULL, fileStatus.st_size, PROT_READ, MAP_SHARED, packFile, 0);
+    close(packFile);
+
+    if (mappedData == MAP_FAILED) {
+        Error(RomPack::Tag, "Could not map %s.", filePath.c_str());
+        return false;
+    }
+
+    this->packData   = static_cast<const uint8*>(mappedData);
+    this->packSize   = fileStatus.st_size;
+    this->packHeader = reinterpret_cast<const Header*>(this->packData);
+
+    if (!this->Validate()) {
+        Error(RomPack::Tag, "%s is not a valid ROM pack.", filePath.c_str());
+        this->Close();
+        return false;
+    }
+
+    this->entries   = reinterpret_cast<const Entry*>(this->packData + this->packHeader->entriesOffset);
+    this->nameIndex = reinterpret_cast<const uint32*>(this->packData + this->packHeader->nameIndexOffset);
+    this->names     = reinterpret_cast<charconst>(this->packData + this->packHeader->namesOffset);
+
+    Info(RomPack::Tag, "%u ROMs in %s.", this->packHeader->numberOfRoms, filePath.c_str());
+    return true;
+}
+
+void RomPack::Close(void) {
+    if (!this->packData) {
+        return;
+    }
+
+    munmap(const_cast<uint8*>(this->packData), this->packSize);
+
+    this->packData   = NULL;
+    this->packSize   = 0;
+    this->packHeader = NULL;
+    this->entries    = NULL;
+    this->nameIndex  = NULL;
+    this->names      = NULL;
+}
+
+bool RomPack::Validate(void) const {
+    // Everything a lookup or a load reads is checked once here: the tables and every ROM lie inside the file, the names
+    // are terminated and both indices are sorted. Offsets are widened so that a corrupted pack cannot overflow them.
+
+    const Header& packHeader = *this->packHeader;
+
+    if ((packHeader.magic != RomPack::PackMagic) || (packHeader.version != RomPack::PackVersion) || (packHeader.entrySize != sizeof(Entry)) || (packHeader.fileSize != this->packSize)) {
+        return false;
+    }
+
+    uint64 numberOfRoms = packHeader.numberOfRoms;
+
+    if (((packHeader.entriesOffset % alignof(Entry)) != 0) || ((UINT64(packHeader.entriesOffset) + (numberOfRoms * sizeof(Entry))) > this->packSize)) {
+        return false;
+    }
+
+    if (((packHeader.nameIndexOffset % alignof(uint32)) != 0) || ((UINT64(packHeader.nameIndexOffset) + (numberOfRoms * sizeof(uint32))) > this->packSize)) {
+        return false;
+    }
+
+    if ((packHeader.namesSize == 0) || ((UINT64(packHeader.namesOffset) + packHeader.namesSize) > this->packSize) || (this->packData[packHeader.namesOffset + packHeader.namesSize - 1] != 0)) {
+        return false;
+    }
+
+    const Entry*  packEntries = reinterpret_cast<const Entry*>(this->packData + packHeader.entriesOffset);
+    const uint32* packIndex   = reinterpret_cast<const uint32*>(this->packData + packHeader.nameIndexOffset);
+    charconst     packNames   = reinterpret_cast<charconst>(this->packData + packHeader.namesOffset);
+
+    for (uint romIndex = 0; romIndex < numberOfRoms; ++romIndex) {
+        const Entry& romEntry = packEntries[romIndex];
+
+        if (((UINT64(romEntry.dataOffset) + romEntry.dataSize) > this->packSize) || (romEntry.nameOffset >= packHeader.namesSize) || (romEntry.quirkProfile > Chip8::QuirksSCHIP)) {
+            return false;
+        }
+
+        if ((romIndex > 0) && (packEntries[romIndex - 1].contentHash > romEntry.contentHash)) {
+            return false;
+        }
+
+        if ((packIndex[romIndex] >= numberOfRoms) || ((romIndex > 0) && (strcmp(packNames + packEntries[packIndex[romIndex - 1]].nameOffset, packNames + packEntries[packIndex[romIndex]].nameOffset) > 0))) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// Index
+
+uint RomPack::GetRomCount(void) const {
+    return this->packHeader ? this->packHeader->numberOfRoms : 0;
+}
+
+const RomPack::Entry* RomPack::GetEntry(uint romIndex) const {
+    return romIndex < this->GetRomCount() ? &this->entries[romIndex] : NULL;
+}
+
+const RomPack::Entry* RomPack::FindByHash(uint64 contentHash) const {
+    const Entry* firstEntry = this->entries;
+    const Entry* lastEntry  = this->entries + this->GetRomCount();
+    const Entry* foundEntry = std::lower_bound(firstEntry, lastEntry, contentHash, [](const Entry& romEntry, uint64 contentHash) {
+        return romEntry.contentHash < contentHash;
+    });
+
+    return ((foundEntry != lastEntry) && (foundEntry->contentHash == contentHash)) ? foundEntry : NULL;
+}
+
+const RomPack::Entry* RomPack::FindByName(charconst romName) const {
+    const uint32* firstIndex = this->nameIndex;
+    const uint32* lastIndex  = this->nameIndex + this->GetRomCount();
+    const uint32* foundIndex = std::lower_bound(firstIndex, lastIndex, romName, [this](uint32 romIndex, charconst romName) {
+        return strcmp(this->names + this->entries[romIndex].nameOffset, romName) < 0;
+    });
+
+    return ((foundIndex != lastIndex) && (strcmp(this->names + this->entries[*foundIndex].nameOffset, romName) == 0)) ? &this->entries[*foundIndex] : NULL;
+}
+
+charconst RomPack::GetName(const Entry& romEntry) const {
+    return this->names + romEntry.nameOffset;
+}
+
+// Loading
+
+bool RomPack::LoadProgram(const Entry& romEntry, Chip8::RAM& programMemory) const {
+    return this->LoadProgram(romEntry, programMemory, sizeof(Chip8::RAM));
+}
+
+bool RomPack::LoadProgram(const Entry& romEntry, uint8* programMemory, uint32 memorySize) const {
+    if ((romEntry.dataSize == 0) || (romEntry.dataSize > (memorySize - Chip8::ProgramStartAddress))) {
+        Error(RomPack::Tag, "%s does not fit in %u bytes of memory.", this->GetName(romEntry), memorySize);
+        return false;
+    }
+
+    memcpy(&programMemory[Chip8::ProgramStartAddress], this->packData + romEntry.dataOffset, romEntry.dataSize);
+    Chip8::LoadFonts(programMemory);
+    return true;
+}
+
+// Hashing
+
+uint64 RomPack::Hash(const uint8* romData, uint32 romSize) {
+    uint64 hashValue = UINT64(0xCBF29CE484222325);
+
+    for (uint32 byteIndex = 0; byteIndex < romSize; ++byteIndex) {
+        hashValue = (hashValue ^ romData[byteIndex]) * UINT64(0x100000001B3);
+    }
+
+    return hashValue;
+}
@@ -0,0 +1,83 @@
+/*
+ * RomPack.hxx
+ *
+ * This file is part of the Chip8++ source code.
+ * Copyright 2023 Patrick Melo <patrick@patrickmelo.com.br>
+ */
+
+#ifndef CHIP8_ROM_PACK_H
+#define CHIP8_ROM_PACK_H
+
+#include "Chip8.hxx"
+
+// ROM Pack (many programs in one memory-mapped file, indexed by content hash and by name)
+//
+// Layout: the header, the entries sorted by content hash, the entry indices sorted by name, the names (NUL-terminated)
+// and the ROM images, each aligned to DataAlignment. Everything is little-endian and 32-bit offsets are from the start of
+// the file.
+
+class RomPack {
+    public:
+        RomPack(void);
+        ~RomPack();
+
+        // Types
+        struct Header {
+                uint32 magic;
+                uint16 version;
+                uint16 entrySize;
+                uint32 numberOfRoms;
+                uint32 entriesOffset;
+                uint32 nameIndexOffset;
+                uint32 namesOffset;
+                uint32 namesSize;
+                uint32 fileSize;
+        };
+
+        struct Entry {
+                uint64 contentHash;             // RomPack::Hash of the image
+                uint32 dataOffset;
+                uint32 dataSize;
+                uint32 nameOffset;              // From the start of the names
+                uint8  quirkProfile;            // Chip8::QuirkProfile
+                uint8  flags;                   // Reserved, zero
+                uint16 instructionsPerFrame;    // Recommended speed, zero for the machine default
+        };
+
+        // Constants
+        static constexpr charconst Tag           = "RomPack";
+        static constexpr uint32    PackMagic     = 0x50523843;    // "C8RP"
+        static constexpr uint16    PackVersion   = 1;
+        static constexpr uint      DataAlignment = 16;
+
+        // General
+        bool Open(const string filePath);
+        void Close(void);
+
+        // Index (binary searches over the mapping, nothing is copied)
+        uint         GetRomCount(void) const;
+        const Entry* GetEntry(uint romIndex) const;
+        const Entry* FindByHash(uint64 contentHash) const;
+        const Entry* FindByName(charconst romName) const;
+        charconst    GetName(const Entry& romEntry) const;
+
+        // Loading (the image goes straight from the mapping into the machine memory, the fonts are added)
+        bool LoadProgram(const Entry& romEntry, Chip8::RAM& programMemory) const;
+        bool LoadProgram(const Entry& romEntry, uint8* programMemory, uint32 memorySize) const;
+
+        // Hashing (64-bit FNV-1a)
+        static uint64 Hash(const uint8* romData, uint32 romSize);
+
+    private:
+        // Mapping
+        const uint8*  packData;
+        uint32        packSize;
+        const Header* packHeader;
+        const Entry*  entries;
+        const uint32* nameIndex;
+        charconst     names;
+
+        bool Validate(void) const;
+};
+
+#endif    // CHIP8_ROM_PACK_H
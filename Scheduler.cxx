@@ -0,0 +1,320 @@
+/*
+ * Scheduler.cxx
+ *
+ * This file is part of the Chip8++ source code.
+ * Copyright 2023 Patrick Melo <patrick@patrickmelo.com.br>
+ */
+
+#include "Scheduler.hxx"
+
+// Scheduler
+
+Scheduler::Scheduler(void) :
+    framesPerSecond(60),
+    startTime(0),
+    frameNumber(0),
+    missedDeadlines(0) {
+    // Empty
+}
+
+// Clock
+
+uint64 Scheduler::Now(void) {
+    timespec currentTime;
+    clock_gettime(CLOCK_MONOTONIC, &currentTime);
+
+    return (currentTime.tv_sec * Scheduler::NanosecondsPerSecond) + currentTime.tv_nsec;
+}
+
+// Frames
+
+void Scheduler::Start(uint framesPerSecond) {
+    this->framesPerSecond = framesPerSecond > 0 ? framesPerSecond : 60;
+    this->startTime       = Scheduler::Now();
+    this->frameNumber     = 0;
+    this->missedDeadlines = 0;
+}
+
+bool Scheduler::WaitForNextFrame(void) {
+    // Deadlines are computed from the start time, so rounding never accumulates into drift.
+
+    uint64 frameDeadline = this->DeadlineOf(++this->frameNumber);
+    uint64 currentTime   = Scheduler::Now();
+
+    if (currentTime >= frameDeadline) {
+        this->missedDeadlines++;
+
+        // Too far behind (stalled or suspended): restart the timeline instead of bursting to catch up.
+
+        if ((currentTime - frameDeadline) > (this->GetFramePeriod() * Scheduler::MaximumLateFrames)) {
+            this->startTime   = currentTime;
+            this->frameNumber = 0;
+        }
+
+        return false;
+    }
+
+    timespec sleepUntil;
+    sleepUntil.tv_sec  = frameDeadline / Scheduler::NanosecondsPerSecond;
+    sleepUntil.tv_nsec = frameDeadline % Scheduler::NanosecondsPerSecond;
+
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &sleepUntil, NULL) == EINTR) {
+        // Interrupted by a signal, sleep again until the same deadline.
+    }
+
+    return true;
+}
+
+void Scheduler::CompleteFrame(void) {
+    // The caller already waited for the deadline on something else (with the deadline as the timeout).
+
+    this->frameNumber++;
+}
+
+void Scheduler::Synchronize(void) {
+    // The frame was paced by something else (the display): the deadlines that follow count from now.
+
+    this->startTime   = Scheduler::Now();
+    this->frameNumber = 0;
+}
+
+uint64 Scheduler::GetNextDeadline(void) const {
+    return this->DeadlineOf(this->frameNumber + 1);
+}
+
+uint64 Scheduler::GetFramePeriod(void) const {
+    return Scheduler::NanosecondsPerSecond / this->framesPerSecond;
+}
+
+uint64 Scheduler::GetMissedDeadlines(void) const {
+    return this->missedDeadlines.load(std::memory_order_relaxed);
+}
+
+uint64 Scheduler::DeadlineOf(uint64 frameNumber) const {
+    return this->startTime + ((frameNumber * Scheduler::NanosecondsPerSecond) / this->framesPerSecond);
+}
+
+// Interval Statistics
+
+IntervalStatistics::IntervalStatistics(void) {
+    this->Reset();
+}
+
+// Samples
+
+void IntervalStatistics::Record(uint64 eventTime) {
+    if (this->lastTime == 0) {
+        this->lastTime = eventTime;
+        return;
+    }
+
+    this->RecordInterval(eventTime - this->lastTime);
+    this->lastTime = eventTime;
+}
+
+void IntervalStatistics::RecordInterval(uint64 currentInterval) {
+    double meanDistance = currentInterval - this->intervalMean;
+
+    this->intervalCount++;
+    this->intervalMean += meanDistance / this->intervalCount;
+    this->squaredDistance += meanDistance * (currentInterval - this->intervalMean);
+
+    if (currentInterval > this->maximumInterval) {
+        this->maximumInterval = currentInterval;
+    }
+}
+
+void IntervalStatistics::Reset(void) {
+    this->lastTime        = 0;
+    this->intervalCount   = 0;
+    this->intervalMean    = 0.0;
+    this->squaredDistance = 0.0;
+    this->maximumInterval = 0;
+}
+
+// Results
+
+uint64 IntervalStatistics::GetCount(void) const {
+    return this->intervalCount;
+}
+
+double IntervalStatistics::GetMean(void) const {
+    return this->intervalMean;
+}
+
+double IntervalStatistics::GetDeviation(void) const {
+    return this->intervalCount > 1 ? sqrt(this->squaredDistance / (this->intervalCount - 1)) : 0.0;
+}
+
+uint64 IntervalStatistics::GetMaximum(void) const {
+    return this->maximumInterval;
+}
+
+// Interval Histogram
+
+IntervalHistogram::IntervalHistogram(void) {
+    this->Reset();
+}
+
+// Samples
+
+void IntervalHistogram::Record(uint64 eventTime) {
+    if (this->lastTime == 0) {
+        this->lastTime = eventTime;
+        return;
+    }
+
+    this->RecordInterval(eventTime - this->lastTime);
+    this->lastTime = eventTime;
+}
+
+void IntervalHistogram::RecordInterval(uint64 currentInterval) {
+    // Only one thread records, so plain loads and stores are enough for readers to see whole counts.
+
+    uint bucketIndex = currentInterval / IntervalHistogram::BucketWidth;
+
+    if (bucketIndex >= IntervalHistogram::NumberOfBuckets) {
+        bucketIndex = IntervalHistogram::NumberOfBuckets - 1;
+    }
+
+    this->bucketCounts[bucketIndex].store(this->bucketCounts[bucketIndex].load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    this->intervalCount.store(this->intervalCount.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+
+    if (currentInterval > this->maximumInterval.load(std::memory_order_relaxed)) {
+        this->maximumInterval.store(currentInterval, std::memory_order_relaxed);
+    }
+}
+
+void IntervalHistogram::Reset(void) {
+    this->lastTime = 0;
+
+    for (uint bucketIndex = 0; bucketIndex < IntervalHistogram::NumberOfBuckets; ++bucketIndex) {
+        this->bucketCounts[bucketIndex].store(0, std::memory_order_relaxed);
+    }
+
+    this->intervalCount.store(0, std::memory_order_relaxed);
+    this->maximumInterval.store(0, std::memory_order_relaxed);
+}
+
+// Results
+
+uint64 IntervalHistogram::GetCount(void) const {
+    return this->intervalCount.load(std::memory_order_relaxed);
+}
+
+uint64 IntervalHistogram::GetBucketCount(uint bucketIndex) const {
+    return bucketIndex < IntervalHistogram::NumberOfBuckets ? this->bucketCounts[bucketIndex].load(std::memory_order_relaxed) : 0;
+}
+
+uint64 IntervalHistogram::GetPercentile(double percentile) const {
+    // Buckets are summed as they are read, a sample recorded meanwhile may or may not be in.
+
+    uint64 countedIntervals = 0;
+    uint64 wantedIntervals  = static_cast<uint64>(ceil((this->GetCount() * percentile) / 100.0));
+
+    for (uint bucketIndex = 0; bucketIndex < (IntervalHistogram::NumberOfBuckets - 1); ++bucketIndex) {
+        countedIntervals += this->GetBucketCount(bucketIndex);
+
+        if ((countedIntervals > 0) && (countedIntervals >= wantedIntervals)) {
+            return std::min((bucketIndex + 1) * IntervalHistogram::BucketWidth, this->GetMaximum());
+        }
+    }
+
+    return this->GetMaximum();
+}
+
+uint64 IntervalHistogram::GetMaximum(void) const {
+    return this->maximumInterval.load(std::memory_order_relaxed);
+}
+
+// Display Clock
+
+DisplayClock::DisplayClock(void) :
+    refreshRate(0),
+    refreshesPerFrame(0),
+    framePeriod(0),
+    blankCount(0),
+    blankTime(0),
+    waitedBlank(0),
+    waitedTime(0),
+    missedRefreshes(0) {
+    // Empty
+}
+
+// Refreshes
+
+bool DisplayClock::Start(uint refreshRate, uint framesPerSecond) {
+    uint refreshesPerFrame = framesPerSecond > 0 ? (refreshRate + (framesPerSecond / 2)) / framesPerSecond : 0;
+    uint pacedRate         = refreshesPerFrame * framesPerSecond;
+    uint rateError         = refreshRate > pacedRate ? refreshRate - pacedRate : pacedRate - refreshRate;
+
+    std::lock_guard<std::mutex> blankGuard(this->blankLock);
+
+    this->refreshRate       = refreshRate;
+    this->refreshesPerFrame = (refreshesPerFrame > 0) && (rateError <= (refreshesPerFrame * DisplayClock::MaximumRateError)) ? refreshesPerFrame : 0;
+    this->framePeriod       = framesPerSecond > 0 ? Scheduler::NanosecondsPerSecond / framesPerSecond : 0;
+    this->blankCount        = 0;
+    this->blankTime         = Scheduler::Now();
+    this->waitedBlank       = 0;
+    this->waitedTime        = this->blankTime;
+    this->missedRefreshes   = 0;
+
+    return this->refreshesPerFrame > 0;
+}
+
+void DisplayClock::Signal(uint64 blankTime) {
+    {
+        std::lock_guard<std::mutex> blankGuard(this->blankLock);
+        this->blankCount++;
+        this->blankTime = blankTime;
+    }
+
+    this->blankCondition.notify_one();
+}
+
+uint64 DisplayClock::GetRefreshPeriod(void) const {
+    return Scheduler::NanosecondsPerSecond / (this->refreshRate > 0 ? this->refreshRate : 60);
+}
+
+// Frames
+
+bool DisplayClock::WaitForFrame(uint64 frameDeadline) {
+    if (!this->refreshesPerFrame) {
+        return false;
+    }
+
+    // A refresh that comes much sooner than the frame period (a present that does not wait for the display) does not
+    // start a frame, and a display that stops refreshing (a hidden window) leaves the frame to the caller.
+
+    uint64 targetBlank  = this->waitedBlank + this->refreshesPerFrame;
+    uint64 earliestTime = this->waitedTime + ((this->framePeriod * 3) / 4);
+    uint64 wakeTime     = frameDeadline + (this->framePeriod / 4);
+    bool   isRefreshed  = true;
+
+    std::unique_lock<std::mutex> blankGuard(this->blankLock);
+
+    if ((this->blankCount >= targetBlank) && (this->blankTime >= earliestTime)) {
+        // The refresh this frame was due for went by while it ran: it shows one refresh late, the next one starts now.
+
+        this->missedRefreshes++;
+    } else {
+        // Scheduler::Now and steady_clock are both CLOCK_MONOTONIC.
+
+        std::chrono::steady_clock::time_point wakePoint(std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::nanoseconds(wakeTime)));
+
+        isRefreshed = this->blankCondition.wait_until(blankGuard, wakePoint, [this, targetBlank, earliestTime]() { return (this->blankCount >= targetBlank) && (this->blankTime >= earliestTime); });
+    }
+
+    this->waitedBlank = this->blankCount;
+    this->waitedTime  = this->blankTime;
+
+    return isRefreshed;
+}
+
+bool DisplayClock::IsPacing(void) const {
+    return this->refreshesPerFrame > 0;
+}
+
+uint64 DisplayClock::GetMissedRefreshes(void) const {
+    return this->missedRefreshes.load(std::memory_order_relaxed);
+}
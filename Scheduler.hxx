@@ -0,0 +1,140 @@
+/*
+ * Scheduler.hxx
+ *
+ * This file is part of the Chip8++ source code.
+ * Copyright 2023 Patrick Melo <patrick@patrickmelo.com.br>
+ */
+
+#ifndef CHIP8_SCHEDULER_H
+#define CHIP8_SCHEDULER_H
+
+#include "Core.hxx"
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+
+// Scheduler (absolute frame deadlines on the monotonic clock)
+
+class Scheduler {
+    public:
+        Scheduler(void);
+
+        // Constants
+        static constexpr charconst Tag                  = "Scheduler";
+        static constexpr uint64    NanosecondsPerSecond = 1000000000;
+        static constexpr uint      MaximumLateFrames    = 4;
+
+        // Clock
+        static uint64 Now(void);
+
+        // Frames
+        void   Start(uint framesPerSecond);
+        bool   WaitForNextFrame(void);
+        void   CompleteFrame(void);
+        void   Synchronize(void);
+        uint64 GetNextDeadline(void) const;
+        uint64 GetFramePeriod(void) const;
+        uint64 GetMissedDeadlines(void) const;    // May be read from any thread
+
+    private:
+        // Frames
+        uint                framesPerSecond;
+        uint64              startTime;
+        uint64              frameNumber;
+        std::atomic<uint64> missedDeadlines;
+
+        uint64 DeadlineOf(uint64 frameNumber) const;
+};
+
+// Interval Statistics (running mean, deviation and maximum of the time between events)
+
+class IntervalStatistics {
+    public:
+        IntervalStatistics(void);
+
+        // Samples
+        void Record(uint64 eventTime);
+        void RecordInterval(uint64 currentInterval);    // A duration measured elsewhere (a latency, for example)
+        void Reset(void);
+
+        // Results (nanoseconds)
+        uint64 GetCount(void) const;
+        double GetMean(void) const;
+        double GetDeviation(void) const;
+        uint64 GetMaximum(void) const;
+
+    private:
+        // Samples
+        uint64 lastTime;
+        uint64 intervalCount;
+        double intervalMean;
+        double squaredDistance;    // Welford's running sum of squared distances from the mean
+        uint64 maximumInterval;
+};
+
+// Interval Histogram (counts of intervals in fixed buckets, one thread records while any other reads)
+
+class IntervalHistogram {
+    public:
+        IntervalHistogram(void);
+
+        // Constants
+        static constexpr uint   NumberOfBuckets = 128;
+        static constexpr uint64 BucketWidth     = 250000;    // Nanoseconds, the last bucket also takes everything longer
+
+        // Samples
+        void Record(uint64 eventTime);
+        void RecordInterval(uint64 currentInterval);
+        void Reset(void);
+
+        // Results (nanoseconds)
+        uint64 GetCount(void) const;
+        uint64 GetBucketCount(uint bucketIndex) const;
+        uint64 GetPercentile(double percentile) const;    // The upper bound of its bucket, at most the maximum
+        uint64 GetMaximum(void) const;
+
+    private:
+        // Samples
+        uint64              lastTime;
+        std::atomic<uint64> bucketCounts[NumberOfBuckets];
+        std::atomic<uint64> intervalCount;
+        std::atomic<uint64> maximumInterval;
+};
+
+// Display Clock (the thread that presents signals every refresh, the emulation thread starts its frames on them)
+
+class DisplayClock {
+    public:
+        DisplayClock(void);
+
+        // Constants
+        static constexpr uint MaximumRateError = 1;    // Hertz per refresh, a 59 Hz or 61 Hz display still paces 60 frames
+
+        // Refreshes
+        bool   Start(uint refreshRate, uint framesPerSecond);    // False when the refresh is no multiple of the frame rate
+        void   Signal(uint64 blankTime);
+        uint64 GetRefreshPeriod(void) const;
+
+        // Frames
+        bool   WaitForFrame(uint64 frameDeadline);    // False when the display did not refresh in time, the caller paces
+        bool   IsPacing(void) const;
+        uint64 GetMissedRefreshes(void) const;        // May be read from any thread
+
+    private:
+        // Refreshes
+        uint                    refreshRate;
+        uint                    refreshesPerFrame;
+        uint64                  framePeriod;
+        std::mutex              blankLock;
+        std::condition_variable blankCondition;
+        uint64                  blankCount;
+        uint64                  blankTime;    // Of the last refresh
+
+        // Frames
+        uint64              waitedBlank;
+        uint64              waitedTime;
+        std::atomic<uint64> missedRefreshes;
+};
+
+#endif    // CHIP8_SCHEDULER_H
@@ -0,0 +1,64 @@
+/*
+ * SpscQueue.hxx
+ *
+ * This file is part of the Chip8++ source code.
+ * Copyright 2023 Patrick Melo <patrick@patrickmelo.com.br>
+ */
+
+#ifndef CHIP8_SPSC_QUEUE_H
+#define CHIP8_SPSC_QUEUE_H
+
+#include "Core.hxx"
+
+#include <atomic>
+
+// Single Producer Single Consumer Queue (lock-free, fixed capacity)
+
+template <typename Type, uint Capacity>
+class SpscQueue {
+        static_assert((Capacity & (Capacity - 1)) == 0, "The queue capacity must be a power of two.");
+
+    public:
+        SpscQueue(void) :
+            headIndex(0),
+            tailIndex(0) {
+            // Empty
+        }
+
+        // Producer
+        bool Push(const Type& newItem) {
+            uint currentTail = this->tailIndex.load(std::memory_order_relaxed);
+
+            if ((currentTail - this->headIndex.load(std::memory_order_acquire)) == Capacity) {
+                return false;
+            }
+
+            this->items[currentTail & (Capacity - 1)] = newItem;
+            this->tailIndex.store(currentTail + 1, std::memory_order_release);
+            return true;
+        }
+
+        // Consumer
+        bool Pop(Type& nextItem) {
+            uint currentHead = this->headIndex.load(std::memory_order_relaxed);
+
+            if (currentHead == this->tailIndex.load(std::memory_order_acquire)) {
+                return false;
+            }
+
+            nextItem = this->items[currentHead & (Capacity - 1)];
+            this->headIndex.store(currentHead + 1, std::memory_order_release);
+            return true;
+        }
+
+    private:
+        // Items
+        Type items[Capacity];
+
+        // Indexes (the consumer owns the head, the producer owns the tail)
+        std::atomic<uint> headIndex;
+        uint8             headPadding[60];
+        std::atomic<uint> tailIndex;
+};
+
+#endif    // CHIP8_SPSC_QUEUE_H
@@ -0,0 +1,210 @@
+/*
+ * BatchBenchmark.cxx
+ *
+ * This file is part of the Chip8++ source code.
+ * Copyright 2023 Patrick Melo <patrick@patrickmelo.com.br>
+ */
+
+#include "Batch.hxx"
+#include "Chip8.hxx"
+#include "Core.hxx"
+
+// Constants
+
+static constexpr charconst Tag = "BatchBenchmark";
+
+// Programs
+
+static const uint16 KernelProgram[] = {
+    0x6000,    // 200: V0 = 0
+    0x6101,    // 202: V1 = 1
+    0x6200,    // 204: V2 = 0
+    0x8014,    // 206: V0 += V1
+    0x8105,    // 208: V1 -= V0
+    0x8303,    // 20A: V3 ^= V0
+    0x830E,    // 20C: V3 <<= 1
+    0x7201,    // 20E: V2 += 1
+    0x3200,    // 210: skip when V2 wrapped around
+    0x1206,    // 212: loop
+    0xF315,    // 214: delay = V3
+    0x1206};   // 216: loop
+
+static void StoreProgram(Chip8::RAM& mainMemory, const uint16* programCode, uint programLength) {
+    memset(mainMemory, 0, sizeof(Chip8::RAM));
+    Chip8::LoadFonts(mainMemory);
+
+    for (uint codeIndex = 0; codeIndex < programLength; ++codeIndex) {
+        mainMemory[Chip8::ProgramStartAddress + (codeIndex * 2)]     = programCode[codeIndex] >> 8;
+        mainMemory[Chip8::ProgramStartAddress + (codeIndex * 2) + 1] = programCode[codeIndex] & 0xFF;
+    }
+}
+
+// Benchmark
+
+struct Options {
+        uint          numberOfMachines;
+        uint          numberOfFrames;
+        uint          cpuRate;
+        Chip8::Engine engine;
+        bool          isSameSeed;    // Every machine draws the same random numbers, so no lane ever diverges
+};
+
+static uint32 MachineSeed(const Options& options, uint machineIndex) {
+    return Chip8::DefaultRandomSeed + (options.isSameSeed ? 0 : machineIndex);
+}
+
+static bool MeasureProgram(charconst programName, const Chip8::RAM& programMemory, Chip8::QuirkProfile quirkProfile, const Options& options) {
+    // The scalar machines run one after the other for the whole run, as the batch runs its groups. They step through idle
+    // loops like the lanes do, so both count the same instructions.
+
+    std::vector<Chip8*> machines;
+    uint64              scalarInstructions = 0;
+
+    for (uint machineIndex = 0; machineIndex < options.numberOfMachines; ++machineIndex) {
+        Chip8* newMachine = new Chip8();
+
+        newMachine->SetSharedMemory(programMemory, sizeof(Chip8::RAM));
+        newMachine->SetCpuRate(options.cpuRate);
+        newMachine->SetEngine(options.engine);
+        newMachine->SetQuirkProfile(quirkProfile);
+        newMachine->SetIdleSkipping(false);
+        newMachine->SetRandomSeed(MachineSeed(options, machineIndex));
+        newMachine->Reset();
+        machines.push_back(newMachine);
+    }
+
+    uint64 scalarTime = Scheduler::Now();
+
+    for (uint machineIndex = 0; machineIndex < machines.size(); ++machineIndex) {
+        scalarInstructions += machines[machineIndex]->RunFrames(options.numberOfFrames);
+    }
+
+    scalarTime = Scheduler::Now() - scalarTime;
+
+    Batch batch;
+
+    if (!batch.Initialize(programMemory, options.numberOfMachines, quirkProfile)) {
+        for (uint machineIndex = 0; machineIndex < machines.size(); ++machineIndex) {
+            delete machines[machineIndex];
+        }
+
+        return false;
+    }
+
+    batch.SetCpuRate(options.cpuRate);
+
+    for (uint machineIndex = 0; machineIndex < options.numberOfMachines; ++machineIndex) {
+        batch.SetRandomSeed(machineIndex, MachineSeed(options, machineIndex));
+    }
+
+    batch.Reset();
+
+    uint64 batchTime         = Scheduler::Now();
+    uint64 batchInstructions = batch.RunFrames(options.numberOfFrames);
+
+    batchTime = Scheduler::Now() - batchTime;
+
+    // Every lane has to end exactly where its own machine did, byte for byte.
+
+    uint  differentMachines = 0;
+    uint8 scalarState[Chip8::StateSize];
+    uint8 batchState[Chip8::StateSize];
+
+    for (uint machineIndex = 0; machineIndex < machines.size(); ++machineIndex) {
+        uint scalarSize = machines[machineIndex]->SaveState(scalarState, sizeof(scalarState));
+        uint batchSize  = batch.SaveState(machineIndex, batchState, sizeof(batchState));
+
+        if ((scalarSize != batchSize) || (memcmp(scalarState, batchState, scalarSize) != 0)) {
+            if (differentMachines == 0) {
+                Error(Tag, "%s: machine %u is the first whose lane ended in another state.", programName, machineIndex);
+            }
+
+            differentMachines++;
+        }
+
+        delete machines[machineIndex];
+    }
+
+    const Batch::Statistics& batchStatistics = batch.GetStatistics();
+
+    double scalarRate = scalarTime > 0 ? (scalarInstructions * 1e9) / scalarTime : 0.0;
+    double batchRate  = batchTime > 0 ? (batchInstructions * 1e9) / batchTime : 0.0;
+    double groupShare = batchInstructions > 0 ? ((batchInstructions - batchStatistics.maskedInstructions - batchStatistics.laneInstructions) * 100.0) / batchInstructions : 0.0;
+
+    printf("%-16s %16.0f %16.0f %8.2fx %9.1f%% %10s\n", programName, scalarRate, batchRate, scalarRate > 0 ? batchRate / scalarRate : 0.0, groupShare, differentMachines ? "DIFFERENT" : "identical");
+    return differentMachines == 0;
+}
+
+int main(int numberOfArguments, char** argumentsValues) {
+    Options                options;
+    std::vector<charconst> programPaths;
+
+    options.numberOfMachines = 1024;
+    options.numberOfFrames   = 300;
+    options.cpuRate          = 60000;
+    options.engine           = Chip8::Predecoded;
+    options.isSameSeed       = false;
+
+    for (int argumentIndex = 1; argumentIndex < numberOfArguments; ++argumentIndex) {
+        charconst argumentValue = argumentsValues[argumentIndex];
+        bool      hasValue      = (argumentIndex + 1) < numberOfArguments;
+
+        if ((strcmp(argumentValue, "--machines") == 0) && hasValue) {
+            options.numberOfMachines = strtoul(argumentsValues[++argumentIndex], NULL, 10);
+        } else if ((strcmp(argumentValue, "--frames") == 0) && hasValue) {
+            options.numberOfFrames = strtoul(argumentsValues[++argumentIndex], NULL, 10);
+        } else if ((strcmp(argumentValue, "--cpu-rate") == 0) && hasValue) {
+            options.cpuRate = strtoul(argumentsValues[++argumentIndex], NULL, 10);
+        } else if ((strcmp(argumentValue, "--engine") == 0) && hasValue) {
+            charconst engineName = argumentsValues[++argumentIndex];
+
+            if (strcmp(engineName, "interpreter") == 0) {
+                options.engine = Chip8::Interpreter;
+            } else if (strcmp(engineName, "predecoded") == 0) {
+                options.engine = Chip8::Predecoded;
+            } else if (strcmp(engineName, "recompiled") == 0) {
+                options.engine = Chip8::Recompiled;
+            } else {
+                Error(Tag, "Unknown engine: %s", engineName);
+                return 1;
+            }
+        } else if (strcmp(argumentValue, "--same-seed") == 0) {
+            options.isSameSeed = true;
+        } else if (argumentValue[0] == '-') {
+            printf("Usage: %s [--machines <count>] [--frames <count>] [--cpu-rate <hz>] [--engine <interpreter|predecoded|recompiled>] [--same-seed] [programs]\n", argumentsValues[0]);
+            return 1;
+        } else {
+            programPaths.push_back(argumentValue);
+        }
+    }
+
+    if (options.numberOfMachines == 0) {
+        Error(Tag, "At least one machine is needed.");
+        return 1;
+    }
+
+    Info(Tag, "%u machines x %u frames at %u Hz, %u lanes per group, %s seeds.", options.numberOfMachines, options.numberOfFrames, options.cpuRate, Batch::GroupLanes, options.isSameSeed ? "shared" : "per machine");
+    printf("%-16s %16s %16s %9s %10s %10s\n", "program", "scalar (ips)", "batch (ips)", "speedup", "in groups", "state");
+
+    // The built-in kernel only uses register, skip and timer instructions, the vectorized best case.
+
+    Chip8::RAM programMemory;
+    bool       isIdentical = true;
+
+    StoreProgram(programMemory, KernelProgram, sizeof(KernelProgram) / sizeof(KernelProgram[0]));
+    isIdentical &= MeasureProgram("kernel", programMemory, Chip8::QuirksVIP, options);
+
+    for (uint programIndex = 0; programIndex < programPaths.size(); ++programIndex) {
+        charconst programName = strrchr(programPaths[programIndex], '/') ? strrchr(programPaths[programIndex], '/') + 1 : programPaths[programIndex];
+
+        memset(programMemory, 0, sizeof(programMemory));
+
+        if (!Chip8::LoadProgram(programPaths[programIndex], programMemory)) {
+            return 1;
+        }
+
+        isIdentical &= MeasureProgram(programName, programMemory, Chip8::DetectQuirkProfile(programPaths[programIndex], programMemory), options);
+    }
+
+    return isIdentical ? 0 : 1;
+}
@@ -0,0 +1,173 @@
+/*
+ * EngineBenchmark.cxx
+ *
+ * This file is part of the Chip8++ source code.
+ * Copyright 2023 Patrick Melo <patrick@patrickmelo.com.br>
+ */
+
+#include "Chip8.hxx"
+#include "Core.hxx"
+#include "NullInterface.hxx"
+#include "Scheduler.hxx"
+
+// Constants
+
+static constexpr charconst Tag = "EngineBenchmark";
+
+static const Chip8::Engine Engines[] = {Chip8::Interpreter, Chip8::Predecoded, Chip8::Recompiled};
+
+// Equivalence Cases (small programs every engine has to leave in the same state)
+
+struct EquivalenceCase {
+        charconst name;
+        charconst description;
+        uint16    codeAddress[2];    // Where each part of the code goes
+        uint16    programCode[2][16];
+        uint64    numberOfCycles;
+};
+
+static const EquivalenceCase EquivalenceCases[] = {
+    {"wrapped-store",
+     "FX55 with I above 4 KB rewrites a routine that already ran",
+     {0x200, 0x2FC},
+     {{0x22FC, 0xAFFF, 0x60FF, 0xF01E, 0xF01E, 0xF01E, 0x606A, 0x6116, 0xF155, 0x22FC, 0x1214}, {0x6A0B, 0x00EE}},
+     200}};
+
+static bool CheckCase(const EquivalenceCase& equivalenceCase) {
+    Chip8::RAM programMemory;
+    uint8      referenceState[Chip8::StateSize];
+    uint8      engineState[Chip8::StateSize];
+
+    memset(programMemory, 0, sizeof(programMemory));
+    Chip8::LoadFonts(programMemory);
+
+    for (uint partIndex = 0; partIndex < 2; ++partIndex) {
+        uint16 address = equivalenceCase.codeAddress[partIndex];
+
+        for (uint codeIndex = 0; (codeIndex < 16) && equivalenceCase.programCode[partIndex][codeIndex]; ++codeIndex, address += 2) {
+            programMemory[address]     = equivalenceCase.programCode[partIndex][codeIndex] >> 8;
+            programMemory[address + 1] = equivalenceCase.programCode[partIndex][codeIndex] & 0xFF;
+        }
+    }
+
+    bool isMatching = true;
+
+    for (uint engineIndex = 0; engineIndex < (sizeof(Engines) / sizeof(Engines[0])); ++engineIndex) {
+        Chip8      chip8;
+        Chip8::RAM mainMemory;
+
+        memcpy(mainMemory, programMemory, sizeof(Chip8::RAM));
+        chip8.SetRAM(&mainMemory);
+        chip8.SetEngine(Engines[engineIndex]);
+        chip8.Reset();
+        chip8.RunCycles(equivalenceCase.numberOfCycles);
+        chip8.SaveState(engineIndex == 0 ? referenceState : engineState, Chip8::StateSize);
+
+        if ((engineIndex > 0) && (memcmp(referenceState, engineState, Chip8::StateSize) != 0)) {
+            Error(Tag, "%s: engine %u differs from the interpreter (VA %02X).", equivalenceCase.name, Engines[engineIndex], chip8.GetRegisters()[0xA]);
+            isMatching = false;
+        }
+    }
+
+    return isMatching;
+}
+
+// Benchmark
+
+struct EngineResult {
+        double instructionsPerSecond;
+        uint32 memoryChecksum;
+};
+
+static uint32 Checksum(const uint8* data, uint dataSize) {
+    uint32 checksumValue = 2166136261u;    // FNV-1a
+
+    for (uint byteIndex = 0; byteIndex < dataSize; ++byteIndex) {
+        checksumValue = (checksumValue ^ data[byteIndex]) * 16777619u;
+    }
+
+    return checksumValue;
+}
+
+static EngineResult MeasureEngine(const Chip8::RAM& programMemory, Chip8::Engine engine, uint64 numberOfCycles) {
+    Chip8         chip8;
+    NullInterface nullInterface;
+    Chip8::RAM    mainMemory;
+
+    memcpy(mainMemory, programMemory, sizeof(Chip8::RAM));
+    nullInterface.Initialize(&chip8);
+    chip8.SetRAM(&mainMemory);
+    chip8.SetEngine(engine);
+    chip8.SetIdleSkipping(false);    // The interpreter runs every instruction, so every engine does
+    chip8.Reset();
+
+    uint64 startTime           = Scheduler::Now();
+    uint64 retiredInstructions = chip8.RunCycles(numberOfCycles);
+    uint64 elapsedTime         = Scheduler::Now() - startTime;
+
+    EngineResult engineResult;
+    engineResult.instructionsPerSecond = elapsedTime > 0 ? (retiredInstructions * 1e9) / elapsedTime : 0.0;
+    engineResult.memoryChecksum        = Checksum(mainMemory, sizeof(mainMemory));
+
+    nullInterface.Finalize();
+    return engineResult;
+}
+
+int main(int numberOfArguments, char** argumentsValues) {
+    uint64                  numberOfCycles = 50000000;
+    std::vector<charconst> programPaths;
+
+    for (int argumentIndex = 1; argumentIndex < numberOfArguments; ++argumentIndex) {
+        if ((strcmp(argumentsValues[argumentIndex], "--cycles") == 0) && ((argumentIndex + 1) < numberOfArguments)) {
+            numberOfCycles = strtoull(argumentsValues[++argumentIndex], NULL, 10);
+        } else {
+            programPaths.push_back(argumentsValues[argumentIndex]);
+        }
+    }
+
+    if (programPaths.empty()) {
+        programPaths.push_back("Pong.ch8");
+        programPaths.push_back("Stars.ch8");
+        programPaths.push_back("Particle.ch8");
+    }
+
+    bool isMatching = true;
+
+    for (uint caseIndex = 0; caseIndex < (sizeof(EquivalenceCases) / sizeof(EquivalenceCases[0])); ++caseIndex) {
+        bool isCaseMatching = CheckCase(EquivalenceCases[caseIndex]);
+
+        printf("%-16s %-56s %6s\n", EquivalenceCases[caseIndex].name, EquivalenceCases[caseIndex].description, isCaseMatching ? "yes" : "NO");
+        isMatching &= isCaseMatching;
+    }
+
+    Info(Tag, "%" PRIu64 " instructions per run.", numberOfCycles);
+    printf("%-16s %16s %16s %8s %16s %8s %6s\n", "program", "interpreter/s", "predecoded/s", "gain", "recompiled/s", "gain", "match");
+
+    for (uint programIndex = 0; programIndex < programPaths.size(); ++programIndex) {
+        Chip8::RAM programMemory;
+        memset(programMemory, 0, sizeof(programMemory));
+
+        if (!Chip8::LoadProgram(programPaths[programIndex], programMemory)) {
+            return 1;
+        }
+
+        EngineResult interpreterResult = MeasureEngine(programMemory, Chip8::Interpreter, numberOfCycles);
+        EngineResult predecodedResult  = MeasureEngine(programMemory, Chip8::Predecoded, numberOfCycles);
+        EngineResult recompiledResult  = MeasureEngine(programMemory, Chip8::Recompiled, numberOfCycles);
+
+        bool isProgramMatching = (interpreterResult.memoryChecksum == predecodedResult.memoryChecksum) && (interpreterResult.memoryChecksum == recompiledResult.memoryChecksum);
+
+        printf("%-16s %16.0f %16.0f %7.2fx %16.0f %7.2fx %6s\n",
+               programPaths[programIndex],
+               interpreterResult.instructionsPerSecond,
+               predecodedResult.instructionsPerSecond,
+               predecodedResult.instructionsPerSecond / interpreterResult.instructionsPerSecond,
+               recompiledResult.instructionsPerSecond,
+               recompiledResult.instructionsPerSecond / interpreterResult.instructionsPerSecond,
+               isProgramMatching ? "yes" : "NO");
+
+        isMatching &= isProgramMatching;
+    }
+
+    return isMatching ? 0 : 1;
+}
@@ -0,0 +1,129 @@
+/*
+ * FleetBenchmark.cxx
+ *
+ * This file is part of the Chip8++ source code.
+ * Copyright 2023 Patrick Melo <patrick@patrickmelo.com.br>
+ */
+
+#include "Chip8.hxx"
+#include "Core.hxx"
+#include "Fleet.hxx"
+#include "RomPack.hxx"
+
+#include <thread>
+
+// Constants
+
+static constexpr charconst Tag = "FleetBenchmark";
+
+// Benchmark
+
+static uint64 ElapsedMicroseconds(const timeval& startTime, const timeval& endTime) {
+    return ((endTime.tv_sec * 1000000) + endTime.tv_usec) - ((startTime.tv_sec * 1000000) + startTime.tv_usec);
+}
+
+static double MeasureThroughput(const std::vector<Chip8::RAM*>& programs, uint numberOfWorkers, uint numberOfSessions, uint numberOfFrames) {
+    Fleet fleet(numberOfWorkers);
+
+    for (uint sessionIndex = 0; sessionIndex < numberOfSessions; ++sessionIndex) {
+        fleet.AddSession(*programs[sessionIndex % programs.size()], numberOfFrames, Chip8::DefaultRandomSeed + sessionIndex);
+    }
+
+    timeval startTime, endTime;
+
+    gettimeofday(&startTime, NULL);
+    fleet.Run();
+    gettimeofday(&endTime, NULL);
+
+    uint64 elapsedTime = ElapsedMicroseconds(startTime, endTime);
+    double throughput  = elapsedTime > 0 ? (fleet.GetRetiredInstructions() * 1000000.0) / elapsedTime : 0.0;
+
+    printf("%7u %12" PRIu64 " %12" PRIu64 " %16.0f %10" PRIu64 "\n", numberOfWorkers, fleet.GetRetiredInstructions(), elapsedTime, throughput, fleet.GetStolenSlices());
+    return throughput;
+}
+
+int main(int numberOfArguments, char** argumentsValues) {
+    uint                     numberOfSessions = 1024;
+    uint                     numberOfFrames   = 600;
+    uint                     maximumWorkers   = std::thread::hardware_concurrency();
+    std::vector<Chip8::RAM*> programs;
+
+    for (int argumentIndex = 1; argumentIndex < numberOfArguments; ++argumentIndex) {
+        charconst argumentValue = argumentsValues[argumentIndex];
+        bool      hasValue      = (argumentIndex + 1) < numberOfArguments;
+
+        if ((strcmp(argumentValue, "--sessions") == 0) && hasValue) {
+            numberOfSessions = strtoul(argumentsValues[++argumentIndex], NULL, 10);
+        } else if ((strcmp(argumentValue, "--frames") == 0) && hasValue) {
+            numberOfFrames = strtoul(argumentsValues[++argumentIndex], NULL, 10);
+        } else if ((strcmp(argumentValue, "--workers") == 0) && hasValue) {
+            maximumWorkers = strtoul(argumentsValues[++argumentIndex], NULL, 10);
+        } else if ((strcmp(argumentValue, "--pack") == 0) && hasValue) {
+            // Every 4 KB program in the pack, straight from the mapping.
+
+            RomPack romPack;
+
+            if (!romPack.Open(argumentsValues[++argumentIndex])) {
+                return 1;
+            }
+
+            for (uint romIndex = 0; romIndex < romPack.GetRomCount(); ++romIndex) {
+                const RomPack::Entry* romEntry      = romPack.GetEntry(romIndex);
+                Chip8::RAM*           programMemory = reinterpret_cast<Chip8::RAM*>(new uint8[sizeof(Chip8::RAM)]());
+
+                if ((romEntry->dataSize > (sizeof(Chip8::RAM) - Chip8::ProgramStartAddress)) || !romPack.LoadProgram(*romEntry, *programMemory)) {
+                    delete[] reinterpret_cast<uint8*>(programMemory);
+                    continue;
+                }
+
+                programs.push_back(programMemory);
+            }
+        } else {
+            Chip8::RAM* programMemory = reinterpret_cast<Chip8::RAM*>(new uint8[sizeof(Chip8::RAM)]());
+
+            if (!Chip8::LoadProgram(argumentValue, *programMemory)) {
+                return 1;
+            }
+
+            programs.push_back(programMemory);
+        }
+    }
+
+    if (programs.empty() || (numberOfSessions == 0)) {
+        printf("Usage: %s [--sessions <count>] [--frames <count>] [--workers <count>] [--pack <path>] [<program> ...]\n", argumentsValues[0]);
+        return 1;
+    }
+
+    if (maximumWorkers == 0) {
+        maximumWorkers = 1;
+    }
+
+    Info(Tag, "%u sessions x %u frames, up to %u workers.", numberOfSessions, numberOfFrames, maximumWorkers);
+    printf("%7s %12s %12s %16s %10s\n", "workers", "instructions", "time (us)", "instructions/s", "stolen");
+
+    std::vector<uint>   workerCounts;
+    std::vector<double> throughputs;
+
+    for (uint numberOfWorkers = 1; numberOfWorkers < maximumWorkers; numberOfWorkers *= 2) {
+        workerCounts.push_back(numberOfWorkers);
+    }
+
+    workerCounts.push_back(maximumWorkers);
+
+    for (uint countIndex = 0; countIndex < workerCounts.size(); ++countIndex) {
+        throughputs.push_back(MeasureThroughput(programs, workerCounts[countIndex], numberOfSessions, numberOfFrames));
+    }
+
+    printf("\n%7s %10s %11s\n", "workers", "speedup", "efficiency");
+
+    for (uint countIndex = 0; countIndex < workerCounts.size(); ++countIndex) {
+        double speedUp = throughputs[0] > 0 ? throughputs[countIndex] / throughputs[0] : 0.0;
+        printf("%7u %9.2fx %10.1f%%\n", workerCounts[countIndex], speedUp, (speedUp * 100.0) / workerCounts[countIndex]);
+    }
+
+    for (uint programIndex = 0; programIndex < programs.size(); ++programIndex) {
+        delete[] reinterpret_cast<uint8*>(programs[programIndex]);
+    }
+
+    return 0;
+}
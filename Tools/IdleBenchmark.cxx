@@ -0,0 +1,185 @@
+/*
+ * IdleBenchmark.cxx
+ *
+ * This file is part of the Chip8++ source code.
+ * Copyright 2023 Patrick Melo <patrick@patrickmelo.com.br>
+ */
+
+#include "Chip8.hxx"
+#include "Core.hxx"
+#include "Scheduler.hxx"
+
+// Constants
+
+static constexpr charconst Tag = "IdleBenchmark";
+
+static charconst DefaultPrograms[] = {"Maze.ch8", "Particle.ch8", "Pong.ch8", "Stars.ch8"};
+
+// Frame Limit (stops the machine after a number of frames, on the emulation thread)
+
+class LimitedInterface : public Chip8::Interface {
+    public:
+        LimitedInterface(Chip8* chip8, uint64 numberOfFrames) :
+            chip8(chip8),
+            remainingFrames(numberOfFrames) {
+            // Empty
+        }
+
+        void Update(const Chip8::DirtyRegion& dirtyRegion) {
+            if (--this->remainingFrames == 0) {
+                this->chip8->Stop();
+            }
+        }
+
+    private:
+        Chip8* chip8;
+        uint64 remainingFrames;
+};
+
+// Benchmark
+
+struct Options {
+        uint          numberOfFrames;      // Headless
+        uint          realtimeFrames;      // At 60 Hz, 0 skips the real time runs
+        uint          cpuRate;
+        Chip8::Engine engine;
+};
+
+struct Measurement {
+        uint64 headlessTime;
+        uint64 retiredInstructions;
+        uint64 skippedInstructions;
+        uint64 realtimeWallTime;
+        uint64 realtimeCpuTime;
+        uint8  finalState[Chip8::StateSize];
+};
+
+static uint64 ThreadCpuTime(void) {
+    timespec cpuTime;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &cpuTime);
+
+    return (cpuTime.tv_sec * Scheduler::NanosecondsPerSecond) + cpuTime.tv_nsec;
+}
+
+static void MeasureProgram(const Chip8::RAM& programMemory, Chip8::QuirkProfile quirkProfile, bool isIdleSkipping, const Options& options, Measurement& measurement) {
+    Chip8 chip8;
+
+    chip8.SetSharedMemory(programMemory, sizeof(Chip8::RAM));
+    chip8.SetCpuRate(options.cpuRate);
+    chip8.SetEngine(options.engine);
+    chip8.SetQuirkProfile(quirkProfile);
+    chip8.SetIdleSkipping(isIdleSkipping);
+    chip8.Reset();
+
+    // Headless: as fast as the host goes, the timers tick every instructionsPerFrame instructions.
+
+    uint64 startTime = Scheduler::Now();
+
+    measurement.retiredInstructions = chip8.RunFrames(options.numberOfFrames);
+    measurement.headlessTime        = Scheduler::Now() - startTime;
+    measurement.skippedInstructions = chip8.GetIdleStatistics().skippedInstructions;
+
+    chip8.SaveState(measurement.finalState, sizeof(measurement.finalState));
+
+    // Real time: the frames are paced at 60 Hz, what the thread does not spend running instructions it sleeps.
+
+    measurement.realtimeWallTime = 0;
+    measurement.realtimeCpuTime  = 0;
+
+    if (options.realtimeFrames > 0) {
+        LimitedInterface limitedInterface(&chip8, options.realtimeFrames);
+
+        chip8.SetInterface(&limitedInterface);
+
+        uint64 wallTime = Scheduler::Now();
+        uint64 cpuTime  = ThreadCpuTime();
+
+        chip8.Run();
+
+        measurement.realtimeCpuTime  = ThreadCpuTime() - cpuTime;
+        measurement.realtimeWallTime = Scheduler::Now() - wallTime;
+    }
+}
+
+static void PrintMeasurement(charconst programName, charconst modeName, const Measurement& measurement, bool isIdentical) {
+    double skippedShare = measurement.retiredInstructions > 0 ? (measurement.skippedInstructions * 100.0) / measurement.retiredInstructions : 0.0;
+    double busyShare    = measurement.realtimeWallTime > 0 ? (measurement.realtimeCpuTime * 100.0) / measurement.realtimeWallTime : 0.0;
+
+    printf("%-14s %-6s %14.2f %9.1f%% %12.1f %7.1f%% %10s\n", programName, modeName, measurement.headlessTime / 1e6, skippedShare, measurement.realtimeCpuTime / 1e6, busyShare, isIdentical ? "identical" : "DIFFERENT");
+}
+
+int main(int numberOfArguments, char** argumentsValues) {
+    Options                options;
+    std::vector<charconst> programPaths;
+
+    options.numberOfFrames = 3600;
+    options.realtimeFrames = 60;
+    options.cpuRate        = 6000000;
+    options.engine         = Chip8::Predecoded;
+
+    for (int argumentIndex = 1; argumentIndex < numberOfArguments; ++argumentIndex) {
+        charconst argumentValue = argumentsValues[argumentIndex];
+        bool      hasValue      = (argumentIndex + 1) < numberOfArguments;
+
+        if ((strcmp(argumentValue, "--frames") == 0) && hasValue) {
+            options.numberOfFrames = strtoul(argumentsValues[++argumentIndex], NULL, 10);
+        } else if ((strcmp(argumentValue, "--realtime-frames") == 0) && hasValue) {
+            options.realtimeFrames = strtoul(argumentsValues[++argumentIndex], NULL, 10);
+        } else if ((strcmp(argumentValue, "--cpu-rate") == 0) && hasValue) {
+            options.cpuRate = strtoul(argumentsValues[++argumentIndex], NULL, 10);
+        } else if ((strcmp(argumentValue, "--engine") == 0) && hasValue) {
+            charconst engineName = argumentsValues[++argumentIndex];
+
+            if (strcmp(engineName, "predecoded") == 0) {
+                options.engine = Chip8::Predecoded;
+            } else if (strcmp(engineName, "recompiled") == 0) {
+                options.engine = Chip8::Recompiled;
+            } else {
+                Error(Tag, "Unknown engine: %s (the interpreter never skips)", engineName);
+                return 1;
+            }
+        } else if (argumentValue[0] == '-') {
+            printf("Usage: %s [--frames <count>] [--realtime-frames <count>] [--cpu-rate <hz>] [--engine <predecoded|recompiled>] [programs]\n", argumentsValues[0]);
+            return 1;
+        } else {
+            programPaths.push_back(argumentValue);
+        }
+    }
+
+    if (programPaths.empty()) {
+        programPaths.assign(DefaultPrograms, DefaultPrograms + (sizeof(DefaultPrograms) / sizeof(DefaultPrograms[0])));
+    }
+
+    Info(Tag, "%u headless frames and %u real time frames at %u Hz.", options.numberOfFrames, options.realtimeFrames, options.cpuRate);
+    printf("%-14s %-6s %14s %10s %12s %8s %10s\n", "program", "idle", "headless (ms)", "skipped", "cpu (ms)", "busy", "state");
+
+    bool isIdentical = true;
+
+    for (uint programIndex = 0; programIndex < programPaths.size(); ++programIndex) {
+        charconst  programName = strrchr(programPaths[programIndex], '/') ? strrchr(programPaths[programIndex], '/') + 1 : programPaths[programIndex];
+        Chip8::RAM programMemory;
+
+        memset(programMemory, 0, sizeof(programMemory));
+
+        if (!Chip8::LoadProgram(programPaths[programIndex], programMemory)) {
+            return 1;
+        }
+
+        // Skipping has to leave the machine exactly where stepping through every pass does.
+
+        Chip8::QuirkProfile quirkProfile = Chip8::DetectQuirkProfile(programPaths[programIndex], programMemory);
+        Measurement         steppedRun;
+        Measurement         skippedRun;
+
+        MeasureProgram(programMemory, quirkProfile, false, options, steppedRun);
+        MeasureProgram(programMemory, quirkProfile, true, options, skippedRun);
+
+        bool isSameState = (steppedRun.retiredInstructions == skippedRun.retiredInstructions) && (memcmp(steppedRun.finalState, skippedRun.finalState, sizeof(steppedRun.finalState)) == 0);
+
+        PrintMeasurement(programName, "step", steppedRun, true);
+        PrintMeasurement(programName, "skip", skippedRun, isSameState);
+        isIdentical &= isSameState;
+    }
+
+    return isIdentical ? 0 : 1;
+}
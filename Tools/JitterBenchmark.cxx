@@ -0,0 +1,245 @@
+/*
+ * JitterBenchmark.cxx
+ *
+ * This file is part of the Chip8++ source code.
+ * Copyright 2023 Patrick Melo <patrick@patrickmelo.com.br>
+ */
+
+#include "Chip8.hxx"
+#include "Core.hxx"
+#include "Scheduler.hxx"
+#include "TripleBuffer.hxx"
+
+#include <thread>
+
+// Constants
+
+static constexpr charconst Tag = "JitterBenchmark";
+
+// Simulated Presentation (a fixed blit cost plus a periodic compositor stall)
+
+static uint presentCost   = 10;    // Milliseconds
+static uint stallCost     = 40;    // Milliseconds
+static uint stallInterval = 15;    // Frames
+
+static void SimulatePresent(uint64 frameNumber) {
+    uint presentTime = ((frameNumber % stallInterval) == 0) ? stallCost : presentCost;
+    usleep(presentTime * 1000);
+}
+
+// Synchronous Interface (presents inside Update, like the single-threaded loop did)
+
+class SynchronousInterface : public Chip8::Interface {
+    public:
+        SynchronousInterface(Chip8* chip8, uint64 numberOfFrames) :
+            chip8(chip8),
+            remainingFrames(numberOfFrames),
+            frameNumber(0) {
+            // Empty
+        }
+
+        void Update(const Chip8::DirtyRegion& dirtyRegion) {
+            uint64 updateTime = Scheduler::Now();
+
+            this->updateIntervals.Record(updateTime);
+            this->updateHistogram.Record(updateTime);
+            SimulatePresent(++this->frameNumber);
+
+            if (--this->remainingFrames == 0) {
+                this->chip8->Stop();
+            }
+        }
+
+        IntervalStatistics updateIntervals;
+        IntervalHistogram  updateHistogram;
+
+    private:
+        Chip8* chip8;
+        uint64 remainingFrames;
+        uint64 frameNumber;
+};
+
+// Threaded Interface (publishes through the triple buffer, a render thread presents)
+
+class ThreadedInterface : public Chip8::Interface {
+    public:
+        ThreadedInterface(Chip8* chip8, uint64 numberOfFrames) :
+            isRendering(true),
+            chip8(chip8),
+            remainingFrames(numberOfFrames) {
+            // Empty
+        }
+
+        void Update(const Chip8::DirtyRegion& dirtyRegion) {
+            uint64 updateTime = Scheduler::Now();
+
+            this->updateIntervals.Record(updateTime);
+            this->updateHistogram.Record(updateTime);
+
+            memcpy(this->frameBuffer.GetBackBuffer(), this->chip8->GetVRAM(), sizeof(Chip8::VRAM));
+            this->frameBuffer.Publish();
+
+            if (--this->remainingFrames == 0) {
+                this->chip8->Stop();
+            }
+        }
+
+        void Render(void) {
+            uint64 frameNumber = 0;
+
+            while (this->isRendering.load(std::memory_order_acquire)) {
+                if (this->frameBuffer.Acquire()) {
+                    SimulatePresent(++frameNumber);
+                } else {
+                    usleep(1000);
+                }
+            }
+        }
+
+        IntervalStatistics updateIntervals;
+        IntervalHistogram  updateHistogram;
+        std::atomic<bool>  isRendering;
+
+    private:
+        Chip8*                    chip8;
+        uint64                    remainingFrames;
+        TripleBuffer<Chip8::VRAM> frameBuffer;
+};
+
+// Paced Interface (publishes through the triple buffer, a simulated display refreshes and the frames start on it)
+
+class PacedInterface : public Chip8::Interface {
+    public:
+        PacedInterface(Chip8* chip8, uint64 numberOfFrames, uint refreshRate) :
+            isRendering(true),
+            chip8(chip8),
+            remainingFrames(numberOfFrames),
+            refreshRate(refreshRate) {
+            this->displayClock.Start(refreshRate, Chip8::FrameRate);
+        }
+
+        void Update(const Chip8::DirtyRegion& dirtyRegion) {
+            uint64 updateTime = Scheduler::Now();
+
+            this->updateIntervals.Record(updateTime);
+            this->updateHistogram.Record(updateTime);
+
+            memcpy(this->frameBuffer.GetBackBuffer(), this->chip8->GetVRAM(), sizeof(Chip8::VRAM));
+            this->frameBuffer.Publish();
+
+            if (--this->remainingFrames == 0) {
+                this->chip8->Stop();
+            }
+        }
+
+        bool WaitForFrame(uint64 frameDeadline) {
+            return this->displayClock.WaitForFrame(frameDeadline);
+        }
+
+        void Render(void) {
+            // A present that waits for the display: the refreshes come on time, whatever the frames do.
+
+            uint64 startTime = Scheduler::Now();
+
+            for (uint64 blankNumber = 1; this->isRendering.load(std::memory_order_acquire); ++blankNumber) {
+                uint64   blankTime = startTime + ((blankNumber * Scheduler::NanosecondsPerSecond) / this->refreshRate);
+                timespec sleepUntil;
+
+                sleepUntil.tv_sec  = blankTime / Scheduler::NanosecondsPerSecond;
+                sleepUntil.tv_nsec = blankTime % Scheduler::NanosecondsPerSecond;
+
+                while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &sleepUntil, NULL) == EINTR) {
+                    // Interrupted by a signal, sleep again until the same refresh.
+                }
+
+                this->frameBuffer.Acquire();
+                this->displayClock.Signal(Scheduler::Now());
+            }
+        }
+
+        IntervalStatistics updateIntervals;
+        IntervalHistogram  updateHistogram;
+        DisplayClock       displayClock;
+        std::atomic<bool>  isRendering;
+
+    private:
+        Chip8*                    chip8;
+        uint64                    remainingFrames;
+        uint                      refreshRate;
+        TripleBuffer<Chip8::VRAM> frameBuffer;
+};
+
+// Benchmark
+
+static void PrintIntervals(charconst modeName, const IntervalStatistics& updateIntervals, const IntervalHistogram& updateHistogram, uint64 missedDeadlines) {
+    printf("%-12s %10.3f %10.3f %10.3f %10.3f %8" PRIu64 "\n", modeName, updateIntervals.GetMean() / 1e6, updateIntervals.GetDeviation() / 1e6, updateHistogram.GetPercentile(99.0) / 1e6, updateIntervals.GetMaximum() / 1e6, missedDeadlines);
+}
+
+int main(int numberOfArguments, char** argumentsValues) {
+    charconst  programPath    = numberOfArguments > 1 ? argumentsValues[1] : "Pong.ch8";
+    uint64     numberOfFrames = numberOfArguments > 2 ? strtoull(argumentsValues[2], NULL, 10) : 3 * Chip8::FrameRate;
+    uint       refreshRate    = numberOfArguments > 3 ? strtoul(argumentsValues[3], NULL, 10) : Chip8::FrameRate;
+    Chip8::RAM programMemory;
+    Chip8::RAM mainMemory;
+
+    memset(programMemory, 0, sizeof(programMemory));
+
+    if (!Chip8::LoadProgram(programPath, programMemory)) {
+        return 1;
+    }
+
+    if (refreshRate == 0) {
+        Error(Tag, "The display has to refresh.");
+        return 1;
+    }
+
+    Info(Tag, "%" PRIu64 " frames, %u ms per present, %u ms stall every %u frames, a %u Hz display.", numberOfFrames, presentCost, stallCost, stallInterval, refreshRate);
+    printf("%-12s %10s %10s %10s %10s %8s\n", "mode", "mean ms", "jitter ms", "p99 ms", "worst ms", "missed");
+
+    // Before: the emulation thread waits for every present
+
+    Chip8                synchronousChip8;
+    SynchronousInterface synchronousInterface(&synchronousChip8, numberOfFrames);
+
+    memcpy(mainMemory, programMemory, sizeof(mainMemory));
+    synchronousChip8.SetRAM(&mainMemory);
+    synchronousChip8.SetInterface(&synchronousInterface);
+    synchronousChip8.Run();
+
+    PrintIntervals("synchronous", synchronousInterface.updateIntervals, synchronousInterface.updateHistogram, synchronousChip8.GetMissedDeadlines());
+
+    // After: presents happen on their own thread
+
+    Chip8             threadedChip8;
+    ThreadedInterface threadedInterface(&threadedChip8, numberOfFrames);
+
+    memcpy(mainMemory, programMemory, sizeof(mainMemory));
+    threadedChip8.SetRAM(&mainMemory);
+    threadedChip8.SetInterface(&threadedInterface);
+
+    std::thread renderThread(&ThreadedInterface::Render, &threadedInterface);
+
+    threadedChip8.Run();
+    threadedInterface.isRendering.store(false, std::memory_order_release);
+    renderThread.join();
+
+    PrintIntervals("threaded", threadedInterface.updateIntervals, threadedInterface.updateHistogram, threadedChip8.GetMissedDeadlines());
+
+    // Paced: frames start on the display's refreshes (the scheduler takes over if it is no multiple of 60 Hz)
+
+    Chip8          pacedChip8;
+    PacedInterface pacedInterface(&pacedChip8, numberOfFrames, refreshRate);
+
+    memcpy(mainMemory, programMemory, sizeof(mainMemory));
+    pacedChip8.SetRAM(&mainMemory);
+    pacedChip8.SetInterface(&pacedInterface);
+
+    std::thread displayThread(&PacedInterface::Render, &pacedInterface);
+
+    pacedChip8.Run();
+    pacedInterface.isRendering.store(false, std::memory_order_release);
+    displayThread.join();
+
+    PrintIntervals(pacedInterface.displayClock.IsPacing() ? "vsync" : "vsync (off)", pacedInterface.updateIntervals, pacedInterface.updateHistogram, pacedChip8.GetMissedDeadlines() + pacedInterface.displayClock.GetMissedRefreshes());
+    return 0;
+}
@@ -0,0 +1,161 @@
+/*
+ * KeypadBenchmark.cxx
+ *
+ * This file is part of the Chip8++ source code.
+ * Copyright 2023 Patrick Melo <patrick@patrickmelo.com.br>
+ */
+
+#include "Chip8.hxx"
+#include "Core.hxx"
+#include "Scheduler.hxx"
+
+#include <thread>
+
+// Constants
+
+static constexpr charconst Tag = "KeypadBenchmark";
+
+// Programs
+
+static const uint16 WaitProgram[] = {
+    0xF00A,    // 200: V0 = the next key
+    0x7101,    // 202: V1 += 1
+    0x3100,    // 204: skip when V1 == the number of presses (patched)
+    0x1200,    // 206: wait again
+    0x00FD};   // 208: exit
+
+static const uint16 PollProgram[] = {
+    0xE09E,    // 200: skip while key V0 is down
+    0x1200,    // 202: poll again
+    0x1200};   // 204: and again once it is down
+
+static void StoreProgram(Chip8::RAM& mainMemory, const uint16* programCode, uint programLength) {
+    memset(mainMemory, 0, sizeof(Chip8::RAM));
+
+    for (uint codeIndex = 0; codeIndex < programLength; ++codeIndex) {
+        mainMemory[Chip8::ProgramStartAddress + (codeIndex * 2)]     = programCode[codeIndex] >> 8;
+        mainMemory[Chip8::ProgramStartAddress + (codeIndex * 2) + 1] = programCode[codeIndex] & 0xFF;
+    }
+}
+
+// Frame Limit (stops the machine after a number of frames, on the emulation thread)
+
+class LimitedInterface : public Chip8::Interface {
+    public:
+        LimitedInterface(Chip8* chip8, uint64 numberOfFrames) :
+            chip8(chip8),
+            remainingFrames(numberOfFrames) {
+            // Empty
+        }
+
+        void Update(const Chip8::DirtyRegion& dirtyRegion) {
+            if (--this->remainingFrames == 0) {
+                this->chip8->Stop();
+            }
+        }
+
+    private:
+        Chip8* chip8;
+        uint64 remainingFrames;
+};
+
+// Benchmark
+
+static uint64 ThreadCpuTime(void) {
+    timespec cpuTime;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &cpuTime);
+
+    return (cpuTime.tv_sec * Scheduler::NanosecondsPerSecond) + cpuTime.tv_nsec;
+}
+
+static void PressKeys(Chip8* chip8, uint numberOfPresses, uint pressInterval) {
+    for (uint pressIndex = 0; pressIndex < numberOfPresses; ++pressIndex) {
+        // Off the frame grid, so the presses land anywhere in a frame.
+
+        usleep((pressInterval * 1000) + ((pressIndex * 7919) % 10000));
+        chip8->SetKey(pressIndex % Chip8::NumberOfKeys, true);
+        usleep(2000);
+        chip8->SetKey(pressIndex % Chip8::NumberOfKeys, false);
+    }
+}
+
+static void MeasureRun(charconst modeName, Chip8& chip8, uint cpuRate, uint numberOfPresses, uint pressInterval) {
+    uint64      cpuTime  = 0;
+    uint64      wallTime = Scheduler::Now();
+    std::thread emulationThread([&chip8, &cpuTime]() {
+        uint64 startTime = ThreadCpuTime();
+        chip8.Run();
+        cpuTime = ThreadCpuTime() - startTime;
+    });
+
+    PressKeys(&chip8, numberOfPresses, pressInterval);
+    emulationThread.join();
+    wallTime = Scheduler::Now() - wallTime;
+
+    printf("%-10s %10u %12.1f %12.1f %7.1f%%\n", modeName, cpuRate, wallTime / 1e6, cpuTime / 1e6, (cpuTime * 100.0) / wallTime);
+}
+
+int main(int numberOfArguments, char** argumentsValues) {
+    uint numberOfPresses = 60;
+    uint pressInterval   = 20;
+    uint cpuRate         = 20000000;
+
+    for (int argumentIndex = 1; argumentIndex < numberOfArguments; ++argumentIndex) {
+        charconst argumentValue = argumentsValues[argumentIndex];
+        bool      hasValue      = (argumentIndex + 1) < numberOfArguments;
+
+        if ((strcmp(argumentValue, "--presses") == 0) && hasValue) {
+            numberOfPresses = strtoul(argumentsValues[++argumentIndex], NULL, 10);
+        } else if ((strcmp(argumentValue, "--interval") == 0) && hasValue) {
+            pressInterval = strtoul(argumentsValues[++argumentIndex], NULL, 10);
+        } else if ((strcmp(argumentValue, "--cpu-rate") == 0) && hasValue) {
+            cpuRate = strtoul(argumentsValues[++argumentIndex], NULL, 10);
+        } else {
+            printf("Usage: %s [--presses <1-255>] [--interval <ms>] [--cpu-rate <hz>]\n", argumentsValues[0]);
+            return 1;
+        }
+    }
+
+    if ((numberOfPresses == 0) || (numberOfPresses > 255)) {
+        Error(Tag, "The number of presses has to be from 1 to 255.");
+        return 1;
+    }
+
+    // Both programs wait for the same presses, one in FX0A (parked) and one polling EX9E at the full CPU rate.
+
+    uint64 runFrames = (UINT64(numberOfPresses) * (pressInterval + 12) * Chip8::FrameRate) / 1000;
+
+    Info(Tag, "%u presses every %u-%u ms.", numberOfPresses, pressInterval + 2, pressInterval + 12);
+    printf("%-10s %10s %12s %12s %8s\n", "mode", "cpu rate", "wall (ms)", "cpu (ms)", "busy");
+
+    Chip8::RAM waitMemory;
+    Chip8      waitChip8;
+
+    StoreProgram(waitMemory, WaitProgram, sizeof(WaitProgram) / sizeof(WaitProgram[0]));
+    waitMemory[0x205] = numberOfPresses;
+
+    LimitedInterface waitInterface(&waitChip8, runFrames * 2);
+
+    waitChip8.SetRAM(&waitMemory);
+    waitChip8.SetCpuRate(cpuRate);
+    waitChip8.SetQuirkProfile(Chip8::QuirksSCHIP);
+    waitChip8.SetInterface(&waitInterface);
+    MeasureRun("FX0A wait", waitChip8, cpuRate, numberOfPresses, pressInterval);
+
+    Chip8::RAM pollMemory;
+    Chip8      pollChip8;
+
+    StoreProgram(pollMemory, PollProgram, sizeof(PollProgram) / sizeof(PollProgram[0]));
+
+    LimitedInterface pollInterface(&pollChip8, runFrames);
+
+    pollChip8.SetRAM(&pollMemory);
+    pollChip8.SetCpuRate(cpuRate);
+    pollChip8.SetInterface(&pollInterface);
+    MeasureRun("EX9E poll", pollChip8, cpuRate, numberOfPresses, pressInterval);
+
+    const IntervalStatistics& keyLatency = waitChip8.GetKeyLatency();
+
+    printf("\n%" PRIu64 " keys taken by FX0A, latency %.1f us (jitter %.1f us, worst %.1f us), %s.\n", keyLatency.GetCount(), keyLatency.GetMean() / 1e3, keyLatency.GetDeviation() / 1e3, keyLatency.GetMaximum() / 1e3, waitChip8.GetStopReason() == Chip8::Exited ? "all presses seen" : "presses missed");
+    return 0;
+}
@@ -0,0 +1,157 @@
+/*
+ * LibraryBenchmark.cxx
+ *
+ * This file is part of the Chip8++ source code.
+ * Copyright 2023 Patrick Melo <patrick@patrickmelo.com.br>
+ */
+
+#include "Chip8.hxx"
+#include "Core.hxx"
+#include "LibChip8.h"
+#include "Scheduler.hxx"
+
+// Constants
+
+static constexpr charconst Tag = "LibraryBenchmark";
+
+// Programs
+
+static const uint8 JumpProgram[] = {
+    0x12, 0x00};    // 200: jump to itself, one instruction per frame at one instruction per frame
+
+// Allocations (every allocation of the process is counted, the calls being measured must not make any)
+
+static uint64 numberOfAllocations = 0;
+
+void* operator new(size_t allocationSize) {
+    numberOfAllocations++;
+    void* newMemory = malloc(allocationSize ? allocationSize : 1);
+
+    if (!newMemory) {
+        throw std::bad_alloc();
+    }
+
+    return newMemory;
+}
+
+void* operator new[](size_t allocationSize) {
+    return operator new(allocationSize);
+}
+
+void* operator new(size_t allocationSize, const std::nothrow_t&) noexcept {
+    numberOfAllocations++;
+    return malloc(allocationSize ? allocationSize : 1);
+}
+
+void* operator new[](size_t allocationSize, const std::nothrow_t&) noexcept {
+    return operator new(allocationSize, std::nothrow);
+}
+
+void operator delete(void* oldMemory) noexcept {
+    free(oldMemory);
+}
+
+void operator delete[](void* oldMemory) noexcept {
+    free(oldMemory);
+}
+
+// Benchmark
+
+struct Measurement {
+        uint64 elapsedTime;
+        uint64 allocations;
+        uint64 checksum;    // Keeps the calls from being optimized away
+};
+
+template <typename Call> static Measurement Measure(uint numberOfCalls, Call call) {
+    Measurement measurement = {0, numberOfAllocations, 0};
+    uint64      startTime   = Scheduler::Now();
+
+    for (uint callIndex = 0; callIndex < numberOfCalls; ++callIndex) {
+        measurement.checksum += call(callIndex);
+    }
+
+    measurement.elapsedTime = Scheduler::Now() - startTime;
+    measurement.allocations = numberOfAllocations - measurement.allocations;
+    return measurement;
+}
+
+static bool PrintMeasurement(charconst callName, uint numberOfCalls, const Measurement& measurement) {
+    printf("%-34s %10.1f %12" PRIu64 "\n", callName, static_cast<double>(measurement.elapsedTime) / numberOfCalls, measurement.allocations);
+    return measurement.allocations == 0;
+}
+
+int main(int numberOfArguments, char** argumentsValues) {
+    uint numberOfCalls = 10000000;
+
+    for (int argumentIndex = 1; argumentIndex < numberOfArguments; ++argumentIndex) {
+        charconst argumentValue = argumentsValues[argumentIndex];
+        bool      hasValue      = (argumentIndex + 1) < numberOfArguments;
+
+        if ((strcmp(argumentValue, "--calls") == 0) && hasValue) {
+            numberOfCalls = strtoul(argumentsValues[++argumentIndex], NULL, 10);
+        } else {
+            printf("Usage: %s [--calls <count>]\n", argumentsValues[0]);
+            return 1;
+        }
+    }
+
+    if (numberOfCalls == 0) {
+        Error(Tag, "At least one call is needed.");
+        return 1;
+    }
+
+    Chip8_Machine* machine = Chip8_Create();
+
+    if (!machine || !Chip8_LoadProgram(machine, JumpProgram, sizeof(JumpProgram))) {
+        return 1;
+    }
+
+    Chip8_SetInstructionsPerFrame(machine, 1);
+
+    // The same frame through the core directly, what the library adds is the difference.
+
+    Chip8::RAM directMemory;
+    Chip8      directChip8;
+
+    memset(directMemory, 0, sizeof(directMemory));
+    memcpy(&directMemory[Chip8::ProgramStartAddress], JumpProgram, sizeof(JumpProgram));
+
+    directChip8.SetRAM(&directMemory);
+    directChip8.SetEngine(Chip8::Predecoded);
+    directChip8.SetInstructionsPerFrame(1);
+    directChip8.Reset();
+
+    Info(Tag, "%u calls each, one instruction per frame.", numberOfCalls);
+    printf("%-34s %10s %12s\n", "call", "ns/call", "allocations");
+
+    bool isAllocationFree = true;
+
+    isAllocationFree &= PrintMeasurement("Chip8::RunFrames(1)", numberOfCalls, Measure(numberOfCalls, [&directChip8](uint callIndex) {
+        return directChip8.RunFrames(1);
+    }));
+
+    isAllocationFree &= PrintMeasurement("Chip8_StepFrames(1), same keys", numberOfCalls, Measure(numberOfCalls, [machine](uint callIndex) {
+        return Chip8_StepFrames(machine, 1, 0x0000);
+    }));
+
+    isAllocationFree &= PrintMeasurement("Chip8_StepFrames(1), new keys", numberOfCalls, Measure(numberOfCalls, [machine](uint callIndex) {
+        return Chip8_StepFrames(machine, 1, callIndex & 1 ? 0x0001 : 0x0000);
+    }));
+
+    isAllocationFree &= PrintMeasurement("Chip8_GetFramebuffer", numberOfCalls, Measure(numberOfCalls, [machine](uint callIndex) {
+        return Chip8_GetFramebuffer(machine)[callIndex & (CHIP8_SCREEN_WORDS - 1)];
+    }));
+
+    isAllocationFree &= PrintMeasurement("Chip8_GetRegisters", numberOfCalls, Measure(numberOfCalls, [machine](uint callIndex) {
+        return Chip8_GetRegisters(machine)[callIndex & 0xF];
+    }));
+
+    isAllocationFree &= PrintMeasurement("Chip8_GetProgramCounter", numberOfCalls, Measure(numberOfCalls, [machine](uint callIndex) {
+        return Chip8_GetProgramCounter(machine);
+    }));
+
+    printf("\n%s\n", isAllocationFree ? "No allocation while stepping or observing." : "Stepping or observing allocated.");
+    Chip8_Destroy(machine);
+    return isAllocationFree ? 0 : 1;
+}
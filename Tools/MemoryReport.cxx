@@ -0,0 +1,191 @@
+/*
+ * MemoryReport.cxx
+ *
+ * This file is part of the Chip8++ source code.
+ * Copyright 2023 Patrick Melo <patrick@patrickmelo.com.br>
+ */
+
+#include "Chip8.hxx"
+#include "Core.hxx"
+#include "NullInterface.hxx"
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+// Constants
+
+static constexpr charconst Tag = "MemoryReport";
+
+// Measurements
+
+struct Report {
+        uint64 sharedPages;
+        uint64 privatePages;
+        uint64 instanceBytes;
+        uint64 residentBytes;    // Growth of the process while the sessions were alive
+};
+
+static uint64 ResidentBytes(void) {
+    FILE*  statmFile     = fopen("/proc/self/statm", "r");
+    uint64 totalPages    = 0;
+    uint64 residentPages = 0;
+
+    if (!statmFile) {
+        return 0;
+    }
+
+    if (fscanf(statmFile, "%" SCNu64 " %" SCNu64, &totalPages, &residentPages) != 2) {
+        residentPages = 0;
+    }
+
+    fclose(statmFile);
+    return residentPages * sysconf(_SC_PAGESIZE);
+}
+
+static void MeasureSessions(const Chip8::RAM& programMemory, uint numberOfSessions, uint numberOfFrames, bool isShared, Report& report) {
+    struct Session {
+            Chip8         chip8;
+            NullInterface nullInterface;
+            Chip8::RAM*   mainMemory;    // Only the private sessions have one
+    };
+
+    uint64                baseResident = ResidentBytes();
+    std::vector<Session*> sessions;
+
+    memset(&report, 0, sizeof(report));
+
+    for (uint sessionIndex = 0; sessionIndex < numberOfSessions; ++sessionIndex) {
+        Session* newSession = new Session();
+
+        newSession->mainMemory = NULL;
+        newSession->nullInterface.Initialize(&newSession->chip8);
+        newSession->chip8.SetEngine(Chip8::Interpreter);
+
+        if (isShared) {
+            newSession->chip8.SetSharedMemory(programMemory, sizeof(Chip8::RAM));
+        } else {
+            newSession->mainMemory = reinterpret_cast<Chip8::RAM*>(new uint8[sizeof(Chip8::RAM)]);
+
+            memcpy(*newSession->mainMemory, programMemory, sizeof(Chip8::RAM));
+            newSession->chip8.SetRAM(newSession->mainMemory);
+        }
+
+        newSession->chip8.SetRandomSeed(Chip8::DefaultRandomSeed + sessionIndex);
+        newSession->chip8.Reset();
+        newSession->chip8.RunFrames(numberOfFrames);
+        sessions.push_back(newSession);
+    }
+
+    for (uint sessionIndex = 0; sessionIndex < sessions.size(); ++sessionIndex) {
+        Chip8::MemoryFootprint memoryFootprint = sessions[sessionIndex]->chip8.GetMemoryFootprint();
+
+        report.sharedPages += memoryFootprint.sharedPages;
+        report.privatePages += memoryFootprint.privatePages;
+        report.instanceBytes += memoryFootprint.instanceBytes;
+    }
+
+    uint64 sessionsResident = ResidentBytes();
+    report.residentBytes    = sessionsResident > baseResident ? sessionsResident - baseResident : 0;
+
+    for (uint sessionIndex = 0; sessionIndex < sessions.size(); ++sessionIndex) {
+        sessions[sessionIndex]->nullInterface.Finalize();
+
+        delete[] reinterpret_cast<uint8*>(sessions[sessionIndex]->mainMemory);
+        delete sessions[sessionIndex];
+    }
+}
+
+static bool MeasureApart(const Chip8::RAM& programMemory, uint numberOfSessions, uint numberOfFrames, bool isShared, Report& report) {
+    // Each model runs in its own process, so the heap left behind by one never inflates or hides the other.
+
+    int reportPipe[2];
+
+    if (pipe(reportPipe) != 0) {
+        Error(Tag, "Could not create a pipe.");
+        return false;
+    }
+
+    pid_t childId = fork();
+
+    if (childId < 0) {
+        Error(Tag, "Could not fork.");
+        close(reportPipe[0]);
+        close(reportPipe[1]);
+        return false;
+    }
+
+    if (childId == 0) {
+        Report childReport;
+
+        close(reportPipe[0]);
+        MeasureSessions(programMemory, numberOfSessions, numberOfFrames, isShared, childReport);
+        _exit(write(reportPipe[1], &childReport, sizeof(childReport)) == sizeof(childReport) ? 0 : 1);
+    }
+
+    close(reportPipe[1]);
+
+    bool isRead = read(reportPipe[0], &report, sizeof(report)) == sizeof(report);
+    int  childStatus;
+
+    close(reportPipe[0]);
+    waitpid(childId, &childStatus, 0);
+
+    if (!isRead) {
+        Error(Tag, "The %s measurement did not report back.", isShared ? "shared" : "private");
+    }
+
+    return isRead;
+}
+
+static void PrintReport(charconst modelName, const Report& report, uint numberOfSessions) {
+    printf("%-8s %12.1f %13.1f %14.0f %14.0f\n", modelName, static_cast<double>(report.sharedPages) / numberOfSessions, static_cast<double>(report.privatePages) / numberOfSessions, static_cast<double>(report.instanceBytes) / numberOfSessions, static_cast<double>(report.residentBytes) / numberOfSessions);
+}
+
+int main(int numberOfArguments, char** argumentsValues) {
+    uint      numberOfSessions = 10000;
+    uint      numberOfFrames   = 600;
+    charconst programPath      = NULL;
+
+    for (int argumentIndex = 1; argumentIndex < numberOfArguments; ++argumentIndex) {
+        charconst argumentValue = argumentsValues[argumentIndex];
+        bool      hasValue      = (argumentIndex + 1) < numberOfArguments;
+
+        if ((strcmp(argumentValue, "--sessions") == 0) && hasValue) {
+            numberOfSessions = strtoul(argumentsValues[++argumentIndex], NULL, 10);
+        } else if ((strcmp(argumentValue, "--frames") == 0) && hasValue) {
+            numberOfFrames = strtoul(argumentsValues[++argumentIndex], NULL, 10);
+        } else {
+            programPath = argumentValue;
+        }
+    }
+
+    if (!programPath || (numberOfSessions == 0)) {
+        printf("Usage: %s [--sessions <count>] [--frames <count>] <program>\n", argumentsValues[0]);
+        return 1;
+    }
+
+    Chip8::RAM programMemory;
+    memset(programMemory, 0, sizeof(programMemory));
+
+    if (!Chip8::LoadProgram(programPath, programMemory)) {
+        return 1;
+    }
+
+    Report privateReport, sharedReport;
+
+    Info(Tag, "%u interpreted sessions x %u frames, per instance:", numberOfSessions, numberOfFrames);
+
+    if (!MeasureApart(programMemory, numberOfSessions, numberOfFrames, false, privateReport) || !MeasureApart(programMemory, numberOfSessions, numberOfFrames, true, sharedReport)) {
+        return 1;
+    }
+
+    printf("%-8s %12s %13s %14s %14s\n", "memory", "shared pages", "private pages", "bytes", "resident bytes");
+    PrintReport("private", privateReport, numberOfSessions);
+    PrintReport("shared", sharedReport, numberOfSessions);
+
+    double instanceSaving = privateReport.instanceBytes > 0 ? 100.0 - ((sharedReport.instanceBytes * 100.0) / privateReport.instanceBytes) : 0.0;
+    double residentSaving = privateReport.residentBytes > 0 ? 100.0 - ((sharedReport.residentBytes * 100.0) / privateReport.residentBytes) : 0.0;
+
+    printf("\nSharing saves %.1f%% of the accounted bytes and %.1f%% of the resident memory.\n", instanceSaving, residentSaving);
+    return 0;
+}
@@ -0,0 +1,89 @@
+/*
+ * PackBenchmark.cxx
+ *
+ * This file is part of the Chip8++ source code.
+ * Copyright 2023 Patrick Melo <patrick@patrickmelo.com.br>
+ */
+
+#include "Chip8.hxx"
+#include "Core.hxx"
+#include "RomPack.hxx"
+#include "Scheduler.hxx"
+
+// Constants
+
+static constexpr charconst Tag = "PackBenchmark";
+
+// Benchmark
+
+int main(int numberOfArguments, char** argumentsValues) {
+    if (numberOfArguments < 2) {
+        printf("Usage: %s <pack> [<lookups>]\n", argumentsValues[0]);
+        return 1;
+    }
+
+    charconst packPath        = argumentsValues[1];
+    uint      numberOfLookups = numberOfArguments > 2 ? strtoul(argumentsValues[2], NULL, 10) : 1000000;
+    RomPack   romPack;
+
+    uint64 startTime = Scheduler::Now();
+
+    if (!romPack.Open(packPath) || (romPack.GetRomCount() == 0)) {
+        return 1;
+    }
+
+    uint64 openTime = Scheduler::Now() - startTime;
+
+    // The ROMs are visited in a scattered order (a stride coprime with most pack sizes), as sessions would ask for them.
+
+    uint                numberOfRoms = romPack.GetRomCount();
+    std::vector<uint64> romHashes(numberOfRoms);
+    std::vector<string> romNames(numberOfRoms);
+    Chip8::RAM          mainMemory;
+    uint64              loadedBytes = 0;
+
+    for (uint romIndex = 0; romIndex < numberOfRoms; ++romIndex) {
+        romHashes[romIndex] = romPack.GetEntry(romIndex)->contentHash;
+        romNames[romIndex]  = romPack.GetName(*romPack.GetEntry(romIndex));
+    }
+
+    memset(mainMemory, 0, sizeof(mainMemory));
+
+    // By name
+
+    startTime = Scheduler::Now();
+
+    for (uint lookupIndex = 0; lookupIndex < numberOfLookups; ++lookupIndex) {
+        const RomPack::Entry* romEntry = romPack.FindByName(romNames[(UINT64(lookupIndex) * 7919) % numberOfRoms].c_str());
+
+        if (!romEntry || !romPack.LoadProgram(*romEntry, mainMemory)) {
+            return 1;
+        }
+
+        loadedBytes += romEntry->dataSize;
+    }
+
+    uint64 nameTime = Scheduler::Now() - startTime;
+
+    // By hash
+
+    startTime = Scheduler::Now();
+
+    for (uint lookupIndex = 0; lookupIndex < numberOfLookups; ++lookupIndex) {
+        const RomPack::Entry* romEntry = romPack.FindByHash(romHashes[(UINT64(lookupIndex) * 7919) % numberOfRoms]);
+
+        if (!romEntry || !romPack.LoadProgram(*romEntry, mainMemory)) {
+            return 1;
+        }
+
+        loadedBytes += romEntry->dataSize;
+    }
+
+    uint64 hashTime = Scheduler::Now() - startTime;
+
+    Info(Tag, "%u ROMs, %u lookups of each kind (%" PRIu64 " bytes loaded).", numberOfRoms, numberOfLookups, loadedBytes);
+    printf("%-18s %10.3f us\n", "open + validate", openTime / 1e3);
+    printf("%-18s %10.1f ns\n", "name + load", static_cast<double>(nameTime) / numberOfLookups);
+    printf("%-18s %10.1f ns\n", "hash + load", static_cast<double>(hashTime) / numberOfLookups);
+    return 0;
+}
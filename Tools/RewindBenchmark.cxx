@@ -0,0 +1,126 @@
+/*
+ * RewindBenchmark.cxx
+ *
+ * This file is part of the Chip8++ source code.
+ * Copyright 2023 Patrick Melo <patrick@patrickmelo.com.br>
+ */
+
+#include "Chip8.hxx"
+#include "Core.hxx"
+#include "NullInterface.hxx"
+#include "Rewind.hxx"
+#include "Scheduler.hxx"
+
+// Constants
+
+static constexpr charconst Tag = "RewindBenchmark";
+
+// Benchmark
+
+int main(int numberOfArguments, char** argumentsValues) {
+    charconst  programPath    = numberOfArguments > 1 ? argumentsValues[1] : "Pong.ch8";
+    uint       numberOfFrames = numberOfArguments > 2 ? strtoul(argumentsValues[2], NULL, 10) : 30 * Chip8::FrameRate;
+    uint       rewindFrames   = numberOfArguments > 3 ? strtoul(argumentsValues[3], NULL, 10) : 5 * Chip8::FrameRate;
+    Chip8::RAM mainMemory;
+
+    if (rewindFrames >= numberOfFrames) {
+        rewindFrames = numberOfFrames - 1;
+    }
+
+    memset(mainMemory, 0, sizeof(mainMemory));
+
+    if (!Chip8::LoadProgram(programPath, mainMemory)) {
+        return 1;
+    }
+
+    Chip8         chip8;
+    NullInterface nullInterface;
+    Rewind        rewindBuffer;
+
+    nullInterface.Initialize(&chip8);
+    chip8.SetRAM(&mainMemory);
+    chip8.SetEngine(Chip8::Predecoded);
+    chip8.Reset();
+
+    if (!rewindBuffer.Initialize(&chip8)) {
+        return 1;
+    }
+
+    // Record, keeping the state the rewind should land on and the one the replay should reach.
+
+    uint8 expectedState[Chip8::StateSize];
+    uint8 finalState[Chip8::StateSize];
+    uint8 currentState[Chip8::StateSize];
+
+    uint64 startTime = Scheduler::Now();
+
+    chip8.RunFrames(numberOfFrames - rewindFrames);
+    chip8.SaveState(expectedState, sizeof(expectedState));
+    chip8.RunFrames(rewindFrames);
+    chip8.SaveState(finalState, sizeof(finalState));
+
+    uint64 recordTime = Scheduler::Now() - startTime;
+
+    Info(Tag, "%u frames recorded in %" PRIu64 " us: %u held, %u keyframes, %u bytes used (limit %u).", numberOfFrames, recordTime / 1000, rewindBuffer.GetFrameCount(), rewindBuffer.GetKeyframeCount(), rewindBuffer.GetMemoryUsage(), Rewind::DefaultMemoryLimit);
+
+    // Rewind, then replay the same frames
+
+    startTime = Scheduler::Now();
+
+    uint steppedFrames = rewindBuffer.StepBack(rewindFrames);
+
+    uint64 rewindTime = Scheduler::Now() - startTime;
+
+    chip8.SaveState(currentState, sizeof(currentState));
+    bool isRewindExact = memcmp(currentState, expectedState, sizeof(currentState)) == 0;
+
+    chip8.RunFrames(rewindFrames);
+    chip8.SaveState(currentState, sizeof(currentState));
+    bool isReplayExact = memcmp(currentState, finalState, sizeof(currentState)) == 0;
+
+    nullInterface.Finalize();
+    rewindBuffer.Finalize();
+
+    Info(Tag, "Stepped back %u frames in %.3f ms (rewind %s, replay %s).", steppedFrames, rewindTime / 1e6, isRewindExact ? "exact" : "MISMATCH", isReplayExact ? "exact" : "MISMATCH");
+
+    // Maximum call depth: 15 nested calls (each 2NNN calls the next one) and a spin, the deepest stack 2NNN leaves
+    // behind, has to be captured and stepped back to like any other frame.
+
+    Chip8::RAM    deepMemory;
+    Chip8         deepChip8;
+    NullInterface deepInterface;
+    Rewind        deepRewind;
+
+    memset(deepMemory, 0, sizeof(deepMemory));
+
+    for (uint callIndex = 0; callIndex <= 15; ++callIndex) {
+        uint16 instructionAddress = Chip8::ProgramStartAddress + (callIndex * 2);
+        uint16 instruction        = (callIndex < 15) ? (0x2000 | (instructionAddress + 2)) : (0x1000 | instructionAddress);
+
+        deepMemory[instructionAddress]     = instruction >> 8;
+        deepMemory[instructionAddress + 1] = instruction & 0xFF;
+    }
+
+    deepInterface.Initialize(&deepChip8);
+    deepChip8.SetRAM(&deepMemory);
+    deepChip8.SetEngine(Chip8::Predecoded);
+    deepChip8.Reset();
+
+    if (!deepRewind.Initialize(&deepChip8)) {
+        return 1;
+    }
+
+    deepChip8.RunFrames(Chip8::FrameRate);
+    deepChip8.SaveState(expectedState, sizeof(expectedState));
+    deepChip8.RunFrames(1);
+
+    uint deepFrames  = deepRewind.StepBack(1);
+    deepChip8.SaveState(currentState, sizeof(currentState));
+    bool isDeepExact = (deepFrames == 1) && (memcmp(currentState, expectedState, sizeof(currentState)) == 0);
+
+    deepInterface.Finalize();
+    deepRewind.Finalize();
+
+    Info(Tag, "Maximum call depth step back %s.", isDeepExact ? "exact" : "MISMATCH");
+    return (isRewindExact && isReplayExact && isDeepExact) ? 0 : 1;
+}
@@ -0,0 +1,248 @@
+/*
+ * RomPacker.cxx
+ *
+ * This file is part of the Chip8++ source code.
+ * Copyright 2023 Patrick Melo <patrick@patrickmelo.com.br>
+ */
+
+#include "Chip8.hxx"
+#include "Core.hxx"
+#include "RomPack.hxx"
+
+#include <algorithm>
+
+// Constants
+
+static constexpr charconst Tag = "RomPacker";
+
+// ROMs
+
+struct PackedRom {
+        string             romName;
+        std::vector<uint8> romData;
+        RomPack::Entry     romEntry;
+};
+
+static bool ReadRom(charconst romPath, PackedRom& packedRom) {
+    FILE* romFile = fopen(romPath, "rb");
+
+    if (!romFile) {
+        Error(Tag, "Could not open %s.", romPath);
+        return false;
+    }
+
+    fseeko(romFile, 0, SEEK_END);
+    off_t romSize = ftello(romFile);
+    fseeko(romFile, 0, SEEK_SET);
+
+    if ((romSize <= 0) || (romSize > (Chip8::MaximumMemorySize - Chip8::ProgramStartAddress))) {
+        Error(Tag, "%s does not fit in %u bytes of memory.", romPath, Chip8::MaximumMemorySize);
+        fclose(romFile);
+        return false;
+    }
+
+    packedRom.romData.resize(romSize);
+
+    if (fread(packedRom.romData.data(), romSize, 1, romFile) != 1) {
+        Error(Tag, "Could not read %s.", romPath);
+        fclose(romFile);
+        return false;
+    }
+
+    fclose(romFile);
+
+    charconst nameStart = strrchr(romPath, '/');
+    packedRom.romName   = nameStart ? nameStart + 1 : romPath;
+
+    memset(&packedRom.romEntry, 0, sizeof(packedRom.romEntry));
+    packedRom.romEntry.contentHash = RomPack::Hash(packedRom.romData.data(), packedRom.romData.size());
+    packedRom.romEntry.dataSize    = packedRom.romData.size();
+    return true;
+}
+
+static Chip8::QuirkProfile DetectQuirkProfile(charconst romPath, const PackedRom& packedRom) {
+    // The detection looks at the first 4 KB, laid out as the machine would see them.
+
+    Chip8::RAM scanMemory;
+
+    memset(scanMemory, 0, sizeof(scanMemory));
+    memcpy(&scanMemory[Chip8::ProgramStartAddress], packedRom.romData.data(), std::min<size_t>(packedRom.romData.size(), sizeof(scanMemory) - Chip8::ProgramStartAddress));
+
+    return Chip8::DetectQuirkProfile(romPath, scanMemory);
+}
+
+// Writing
+
+static uint32 AlignOffset(uint64 fileOffset) {
+    return (fileOffset + RomPack::DataAlignment - 1) & ~UINT64(RomPack::DataAlignment - 1);
+}
+
+static bool WritePadding(FILE* packFile, uint64 fileOffset, uint64 alignedOffset) {
+    static const uint8 PaddingData[RomPack::DataAlignment] = {0};
+    return (alignedOffset == fileOffset) || (fwrite(PaddingData, alignedOffset - fileOffset, 1, packFile) == 1);
+}
+
+static bool WritePack(charconst packPath, std::vector<PackedRom>& packedRoms) {
+    // Entries are sorted by hash, the name index by name. Same-hash entries keep the name order, so lookups by hash
+    // always find the same one.
+
+    std::sort(packedRoms.begin(), packedRoms.end(), [](const PackedRom& leftRom, const PackedRom& rightRom) {
+        return leftRom.romName < rightRom.romName;
+    });
+
+    for (uint romIndex = 1; romIndex < packedRoms.size(); ++romIndex) {
+        if (packedRoms[romIndex].romName == packedRoms[romIndex - 1].romName) {
+            Error(Tag, "%s is packed twice.", packedRoms[romIndex].romName.c_str());
+            return false;
+        }
+    }
+
+    std::stable_sort(packedRoms.begin(), packedRoms.end(), [](const PackedRom& leftRom, const PackedRom& rightRom) {
+        return leftRom.romEntry.contentHash < rightRom.romEntry.contentHash;
+    });
+
+    std::vector<uint32> nameIndex(packedRoms.size());
+
+    for (uint romIndex = 0; romIndex < packedRoms.size(); ++romIndex) {
+        nameIndex[romIndex] = romIndex;
+    }
+
+    std::sort(nameIndex.begin(), nameIndex.end(), [&packedRoms](uint32 leftIndex, uint32 rightIndex) {
+        return strcmp(packedRoms[leftIndex].romName.c_str(), packedRoms[rightIndex].romName.c_str()) < 0;
+    });
+
+    // Offsets: header, entries, name index, names, then the images.
+
+    RomPack::Header packHeader;
+    string          packNames;
+
+    for (uint romIndex = 0; romIndex < packedRoms.size(); ++romIndex) {
+        packedRoms[romIndex].romEntry.nameOffset = packNames.size();
+        packNames.append(packedRoms[romIndex].romName.c_str(), packedRoms[romIndex].romName.size() + 1);
+    }
+
+    if (packNames.empty()) {
+        packNames.push_back(0);
+    }
+
+    uint64 fileOffset = sizeof(packHeader);
+
+    packHeader.magic           = RomPack::PackMagic;
+    packHeader.version         = RomPack::PackVersion;
+    packHeader.entrySize       = sizeof(RomPack::Entry);
+    packHeader.numberOfRoms    = packedRoms.size();
+    packHeader.entriesOffset   = fileOffset;
+    packHeader.nameIndexOffset = fileOffset += packedRoms.size() * sizeof(RomPack::Entry);
+    packHeader.namesOffset     = fileOffset += packedRoms.size() * sizeof(uint32);
+    packHeader.namesSize       = packNames.size();
+    fileOffset += packNames.size();
+
+    for (uint romIndex = 0; romIndex < packedRoms.size(); ++romIndex) {
+        fileOffset                               = AlignOffset(fileOffset);
+        packedRoms[romIndex].romEntry.dataOffset = fileOffset;
+        fileOffset += packedRoms[romIndex].romData.size();
+    }
+
+    if (fileOffset > 0xFFFFFFFF) {
+        Error(Tag, "The pack would be larger than 4 GB.");
+        return false;
+    }
+
+    packHeader.fileSize = fileOffset;
+
+    // Everything goes out in file order.
+
+    FILE* packFile = fopen(packPath, "wb");
+
+    if (!packFile) {
+        Error(Tag, "Could not write %s.", packPath);
+        return false;
+    }
+
+    bool isWritten = fwrite(&packHeader, sizeof(packHeader), 1, packFile) == 1;
+
+    for (uint romIndex = 0; isWritten && (romIndex < packedRoms.size()); ++romIndex) {
+        isWritten = fwrite(&packedRoms[romIndex].romEntry, sizeof(RomPack::Entry), 1, packFile) == 1;
+    }
+
+    isWritten = isWritten && (nameIndex.empty() || (fwrite(nameIndex.data(), nameIndex.size() * sizeof(uint32), 1, packFile) == 1));
+    isWritten = isWritten && (fwrite(packNames.data(), packNames.size(), 1, packFile) == 1);
+    fileOffset = packHeader.namesOffset + packHeader.namesSize;
+
+    for (uint romIndex = 0; isWritten && (romIndex < packedRoms.size()); ++romIndex) {
+        isWritten  = WritePadding(packFile, fileOffset, packedRoms[romIndex].romEntry.dataOffset) && (fwrite(packedRoms[romIndex].romData.data(), packedRoms[romIndex].romData.size(), 1, packFile) == 1);
+        fileOffset = packedRoms[romIndex].romEntry.dataOffset + packedRoms[romIndex].romData.size();
+    }
+
+    if (fclose(packFile) != 0) {
+        isWritten = false;
+    }
+
+    if (!isWritten) {
+        Error(Tag, "Could not write %s.", packPath);
+        return false;
+    }
+
+    Info(Tag, "%u ROMs packed into %s (%u bytes).", packHeader.numberOfRoms, packPath, packHeader.fileSize);
+    return true;
+}
+
+// Packer
+
+int main(int numberOfArguments, char** argumentsValues) {
+    charconst              packPath             = NULL;
+    bool                   hasQuirkProfile      = false;    // Otherwise the profile is detected per ROM
+    Chip8::QuirkProfile    quirkProfile         = Chip8::QuirksVIP;
+    uint                   instructionsPerFrame = 0;
+    std::vector<PackedRom> packedRoms;
+
+    // The metadata options apply to the ROMs that follow them.
+
+    for (int argumentIndex = 1; argumentIndex < numberOfArguments; ++argumentIndex) {
+        charconst argumentValue = argumentsValues[argumentIndex];
+        bool      hasValue      = (argumentIndex + 1) < numberOfArguments;
+
+        if ((strcmp(argumentValue, "--output") == 0) && hasValue) {
+            packPath = argumentsValues[++argumentIndex];
+        } else if ((strcmp(argumentValue, "--quirks") == 0) && hasValue) {
+            charconst profileName = argumentsValues[++argumentIndex];
+
+            hasQuirkProfile = true;
+
+            if (strcmp(profileName, "auto") == 0) {
+                hasQuirkProfile = false;
+            } else if (strcmp(profileName, "vip") == 0) {
+                quirkProfile = Chip8::QuirksVIP;
+            } else if (strcmp(profileName, "chip48") == 0) {
+                quirkProfile = Chip8::QuirksCHIP48;
+            } else if (strcmp(profileName, "schip") == 0) {
+                quirkProfile = Chip8::QuirksSCHIP;
+            } else {
+                Error(Tag, "Unknown quirk profile: %s", profileName);
+                return 1;
+            }
+        } else if ((strcmp(argumentValue, "--ipf") == 0) && hasValue) {
+            instructionsPerFrame = std::min<ulong>(strtoul(argumentsValues[++argumentIndex], NULL, 10), 0xFFFF);
+        } else if (argumentValue[0] == '-') {
+            Error(Tag, "Unknown option: %s", argumentValue);
+            return 1;
+        } else {
+            PackedRom packedRom;
+
+            if (!ReadRom(argumentValue, packedRom)) {
+                return 1;
+            }
+
+            packedRom.romEntry.quirkProfile         = hasQuirkProfile ? quirkProfile : DetectQuirkProfile(argumentValue, packedRom);
+            packedRom.romEntry.instructionsPerFrame = instructionsPerFrame;
+            packedRoms.push_back(packedRom);
+        }
+    }
+
+    if (!packPath || packedRoms.empty()) {
+        printf("Usage: %s --output <pack> [--quirks <auto*|vip|chip48|schip>] [--ipf <instructions per frame>] <program> [[options] <program> ...]\n", argumentsValues[0]);
+        return 1;
+    }
+
+    return WritePack(packPath, packedRoms) ? 0 : 1;
+}
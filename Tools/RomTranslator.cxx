@@ -0,0 +1,660 @@
+/*
+ * RomTranslator.cxx
+ *
+ * This file is part of the Chip8++ source code.
+ * Copyright 2023 Patrick Melo <patrick@patrickmelo.com.br>
+ */
+
+#include "Chip8.hxx"
+#include "Core.hxx"
+#include "Translation.hxx"
+
+// Constants
+
+static constexpr charconst Tag = "RomTranslator";
+
+// Instructions (how each one is translated)
+
+enum InstructionKind {
+    KindInline,          // Straight C++ against the machine state
+    KindStep,            // Run by the predecoded cache, the block goes on
+    KindWrite,           // Run by the predecoded cache, ends the block since it may write code (FX33, FX55)
+    KindSkip,            // 3XNN, 4XNN, 5XY0, 9XY0
+    KindStepSkip,        // EX9E, EXA1, run by the predecoded cache
+    KindJump,            // 1NNN
+    KindCall,            // 2NNN, run by the predecoded cache for its stack checks
+    KindReturn,          // 00EE, same
+    KindComputedJump,    // BNNN
+    KindFallback         // Never translated: stops the batch (FX0A, 00FD), switches memory modes or is unknown
+};
+
+static bool IsBlockEnd(uint8 instructionKind) {
+    return (instructionKind != KindInline) && (instructionKind != KindStep);
+}
+
+// Program
+
+struct Program {
+        string              programName;
+        Chip8::RAM          programMemory;
+        uint                programSize;
+        uint16              endAddress;    // Code is only translated below it, and below 4 KB
+        Chip8::QuirkProfile quirkProfile;
+        bool                shiftUsesVY;
+        bool                logicResetsVF;
+        bool                jumpUsesVX;
+};
+
+struct Analysis {
+        uint8  instructionKinds[sizeof(Chip8::RAM)];
+        bool   isReached[sizeof(Chip8::RAM)];
+        bool   isLeader[sizeof(Chip8::RAM)];
+        uint8  blockInstructions[sizeof(Chip8::RAM)];    // At the first address of every block
+        uint16 blockAddresses[sizeof(Chip8::RAM)];       // The block every translated instruction belongs to
+        uint   reachedInstructions;
+        uint   translatedInstructions;
+        uint   numberOfBlocks;
+};
+
+template <Chip8::QuirkProfile Profile> static void SetQuirks(Program& program) {
+    program.shiftUsesVY   = Chip8::Quirks<Profile>::ShiftUsesVY;
+    program.logicResetsVF = Chip8::Quirks<Profile>::LogicResetsVF;
+    program.jumpUsesVX    = Chip8::Quirks<Profile>::JumpUsesVX;
+}
+
+static bool ReadProgram(charconst programPath, Program& program) {
+    FILE* programFile = fopen(programPath, "rb");
+
+    if (!programFile) {
+        Error(Tag, "Could not open %s.", programPath);
+        return false;
+    }
+
+    fseeko(programFile, 0, SEEK_END);
+    off_t programSize = ftello(programFile);
+    fseeko(programFile, 0, SEEK_SET);
+
+    // Code only runs from the first 4 KB, larger (MEGA-CHIP) programs are left to the other engines.
+
+    if ((programSize <= 0) || (programSize > (sizeof(Chip8::RAM) - Chip8::ProgramStartAddress))) {
+        Error(Tag, "%s does not fit in %u bytes of memory.", programPath, UINT32(sizeof(Chip8::RAM)));
+        fclose(programFile);
+        return false;
+    }
+
+    memset(program.programMemory, 0, sizeof(program.programMemory));
+
+    if (fread(&program.programMemory[Chip8::ProgramStartAddress], programSize, 1, programFile) != 1) {
+        Error(Tag, "Could not read %s.", programPath);
+        fclose(programFile);
+        return false;
+    }
+
+    fclose(programFile);
+
+    charconst nameStart = strrchr(programPath, '/');
+
+    program.programName = nameStart ? nameStart + 1 : programPath;
+    program.programSize = programSize;
+    program.endAddress  = Chip8::ProgramStartAddress + programSize;
+    return true;
+}
+
+static uint16 ReadOpCode(const Program& program, uint16 address) {
+    return (program.programMemory[address] << 8) | program.programMemory[address + 1];
+}
+
+// Control Flow (recursive disassembly from the start address, only what can be reached is translated)
+
+static uint8 GetInstructionKind(const Chip8::Instruction& instruction) {
+    switch (instruction.operation) {
+        case Chip8::Operation6XNN:
+        case Chip8::Operation7XNN:
+        case Chip8::Operation8XY0:
+        case Chip8::Operation8XY1:
+        case Chip8::Operation8XY2:
+        case Chip8::Operation8XY3:
+        case Chip8::Operation8XY4:
+        case Chip8::Operation8XY5:
+        case Chip8::Operation8XY6:
+        case Chip8::Operation8XY7:
+        case Chip8::Operation8XYE:
+        case Chip8::OperationANNN:
+        case Chip8::OperationFX07:
+        case Chip8::OperationFX15:
+        case Chip8::OperationFX1E:
+        case Chip8::OperationFX29: return KindInline;
+
+        case Chip8::Operation00E0:
+        case Chip8::Operation00BN:
+        case Chip8::Operation00CN:
+        case Chip8::Operation00FB:
+        case Chip8::Operation00FC:
+        case Chip8::Operation00FE:
+        case Chip8::Operation00FF:
+        case Chip8::OperationCXNN:
+        case Chip8::OperationDXYN:
+        case Chip8::OperationFX18:
+        case Chip8::OperationFX30:
+        case Chip8::OperationFX65:
+        case Chip8::OperationFX75:
+        case Chip8::OperationFX85: return KindStep;
+
+        case Chip8::OperationFX33:
+        case Chip8::OperationFX55: return KindWrite;
+
+        case Chip8::Operation3XNN:
+        case Chip8::Operation4XNN:
+        case Chip8::Operation5XY0:
+        case Chip8::Operation9XY0: return KindSkip;
+
+        case Chip8::OperationEX9E:
+        case Chip8::OperationEXA1: return KindStepSkip;
+
+        case Chip8::Operation1NNN: return KindJump;
+        case Chip8::Operation2NNN: return KindCall;
+        case Chip8::Operation00EE: return KindReturn;
+        case Chip8::OperationBNNN: return KindComputedJump;
+    }
+
+    return KindFallback;
+}
+
+static void Analyze(const Program& program, Analysis& analysis) {
+    memset(&analysis, 0, sizeof(analysis));
+
+    std::vector<uint16> pendingAddresses(1, Chip8::ProgramStartAddress);
+    analysis.isLeader[Chip8::ProgramStartAddress] = true;
+
+    auto addTarget = [&analysis, &pendingAddresses](uint targetAddress) {
+        if (targetAddress < sizeof(Chip8::RAM)) {
+            analysis.isLeader[targetAddress] = true;
+            pendingAddresses.push_back(targetAddress);
+        }
+    };
+
+    while (!pendingAddresses.empty()) {
+        uint16 instructionAddress = pendingAddresses.back();
+        pendingAddresses.pop_back();
+
+        if ((instructionAddress < Chip8::ProgramStartAddress) || ((instructionAddress + 1) >= program.endAddress) || analysis.isReached[instructionAddress]) {
+            continue;
+        }
+
+        Chip8::Instruction instruction;
+        Chip8::Decode(ReadOpCode(program, instructionAddress), instruction);
+
+        uint8 instructionKind = GetInstructionKind(instruction);
+
+        analysis.instructionKinds[instructionAddress] = instructionKind;
+        analysis.isReached[instructionAddress]        = true;
+        analysis.reachedInstructions++;
+
+        switch (instructionKind) {
+            case KindInline:
+            case KindStep: pendingAddresses.push_back(instructionAddress + 2); break;
+
+            case KindWrite: addTarget(instructionAddress + 2); break;
+            case KindJump: addTarget(instruction.address); break;
+
+            case KindSkip:
+            case KindStepSkip: {
+                addTarget(instructionAddress + 2);
+                addTarget(instructionAddress + 4);
+                break;
+            }
+
+            case KindCall: {
+                addTarget(instruction.address);
+                addTarget(instructionAddress + 2);    // Where 00EE comes back to
+                break;
+            }
+
+            case KindComputedJump: {
+                // Only the base is known. BNNN usually lands in a table of jumps there, which is followed entry by entry;
+                // anything else it lands on is found at run time and interpreted.
+
+                addTarget(instruction.address);
+
+                for (uint entryAddress = instruction.address; ((entryAddress + 1) < program.endAddress) && (entryAddress < (instruction.address + 256u)); entryAddress += 2) {
+                    Chip8::Instruction tableEntry;
+                    Chip8::Decode(ReadOpCode(program, entryAddress), tableEntry);
+
+                    if ((tableEntry.operation != Chip8::Operation1NNN) && (tableEntry.operation != Chip8::Operation2NNN)) {
+                        break;
+                    }
+
+                    addTarget(entryAddress);
+                }
+
+                break;
+            }
+
+            case KindFallback: {
+                // The interpreter runs it, translated code picks up again after it.
+
+                if ((instruction.operation == Chip8::OperationFX0A) || (instruction.operation == Chip8::Operation0010) || (instruction.operation == Chip8::Operation0011)) {
+                    addTarget(instructionAddress + 2);
+                }
+
+                break;
+            }
+        }
+    }
+
+    // Blocks run from a leader to the first end of straight-line code, or to the next leader.
+
+    for (uint blockAddress = Chip8::ProgramStartAddress; blockAddress < program.endAddress; ++blockAddress) {
+        if (!analysis.isReached[blockAddress] || !analysis.isLeader[blockAddress] || (analysis.instructionKinds[blockAddress] == KindFallback)) {
+            continue;
+        }
+
+        uint16 instructionAddress = blockAddress;
+        uint8  instructionCount   = 0;
+
+        while (true) {
+            analysis.blockAddresses[instructionAddress] = blockAddress;
+            instructionCount++;
+
+            if (IsBlockEnd(analysis.instructionKinds[instructionAddress])) {
+                break;
+            }
+
+            uint16 nextAddress = instructionAddress + 2;
+
+            if (instructionCount == Chip8::Translation::MaximumBlockInstructions) {
+                analysis.isLeader[nextAddress] = true;
+                break;
+            }
+
+            if (!analysis.isReached[nextAddress] || analysis.isLeader[nextAddress] || (analysis.instructionKinds[nextAddress] == KindFallback)) {
+                break;
+            }
+
+            instructionAddress = nextAddress;
+        }
+
+        analysis.blockInstructions[blockAddress] = instructionCount;
+        analysis.translatedInstructions += instructionCount;
+        analysis.numberOfBlocks++;
+    }
+}
+
+// Output
+
+static bool HasBlock(const Analysis& analysis, uint targetAddress) {
+    return (targetAddress < sizeof(Chip8::RAM)) && (analysis.blockInstructions[targetAddress] > 0);
+}
+
+static void WriteTransfer(FILE* outputFile, const Analysis& analysis, uint targetAddress, charconst indentation) {
+    if (HasBlock(analysis, targetAddress)) {
+        fprintf(outputFile, "%sgoto block_%03X;\n", indentation, targetAddress);
+    } else {
+        fprintf(outputFile, "%sPC = 0x%03X;\n", indentation, targetAddress);
+        fprintf(outputFile, "%sreturn retiredInstructions;\n", indentation);
+    }
+}
+
+static void WriteStep(FILE* outputFile, uint16 instructionAddress, uint remainingInstructions) {
+    // An instruction that stops the machine is not retired, nor is anything after it in the block.
+
+    fprintf(outputFile, "    PC = 0x%03X;\n\n", instructionAddress);
+    fprintf(outputFile, "    if (!Translation::Step(chip8)) {\n");
+    fprintf(outputFile, "        return retiredInstructions - %u;\n", remainingInstructions);
+    fprintf(outputFile, "    }\n");
+}
+
+static void WriteInstruction(FILE* outputFile, const Program& program, const Analysis& analysis, uint16 instructionAddress, uint remainingInstructions) {
+    Chip8::Instruction instruction;
+    char               disassembly[64];
+
+    Chip8::Decode(ReadOpCode(program, instructionAddress), instruction);
+    Chip8::Disassemble(instruction.opCode, disassembly, sizeof(disassembly));
+
+    uint  x              = instruction.registerX;
+    uint  y              = instruction.registerY;
+    uint  sourceRegister = program.shiftUsesVY ? y : x;
+    uint  nextAddress    = instructionAddress + 2;
+    uint8 kind           = analysis.instructionKinds[instructionAddress];
+
+    fprintf(outputFile, "instruction_%03X:    // %04X %s\n", instructionAddress, instruction.opCode, disassembly);
+
+    // Inline instructions are written the way their handlers in Chip8.cxx are, statement for statement.
+
+    switch (instruction.operation) {
+        case Chip8::Operation6XNN: fprintf(outputFile, "    V[0x%X] = 0x%02X;\n", x, instruction.value); return;
+        case Chip8::Operation7XNN: fprintf(outputFile, "    V[0x%X] += 0x%02X;\n", x, instruction.value); return;
+        case Chip8::Operation8XY0: fprintf(outputFile, "    V[0x%X] = V[0x%X];\n", x, y); return;
+
+        case Chip8::Operation8XY1:
+        case Chip8::Operation8XY2:
+        case Chip8::Operation8XY3: {
+            charconst logicOperator = instruction.operation == Chip8::Operation8XY1 ? "|=" : (instruction.operation == Chip8::Operation8XY2 ? "&=" : "^=");
+
+            fprintf(outputFile, "    V[0x%X] %s V[0x%X];\n", x, logicOperator, y);
+
+            if (program.logicResetsVF) {
+                fprintf(outputFile, "    V[0xF] = 0;\n");
+            }
+
+            return;
+        }
+
+        case Chip8::Operation8XY4: {
+            fprintf(outputFile, "    V[0xF] = UINT16(V[0x%X] + V[0x%X]) > 255;\n", x, y);
+            fprintf(outputFile, "    V[0x%X] += V[0x%X];\n", x, y);
+            return;
+        }
+
+        case Chip8::Operation8XY5: {
+            fprintf(outputFile, "    V[0xF] = !(V[0x%X] < V[0x%X]);\n", x, y);
+            fprintf(outputFile, "    V[0x%X] -= V[0x%X];\n", x, y);
+            return;
+        }
+
+        case Chip8::Operation8XY6: {
+            fprintf(outputFile, "    V[0xF] = V[0x%X] & 0x1;\n", sourceRegister);
+            fprintf(outputFile, "    V[0x%X] = V[0x%X] >> 1;\n", x, sourceRegister);
+            return;
+        }
+
+        case Chip8::Operation8XY7: {
+            fprintf(outputFile, "    V[0xF] = !(V[0x%X] < V[0x%X]);\n", y, x);
+            fprintf(outputFile, "    V[0x%X] = V[0x%X] - V[0x%X];\n", x, y, x);
+            return;
+        }
+
+        case Chip8::Operation8XYE: {
+            fprintf(outputFile, "    V[0xF] = V[0x%X] >> 7;\n", sourceRegister);
+            fprintf(outputFile, "    V[0x%X] = V[0x%X] << 1;\n", x, sourceRegister);
+            return;
+        }
+
+        case Chip8::OperationANNN: fprintf(outputFile, "    I = 0x%03X;\n", instruction.address); return;
+        case Chip8::OperationFX07: fprintf(outputFile, "    V[0x%X] = DT;\n", x); return;
+        case Chip8::OperationFX15: fprintf(outputFile, "    DT = V[0x%X];\n", x); return;
+        case Chip8::OperationFX1E: fprintf(outputFile, "    I = (I + V[0x%X]) & Chip8::AddressMask;\n", x); return;
+        case Chip8::OperationFX29: fprintf(outputFile, "    I = Chip8::FontStartAddress + (V[0x%X] * 5);\n", x); return;
+    }
+
+    switch (kind) {
+        case KindStep: {
+            WriteStep(outputFile, instructionAddress, remainingInstructions);
+            break;
+        }
+
+        case KindWrite: {
+            WriteStep(outputFile, instructionAddress, remainingInstructions);
+            fprintf(outputFile, "\n");
+            WriteTransfer(outputFile, analysis, nextAddress, "    ");
+            break;
+        }
+
+        case KindSkip: {
+            charconst comparison = (instruction.operation == Chip8::Operation3XNN) || (instruction.operation == Chip8::Operation5XY0) ? "==" : "!=";
+
+            if ((instruction.operation == Chip8::Operation3XNN) || (instruction.operation == Chip8::Operation4XNN)) {
+                fprintf(outputFile, "    if (V[0x%X] %s 0x%02X) {\n", x, comparison, instruction.value);
+            } else {
+                fprintf(outputFile, "    if (V[0x%X] %s V[0x%X]) {\n", x, comparison, y);
+            }
+
+            WriteTransfer(outputFile, analysis, instructionAddress + 4, "        ");
+            fprintf(outputFile, "    }\n\n");
+            WriteTransfer(outputFile, analysis, nextAddress, "    ");
+            break;
+        }
+
+        case KindStepSkip: {
+            WriteStep(outputFile, instructionAddress, remainingInstructions);
+            fprintf(outputFile, "\n    if (PC != 0x%03X) {\n", nextAddress);
+            WriteTransfer(outputFile, analysis, instructionAddress + 4, "        ");
+            fprintf(outputFile, "    }\n\n");
+            WriteTransfer(outputFile, analysis, nextAddress, "    ");
+            break;
+        }
+
+        case KindJump: {
+            WriteTransfer(outputFile, analysis, instruction.address, "    ");
+            break;
+        }
+
+        case KindCall: {
+            WriteStep(outputFile, instructionAddress, remainingInstructions);
+            fprintf(outputFile, "\n");
+            WriteTransfer(outputFile, analysis, instruction.address, "    ");
+            break;
+        }
+
+        case KindReturn: {
+            WriteStep(outputFile, instructionAddress, remainingInstructions);
+            fprintf(outputFile, "\n    goto dispatch;\n");
+            break;
+        }
+
+        case KindComputedJump: {
+            fprintf(outputFile, "    PC = 0x%03X + V[0x%X];\n", instruction.address, program.jumpUsesVX ? x : 0);
+            fprintf(outputFile, "    goto dispatch;\n");
+            break;
+        }
+    }
+}
+
+static charconst ListSeparator(uint itemIndex, uint itemsPerLine) {
+    if (itemIndex == 0) {
+        return "\n    ";
+    }
+
+    return (itemIndex % itemsPerLine) == 0 ? ",\n    " : ", ";
+}
+
+static bool WriteTranslation(charconst outputPath, const Program& program, const Analysis& analysis) {
+    FILE* outputFile = fopen(outputPath, "w");
+
+    if (!outputFile) {
+        Error(Tag, "Could not write %s.", outputPath);
+        return false;
+    }
+
+    charconst profileNames[] = {"COSMAC VIP", "CHIP-48", "SUPER-CHIP"};
+    charconst nameStart      = strrchr(outputPath, '/');
+
+    fprintf(outputFile, "/*\n");
+    fprintf(outputFile, " * %s\n", nameStart ? nameStart + 1 : outputPath);
+    fprintf(outputFile, " *\n");
+    fprintf(outputFile, " * Translated from %s (%u bytes, %s quirks) by RomTranslator, do not edit.\n", program.programName.c_str(), program.programSize, profileNames[program.quirkProfile]);
+    fprintf(outputFile, " * %u of the %u reachable instructions are translated, in %u blocks.\n", analysis.translatedInstructions, analysis.reachedInstructions, analysis.numberOfBlocks);
+    fprintf(outputFile, " */\n\n");
+    fprintf(outputFile, "#include \"Translation.hxx\"\n\n");
+    fprintf(outputFile, "namespace {\n\n");
+
+    // The image the translation was made from, and its blocks.
+
+    fprintf(outputFile, "// Program\n\n");
+    fprintf(outputFile, "const uint8 ProgramData[] = {");
+
+    for (uint byteIndex = 0; byteIndex < program.programSize; ++byteIndex) {
+        fprintf(outputFile, "%s0x%02X", ListSeparator(byteIndex, 16), program.programMemory[Chip8::ProgramStartAddress + byteIndex]);
+    }
+
+    fprintf(outputFile, "\n};\n\n");
+    fprintf(outputFile, "const Chip8::Translation::Block ProgramBlocks[] = {");
+
+    uint writtenBlocks = 0;
+
+    for (uint blockAddress = Chip8::ProgramStartAddress; blockAddress < program.endAddress; ++blockAddress) {
+        if (analysis.blockInstructions[blockAddress] > 0) {
+            fprintf(outputFile, "%s{0x%03X, %u}", ListSeparator(writtenBlocks++, 8), blockAddress, analysis.blockInstructions[blockAddress]);
+        }
+    }
+
+    fprintf(outputFile, "\n};\n\n");
+
+    // Code (one function, blocks go straight to the blocks they know, returns and computed jumps go through the dispatch)
+
+    fprintf(outputFile, "// Code\n\n");
+    fprintf(outputFile, "uint64 RunProgram(Chip8* chip8, const uint8* codeStates, uint64 numberOfCycles) {\n");
+    fprintf(outputFile, "    typedef Chip8::Translation Translation;\n\n");
+    fprintf(outputFile, "    uint8*  V                   = Translation::GetRegisters(chip8);\n");
+    fprintf(outputFile, "    uint32& I                   = Translation::GetAddressRegister(chip8);\n");
+    fprintf(outputFile, "    uint16& PC                  = Translation::GetProgramCounter(chip8);\n");
+    fprintf(outputFile, "    uint8&  DT                  = Translation::GetDelayTimer(chip8);\n");
+    fprintf(outputFile, "    uint64  retiredInstructions = 0;\n\n");
+    fprintf(outputFile, "    goto dispatch;\n");
+
+    for (uint blockAddress = Chip8::ProgramStartAddress; blockAddress < program.endAddress; ++blockAddress) {
+        uint instructionCount = analysis.blockInstructions[blockAddress];
+
+        if (instructionCount == 0) {
+            continue;
+        }
+
+        // A block only runs if it still holds what was translated and fits in the budget.
+
+        fprintf(outputFile, "\nblock_%03X:\n", blockAddress);
+        fprintf(outputFile, "    if (!codeStates[0x%03X] || ((numberOfCycles - retiredInstructions) < %u)) {\n", blockAddress, instructionCount);
+        fprintf(outputFile, "        PC = 0x%03X;\n", blockAddress);
+        fprintf(outputFile, "        return retiredInstructions;\n");
+        fprintf(outputFile, "    }\n\n");
+        fprintf(outputFile, "    retiredInstructions += %u;\n", instructionCount);
+
+        for (uint instructionIndex = 0; instructionIndex < instructionCount; ++instructionIndex) {
+            WriteInstruction(outputFile, program, analysis, blockAddress + (instructionIndex * 2), instructionCount - instructionIndex);
+        }
+
+        uint16 lastAddress = blockAddress + ((instructionCount - 1) * 2);
+
+        if (!IsBlockEnd(analysis.instructionKinds[lastAddress])) {
+            WriteTransfer(outputFile, analysis, lastAddress + 2, "    ");
+        }
+    }
+
+    // Every translated instruction can be entered, what is left of its block runs from there.
+
+    fprintf(outputFile, "\ndispatch:\n");
+    fprintf(outputFile, "    switch (PC) {\n");
+
+    for (uint instructionAddress = Chip8::ProgramStartAddress; instructionAddress < program.endAddress; ++instructionAddress) {
+        if (!analysis.isReached[instructionAddress] || (analysis.instructionKinds[instructionAddress] == KindFallback)) {
+            continue;
+        }
+
+        uint16 blockAddress          = analysis.blockAddresses[instructionAddress];
+        uint   remainingInstructions = analysis.blockInstructions[blockAddress] - ((instructionAddress - blockAddress) / 2);
+
+        if (blockAddress == instructionAddress) {
+            fprintf(outputFile, "        case 0x%03X: goto block_%03X;\n", instructionAddress, blockAddress);
+            continue;
+        }
+
+        fprintf(outputFile, "        case 0x%03X: {\n", instructionAddress);
+        fprintf(outputFile, "            if (!codeStates[0x%03X] || ((numberOfCycles - retiredInstructions) < %u)) {\n", instructionAddress, remainingInstructions);
+        fprintf(outputFile, "                return retiredInstructions;\n");
+        fprintf(outputFile, "            }\n\n");
+        fprintf(outputFile, "            retiredInstructions += %u;\n", remainingInstructions);
+        fprintf(outputFile, "            goto instruction_%03X;\n", instructionAddress);
+        fprintf(outputFile, "        }\n");
+    }
+
+    fprintf(outputFile, "    }\n\n");
+    fprintf(outputFile, "    return retiredInstructions;\n");
+    fprintf(outputFile, "}\n\n");
+
+    // Registration (the engine finds the translation by the program in memory)
+
+    fprintf(outputFile, "// Registration\n\n");
+    fprintf(outputFile, "Chip8::Translation::Program TranslatedProgram = {\"%s\", %u, ProgramData, sizeof(ProgramData), ProgramBlocks, sizeof(ProgramBlocks) / sizeof(ProgramBlocks[0]), RunProgram, NULL};\n\n", program.programName.c_str(), program.quirkProfile);
+    fprintf(outputFile, "Chip8::Translation::Registration ProgramRegistration(&TranslatedProgram);\n\n");
+    fprintf(outputFile, "}\n");
+
+    bool isWritten = ferror(outputFile) == 0;
+
+    if (fclose(outputFile) != 0 || !isWritten) {
+        Error(Tag, "Could not write %s.", outputPath);
+        return false;
+    }
+
+    return true;
+}
+
+int main(int numberOfArguments, char** argumentsValues) {
+    charconst programPath     = NULL;
+    charconst outputPath      = NULL;
+    bool      hasQuirkProfile = false;
+    Program   program;
+
+    for (int argumentIndex = 1; argumentIndex < numberOfArguments; ++argumentIndex) {
+        charconst argumentValue = argumentsValues[argumentIndex];
+        bool      hasValue      = (argumentIndex + 1) < numberOfArguments;
+
+        if ((strcmp(argumentValue, "--quirks") == 0) && hasValue) {
+            charconst profileName = argumentsValues[++argumentIndex];
+
+            if (strcmp(profileName, "vip") == 0) {
+                program.quirkProfile = Chip8::QuirksVIP;
+            } else if (strcmp(profileName, "chip48") == 0) {
+                program.quirkProfile = Chip8::QuirksCHIP48;
+            } else if (strcmp(profileName, "schip") == 0) {
+                program.quirkProfile = Chip8::QuirksSCHIP;
+            } else {
+                Error(Tag, "Unknown quirk profile: %s", profileName);
+                return 1;
+            }
+
+            hasQuirkProfile = true;
+        } else if ((argumentValue[0] != '-') && !programPath) {
+            programPath = argumentValue;
+        } else if ((argumentValue[0] != '-') && !outputPath) {
+            outputPath = argumentValue;
+        } else {
+            programPath = NULL;
+            break;
+        }
+    }
+
+    if (!programPath || !outputPath) {
+        printf("Usage: %s [--quirks <vip|chip48|schip>] <program> <output.cxx>\n", argumentsValues[0]);
+        return 1;
+    }
+
+    if (!ReadProgram(programPath, program)) {
+        return 1;
+    }
+
+    // The translation is made for one profile, the one the emulator would pick unless told otherwise.
+
+    if (!hasQuirkProfile) {
+        program.quirkProfile = Chip8::DetectQuirkProfile(programPath, program.programMemory);
+    }
+
+    switch (program.quirkProfile) {
+        case Chip8::QuirksCHIP48: SetQuirks<Chip8::QuirksCHIP48>(program); break;
+        case Chip8::QuirksSCHIP: SetQuirks<Chip8::QuirksSCHIP>(program); break;
+        default: SetQuirks<Chip8::QuirksVIP>(program); break;
+    }
+
+    Analysis* analysis = new (std::nothrow) Analysis;
+
+    if (!analysis) {
+        Error(Tag, "Could not allocate the analysis.");
+        return 1;
+    }
+
+    Analyze(program, *analysis);
+
+    if (analysis->numberOfBlocks == 0) {
+        Error(Tag, "Nothing in %s can be translated.", programPath);
+        delete analysis;
+        return 1;
+    }
+
+    if (!WriteTranslation(outputPath, program, *analysis)) {
+        delete analysis;
+        return 1;
+    }
+
+    Info(Tag, "%s: %u of %u reachable instructions translated in %u blocks.", program.programName.c_str(), analysis->translatedInstructions, analysis->reachedInstructions, analysis->numberOfBlocks);
+
+    delete analysis;
+    return 0;
+}
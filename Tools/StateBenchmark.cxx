@@ -0,0 +1,122 @@
+/*
+ * StateBenchmark.cxx
+ *
+ * This file is part of the Chip8++ source code.
+ * Copyright 2023 Patrick Melo <patrick@patrickmelo.com.br>
+ */
+
+#include "Chip8.hxx"
+#include "Core.hxx"
+#include "NullInterface.hxx"
+#include "Scheduler.hxx"
+
+// Constants
+
+static constexpr charconst Tag = "StateBenchmark";
+
+// Benchmark
+
+int main(int numberOfArguments, char** argumentsValues) {
+    charconst  programPath    = numberOfArguments > 1 ? argumentsValues[1] : "Pong.ch8";
+    uint       numberOfRounds = numberOfArguments > 2 ? strtoul(argumentsValues[2], NULL, 10) : 1000000;
+    Chip8::RAM mainMemory;
+
+    if (numberOfRounds < 100) {
+        numberOfRounds = 100;
+    }
+
+    memset(mainMemory, 0, sizeof(mainMemory));
+
+    if (!Chip8::LoadProgram(programPath, mainMemory)) {
+        return 1;
+    }
+
+    Chip8         chip8;
+    NullInterface nullInterface;
+
+    nullInterface.Initialize(&chip8);
+    chip8.SetRAM(&mainMemory);
+    chip8.SetEngine(Chip8::Predecoded);
+    chip8.Reset();
+    chip8.RunFrames(600);
+
+    uint8 stateBuffer[Chip8::StateSize];
+
+    // Save
+
+    uint64 startTime = Scheduler::Now();
+
+    for (uint roundIndex = 0; roundIndex < numberOfRounds; ++roundIndex) {
+        chip8.SaveState(stateBuffer, sizeof(stateBuffer));
+    }
+
+    uint64 saveTime = Scheduler::Now() - startTime;
+
+    // Restore (the snapshot matches the running machine, the common case when snapshotting every frame)
+
+    startTime = Scheduler::Now();
+
+    for (uint roundIndex = 0; roundIndex < numberOfRounds; ++roundIndex) {
+        chip8.LoadState(stateBuffer, sizeof(stateBuffer));
+    }
+
+    uint64 loadTime = Scheduler::Now() - startTime;
+
+    // Round trip with one frame of execution in between, so the restore has to undo real changes
+
+    uint64 frameTime = 0;
+    startTime        = Scheduler::Now();
+
+    for (uint roundIndex = 0; roundIndex < (numberOfRounds / 100); ++roundIndex) {
+        chip8.SaveState(stateBuffer, sizeof(stateBuffer));
+
+        uint64 frameStartTime = Scheduler::Now();
+        chip8.RunFrames(1);
+        frameTime += Scheduler::Now() - frameStartTime;
+
+        chip8.LoadState(stateBuffer, sizeof(stateBuffer));
+    }
+
+    uint64 roundTripTime = (Scheduler::Now() - startTime) - frameTime;
+
+    nullInterface.Finalize();
+
+    Info(Tag, "%u bytes per state, %u rounds.", Chip8::StateSize, numberOfRounds);
+    printf("%-12s %10.1f ns\n", "save", static_cast<double>(saveTime) / numberOfRounds);
+    printf("%-12s %10.1f ns\n", "load", static_cast<double>(loadTime) / numberOfRounds);
+    printf("%-12s %10.1f ns\n", "round trip", static_cast<double>(roundTripTime) / (numberOfRounds / 100));
+
+    // Maximum call depth: 15 nested calls (each 2NNN calls the next one) and a spin, the deepest stack 2NNN leaves
+    // behind, has to survive a round trip.
+
+    Chip8::RAM    deepMemory;
+    Chip8         deepChip8;
+    NullInterface deepInterface;
+    uint8         deepState[Chip8::StateSize];
+
+    memset(deepMemory, 0, sizeof(deepMemory));
+
+    for (uint callIndex = 0; callIndex <= 15; ++callIndex) {
+        uint16 instructionAddress = Chip8::ProgramStartAddress + (callIndex * 2);
+        uint16 instruction        = (callIndex < 15) ? (0x2000 | (instructionAddress + 2)) : (0x1000 | instructionAddress);
+
+        deepMemory[instructionAddress]     = instruction >> 8;
+        deepMemory[instructionAddress + 1] = instruction & 0xFF;
+    }
+
+    deepInterface.Initialize(&deepChip8);
+    deepChip8.SetRAM(&deepMemory);
+    deepChip8.SetEngine(Chip8::Predecoded);
+    deepChip8.Reset();
+    deepChip8.RunFrames(Chip8::FrameRate);
+
+    uint deepSize    = deepChip8.SaveState(stateBuffer, sizeof(stateBuffer));
+    bool isDeepExact = (deepSize == Chip8::StateSize) && deepChip8.LoadState(stateBuffer, deepSize);
+
+    isDeepExact = isDeepExact && (deepChip8.SaveState(deepState, sizeof(deepState)) == deepSize) && (memcmp(deepState, stateBuffer, deepSize) == 0);
+
+    deepInterface.Finalize();
+
+    Info(Tag, "Maximum call depth round trip %s.", isDeepExact ? "exact" : "MISMATCH");
+    return isDeepExact ? 0 : 1;
+}
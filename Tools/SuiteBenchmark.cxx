@@ -0,0 +1,436 @@
+/*
+ * SuiteBenchmark.cxx
+ *
+ * This file is part of the Chip8++ source code.
+ * Copyright 2023 Patrick Melo <patrick@patrickmelo.com.br>
+ */
+
+#include "Chip8.hxx"
+#include "Core.hxx"
+#include "NullInterface.hxx"
+#include "Scheduler.hxx"
+
+#include <algorithm>
+#include <sys/resource.h>
+
+// Constants
+
+static constexpr charconst Tag              = "SuiteBenchmark";
+static constexpr uint64    DefaultCycles    = 20000000;
+static constexpr uint64    KernelCycles     = 5000000;
+static constexpr uint      DefaultRounds    = 5;        // The fastest round counts for the times, the median one for the ratios
+static constexpr double    DefaultThreshold = 35.0;     // Percent, above the ratios' spread between runs on a busy host
+static constexpr uint16    KernelCodeEnd    = 0xE00;    // Kernels keep their memory writes at $F00, away from their code
+static constexpr uint      SpriteRows       = 15;
+
+static charconst DefaultPrograms[] = {"Maze.ch8", "Particle.ch8", "Pong.ch8", "Stars.ch8"};
+
+// Kernels (one opcode family each, the body is repeated over the code area and loops back)
+
+struct Kernel {
+        charconst name;
+        charconst description;
+        uint16    setupCode[4];
+        uint16    bodyCode[9];
+};
+
+static const Kernel Kernels[] = {
+    {"0", "00E0", {0}, {0x00E0}},
+    {"1", "1NNN (to the next address)", {0}, {0x1000}},
+    {"2", "2NNN + 00EE + 1NNN", {0}, {0}},
+    {"3", "3XNN (not taken)", {0x6000}, {0x3001}},
+    {"4", "4XNN (not taken)", {0x6000}, {0x4000}},
+    {"5", "5XY0 (not taken)", {0x6000, 0x6101}, {0x5010}},
+    {"6", "6XNN", {0}, {0x6012}},
+    {"7", "7XNN", {0}, {0x7001}},
+    {"8", "8XY0-8XYE", {0x6003, 0x6105}, {0x8010, 0x8011, 0x8012, 0x8013, 0x8014, 0x8015, 0x8016, 0x8017, 0x801E}},
+    {"9", "9XY0 (not taken)", {0x6000}, {0x9000}},
+    {"A", "ANNN", {0}, {0xA300}},
+    {"B", "BNNN (to the next address)", {0x6000}, {0xB000}},
+    {"C", "CXNN", {0}, {0xC0FF}},
+    {"D", "DXYF", {0x6003, 0x6100, 0xA200}, {0xD01F}},
+    {"E", "EX9E + EXA1", {0x6000}, {0xE09E, 0xE0A1}},
+    {"F", "FX07-FX65", {0x6000, 0xAF00}, {0xF007, 0xF015, 0xF018, 0xF01E, 0xF029, 0xAF00, 0xF033, 0xF055, 0xF065}},
+    {"S", "00CN + 00FB + 00FC (128x64)", {0x00FF}, {0x00C1, 0x00FB, 0x00FC}},
+    {"M", "DXYN 32x32 indexed (MEGA-CHIP)", {0x0011, 0x0320, 0x0420, 0xA400}, {0xD010}}};
+
+static void StoreOpCode(Chip8::RAM& mainMemory, uint16 address, uint16 opCode) {
+    mainMemory[address]     = opCode >> 8;
+    mainMemory[address + 1] = opCode & 0xFF;
+}
+
+static void BuildKernel(const Kernel& kernel, Chip8::RAM& mainMemory) {
+    uint16 address = Chip8::ProgramStartAddress;
+
+    for (uint setupIndex = 0; (setupIndex < 4) && kernel.setupCode[setupIndex]; ++setupIndex, address += 2) {
+        StoreOpCode(mainMemory, address, kernel.setupCode[setupIndex]);
+    }
+
+    uint16 loopAddress = address;
+
+    // Calls need a subroutine to return from, so they loop through a fixed sequence instead.
+
+    if (strcmp(kernel.name, "2") == 0) {
+        StoreOpCode(mainMemory, address, 0x2000 | (address + 6));
+        StoreOpCode(mainMemory, address + 2, 0x1000 | loopAddress);
+        StoreOpCode(mainMemory, address + 4, 0x1000 | loopAddress);
+        StoreOpCode(mainMemory, address + 6, 0x00EE);
+        return;
+    }
+
+    uint bodySize = 0;
+
+    while ((bodySize < 9) && kernel.bodyCode[bodySize]) {
+        bodySize++;
+    }
+
+    for (uint bodyIndex = 0; (address + 4) < KernelCodeEnd; ++bodyIndex, address += 2) {
+        uint16 opCode = kernel.bodyCode[bodyIndex % bodySize];
+
+        // Jumps go to the next instruction.
+
+        if ((opCode == 0x1000) || (opCode == 0xB000)) {
+            opCode |= address + 2;
+        }
+
+        StoreOpCode(mainMemory, address, opCode);
+    }
+
+    // Twice, so a skip from the last body instruction still loops.
+
+    StoreOpCode(mainMemory, address, 0x1000 | loopAddress);
+    StoreOpCode(mainMemory, address + 2, 0x1000 | loopAddress);
+}
+
+// Measurements
+
+struct Result {
+        string name;
+        string description;
+        uint64 count;
+        double nanosecondsEach;
+        double relativeTime;    // Against the interpreter in the same run, 0 when it was not measured
+};
+
+static uint64 RunRound(const Chip8::RAM& programMemory, Chip8::Engine engine, uint64 numberOfCycles, uint64& retiredInstructions) {
+    Chip8         chip8;
+    NullInterface nullInterface;
+    Chip8::RAM    mainMemory;
+
+    memcpy(mainMemory, programMemory, sizeof(Chip8::RAM));
+    nullInterface.Initialize(&chip8);
+    chip8.SetRAM(&mainMemory);
+    chip8.SetEngine(engine);
+    chip8.SetIdleSkipping(false);    // Every instruction runs, like the baseline and the interpreter
+    chip8.Reset();
+
+    // RunCycles never waits for the frame deadlines, the timers and the interface still tick at every frame boundary.
+
+    uint64 startTime = Scheduler::Now();
+    retiredInstructions = chip8.RunCycles(numberOfCycles);
+    uint64 elapsedTime = Scheduler::Now() - startTime;
+
+    nullInterface.Finalize();
+    return elapsedTime;
+}
+
+static double Measure(const Chip8::RAM& programMemory, Chip8::Engine engine, uint64 numberOfCycles, uint numberOfRounds, uint64& retiredInstructions, double& relativeTime) {
+    uint64              bestTime = 0;
+    uint64              referenceInstructions;
+    std::vector<double> roundRatios;
+
+    // The interpreter runs right before each round of the engine, so both see the same clock speed and load. The
+    // median of those pairs is kept, a slow moment only spoils the pair it falls in.
+
+    for (uint roundIndex = 0; roundIndex < numberOfRounds; ++roundIndex) {
+        uint64 referenceTime = 0;
+
+        if (engine != Chip8::Interpreter) {
+            referenceTime = RunRound(programMemory, Chip8::Interpreter, numberOfCycles, referenceInstructions);
+        }
+
+        uint64 elapsedTime = RunRound(programMemory, engine, numberOfCycles, retiredInstructions);
+
+        if ((roundIndex == 0) || (elapsedTime < bestTime)) {
+            bestTime = elapsedTime;
+        }
+
+        if ((referenceTime > 0) && (referenceInstructions > 0) && (retiredInstructions > 0)) {
+            roundRatios.push_back((static_cast<double>(elapsedTime) / retiredInstructions) / (static_cast<double>(referenceTime) / referenceInstructions));
+        }
+    }
+
+    relativeTime = 0;
+
+    if (!roundRatios.empty()) {
+        std::sort(roundRatios.begin(), roundRatios.end());
+        relativeTime = roundRatios[roundRatios.size() / 2];
+    }
+
+    return retiredInstructions > 0 ? static_cast<double>(bestTime) / retiredInstructions : 0.0;
+}
+
+static uint64 GetPeakMemory(void) {
+    rusage resourceUsage;
+    getrusage(RUSAGE_SELF, &resourceUsage);
+    return resourceUsage.ru_maxrss;    // Kilobytes on Linux
+}
+
+// Output
+
+static bool WriteCsv(const string filePath, charconst engineName, const std::vector<Result>& results) {
+    FILE* outputFile = fopen(filePath.c_str(), "w");
+
+    if (!outputFile) {
+        Error(Tag, "Could not write %s.", filePath.c_str());
+        return false;
+    }
+
+    fprintf(outputFile, "benchmark,engine,count,ns_each,per_second,vs_interpreter\n");
+
+    for (uint resultIndex = 0; resultIndex < results.size(); ++resultIndex) {
+        const Result& currentResult = results[resultIndex];
+        fprintf(outputFile, "%s,%s,%" PRIu64 ",%.3f,%.0f,%.4f\n", currentResult.name.c_str(), engineName, currentResult.count, currentResult.nanosecondsEach, currentResult.nanosecondsEach > 0 ? 1e9 / currentResult.nanosecondsEach : 0.0, currentResult.relativeTime);
+    }
+
+    fclose(outputFile);
+    return true;
+}
+
+static bool WriteJson(const string filePath, charconst engineName, const std::vector<Result>& results) {
+    FILE* outputFile = fopen(filePath.c_str(), "w");
+
+    if (!outputFile) {
+        Error(Tag, "Could not write %s.", filePath.c_str());
+        return false;
+    }
+
+    fprintf(outputFile, "{\n  \"engine\": \"%s\",\n  \"results\": [\n", engineName);
+
+    for (uint resultIndex = 0; resultIndex < results.size(); ++resultIndex) {
+        const Result& currentResult = results[resultIndex];
+
+        fprintf(outputFile,
+                "    {\"benchmark\": \"%s\", \"description\": \"%s\", \"count\": %" PRIu64 ", \"ns_each\": %.3f, \"per_second\": %.0f, \"vs_interpreter\": %.4f}%s\n",
+                currentResult.name.c_str(),
+                currentResult.description.c_str(),
+                currentResult.count,
+                currentResult.nanosecondsEach,
+                currentResult.nanosecondsEach > 0 ? 1e9 / currentResult.nanosecondsEach : 0.0,
+                currentResult.relativeTime,
+                (resultIndex + 1) < results.size() ? "," : "");
+    }
+
+    fprintf(outputFile, "  ]\n}\n");
+    fclose(outputFile);
+    return true;
+}
+
+// Comparison (only timed results count, a regression is being slower than the baseline by more than the threshold). The
+// other engines are compared by their time relative to the interpreter measured in the same run, which cancels out the
+// host and its clock speed, only the interpreter itself is compared by absolute time.
+
+static bool Compare(const string filePath, charconst engineName, const std::vector<Result>& results, double thresholdPercent) {
+    FILE* baselineFile = fopen(filePath.c_str(), "r");
+
+    if (!baselineFile) {
+        Error(Tag, "Could not open the baseline %s.", filePath.c_str());
+        return false;
+    }
+
+    bool isRelative          = strcmp(engineName, "interpreter") != 0;
+    char lineBuffer[256];
+    uint numberOfCompared    = 0;
+    uint numberOfRegressions = 0;
+
+    printf("\n%-20s %12s %12s %9s\n", "benchmark", isRelative ? "baseline x" : "baseline ns", isRelative ? "current x" : "current ns", "change");
+
+    while (fgets(lineBuffer, sizeof(lineBuffer), baselineFile)) {
+        char   baselineName[64];
+        char   baselineEngine[32];
+        uint64 baselineCount;
+        double baselineTime;
+        double baselinePerSecond;
+        double baselineRelativeTime = 0;
+
+        if ((sscanf(lineBuffer, "%63[^,],%31[^,],%" SCNu64 ",%lf,%lf,%lf", baselineName, baselineEngine, &baselineCount, &baselineTime, &baselinePerSecond, &baselineRelativeTime) < 4) || (strcmp(baselineEngine, engineName) != 0)) {
+            continue;
+        }
+
+        double baselineValue = isRelative ? baselineRelativeTime : baselineTime;
+
+        if (baselineValue <= 0) {
+            continue;
+        }
+
+        for (uint resultIndex = 0; resultIndex < results.size(); ++resultIndex) {
+            const Result& currentResult = results[resultIndex];
+            double        currentValue  = isRelative ? currentResult.relativeTime : currentResult.nanosecondsEach;
+
+            if ((currentResult.name != baselineName) || (currentValue <= 0)) {
+                continue;
+            }
+
+            double changePercent = ((currentValue / baselineValue) - 1.0) * 100.0;
+            bool   isRegression  = changePercent > thresholdPercent;
+
+            printf("%-20s %12.3f %12.3f %+8.1f%%%s\n", baselineName, baselineValue, currentValue, changePercent, isRegression ? "  REGRESSION" : "");
+
+            numberOfCompared++;
+            numberOfRegressions += isRegression;
+        }
+    }
+
+    fclose(baselineFile);
+
+    if (numberOfCompared == 0) {
+        Error(Tag, "The baseline has no %s results to compare with%s.", engineName, isRelative ? " (relative to the interpreter)" : "");
+        return false;
+    }
+
+    if (numberOfRegressions > 0) {
+        Error(Tag, "%u of %u benchmarks regressed by more than %.1f%%.", numberOfRegressions, numberOfCompared, thresholdPercent);
+        return false;
+    }
+
+    Info(Tag, "%u benchmarks within %.1f%% of the baseline.", numberOfCompared, thresholdPercent);
+    return true;
+}
+
+// Benchmark
+
+int main(int numberOfArguments, char** argumentsValues) {
+    uint64                 numberOfCycles   = DefaultCycles;
+    uint                   numberOfRounds   = DefaultRounds;
+    double                 thresholdPercent = DefaultThreshold;
+    Chip8::Engine          engine           = Chip8::Predecoded;
+    charconst              engineName       = "predecoded";
+    charconst              csvPath          = NULL;
+    charconst              jsonPath         = NULL;
+    charconst              baselinePath     = NULL;
+    std::vector<charconst> programPaths;
+
+    for (int argumentIndex = 1; argumentIndex < numberOfArguments; ++argumentIndex) {
+        charconst argumentValue = argumentsValues[argumentIndex];
+        bool      hasValue      = (argumentIndex + 1) < numberOfArguments;
+
+        if ((strcmp(argumentValue, "--cycles") == 0) && hasValue) {
+            numberOfCycles = strtoull(argumentsValues[++argumentIndex], NULL, 10);
+        } else if ((strcmp(argumentValue, "--rounds") == 0) && hasValue) {
+            numberOfRounds = std::max(1, atoi(argumentsValues[++argumentIndex]));
+        } else if ((strcmp(argumentValue, "--engine") == 0) && hasValue) {
+            engineName = argumentsValues[++argumentIndex];
+
+            if (strcmp(engineName, "interpreter") == 0) {
+                engine = Chip8::Interpreter;
+            } else if (strcmp(engineName, "predecoded") == 0) {
+                engine = Chip8::Predecoded;
+            } else if (strcmp(engineName, "recompiled") == 0) {
+                engine = Chip8::Recompiled;
+            } else {
+                Error(Tag, "Unknown engine: %s", engineName);
+                return 1;
+            }
+        } else if ((strcmp(argumentValue, "--csv") == 0) && hasValue) {
+            csvPath = argumentsValues[++argumentIndex];
+        } else if ((strcmp(argumentValue, "--json") == 0) && hasValue) {
+            jsonPath = argumentsValues[++argumentIndex];
+        } else if ((strcmp(argumentValue, "--compare") == 0) && hasValue) {
+            baselinePath = argumentsValues[++argumentIndex];
+        } else if ((strcmp(argumentValue, "--threshold") == 0) && hasValue) {
+            thresholdPercent = atof(argumentsValues[++argumentIndex]);
+        } else if (argumentValue[0] == '-') {
+            printf("Usage: %s [--cycles <count>] [--rounds <count>] [--engine <interpreter|predecoded*|recompiled>] [--csv <path>] [--json <path>] [--compare <baseline.csv> [--threshold <percent>]] [programs...]\n", argumentsValues[0]);
+            return 1;
+        } else {
+            programPaths.push_back(argumentValue);
+        }
+    }
+
+    if (programPaths.empty()) {
+        programPaths.assign(DefaultPrograms, DefaultPrograms + (sizeof(DefaultPrograms) / sizeof(DefaultPrograms[0])));
+    }
+
+    Info(Tag, "%s engine, %" PRIu64 " instructions per program, best of %u rounds.", engineName, numberOfCycles, numberOfRounds);
+
+    std::vector<Result> results;
+    uint64              retiredInstructions;
+
+    // Programs
+
+    for (uint programIndex = 0; programIndex < programPaths.size(); ++programIndex) {
+        Chip8::RAM programMemory;
+        memset(programMemory, 0, sizeof(programMemory));
+
+        if (!Chip8::LoadProgram(programPaths[programIndex], programMemory)) {
+            return 1;
+        }
+
+        string programName = programPaths[programIndex];
+        programName        = programName.substr(programName.find_last_of('/') + 1);
+
+        double relativeTime;
+        double nanosecondsEach = Measure(programMemory, engine, numberOfCycles, numberOfRounds, retiredInstructions, relativeTime);
+
+        Result programResult = {"program/" + programName, programPaths[programIndex], retiredInstructions, nanosecondsEach, relativeTime};
+        results.push_back(programResult);
+    }
+
+    // Opcode families
+
+    double spriteTime         = 0;
+    double spriteRelativeTime = 0;
+
+    for (uint kernelIndex = 0; kernelIndex < (sizeof(Kernels) / sizeof(Kernels[0])); ++kernelIndex) {
+        Chip8::RAM kernelMemory;
+        memset(kernelMemory, 0, sizeof(kernelMemory));
+        BuildKernel(Kernels[kernelIndex], kernelMemory);
+
+        double relativeTime;
+        double nanosecondsEach = Measure(kernelMemory, engine, KernelCycles, numberOfRounds, retiredInstructions, relativeTime);
+
+        Result familyResult = {string("family/") + Kernels[kernelIndex].name, Kernels[kernelIndex].description, retiredInstructions, nanosecondsEach, relativeTime};
+        results.push_back(familyResult);
+
+        if (strcmp(Kernels[kernelIndex].name, "D") == 0) {
+            spriteTime         = nanosecondsEach;
+            spriteRelativeTime = relativeTime;
+        }
+    }
+
+    Result spriteResult = {"dxyn/sprites", "DXYF sprites (15 rows)", KernelCycles, spriteTime, spriteRelativeTime};
+    Result rowResult    = {"dxyn/rows", "DXYF sprite rows", KernelCycles * SpriteRows, spriteTime / SpriteRows, spriteRelativeTime};
+    Result memoryResult = {"memory/peak_rss_kb", "Peak resident set (KB)", GetPeakMemory(), 0.0, 0.0};
+
+    results.push_back(spriteResult);
+    results.push_back(rowResult);
+    results.push_back(memoryResult);
+
+    // Report
+
+    printf("%-20s %-28s %12s %10s %16s %10s\n", "benchmark", "description", "count", "ns each", "per second", "vs interp");
+
+    for (uint resultIndex = 0; resultIndex < results.size(); ++resultIndex) {
+        const Result& currentResult = results[resultIndex];
+
+        if (currentResult.nanosecondsEach > 0) {
+            printf("%-20s %-28s %12" PRIu64 " %10.3f %16.0f %9.3fx\n", currentResult.name.c_str(), currentResult.description.c_str(), currentResult.count, currentResult.nanosecondsEach, 1e9 / currentResult.nanosecondsEach, currentResult.relativeTime);
+        } else {
+            printf("%-20s %-28s %12" PRIu64 "\n", currentResult.name.c_str(), currentResult.description.c_str(), currentResult.count);
+        }
+    }
+
+    if (csvPath && !WriteCsv(csvPath, engineName, results)) {
+        return 1;
+    }
+
+    if (jsonPath && !WriteJson(jsonPath, engineName, results)) {
+        return 1;
+    }
+
+    if (baselinePath && !Compare(baselinePath, engineName, results, thresholdPercent)) {
+        return 2;
+    }
+
+    return 0;
+}
@@ -0,0 +1,70 @@
+/*
+ * TraceDecoder.cxx
+ *
+ * This file is part of the Chip8++ source code.
+ * Copyright 2023 Patrick Melo <patrick@patrickmelo.com.br>
+ */
+
+#include "Chip8.hxx"
+#include "Core.hxx"
+#include "Tracer.hxx"
+
+// Constants
+
+static constexpr charconst Tag = "TraceDecoder";
+
+// Decoder
+
+int main(int numberOfArguments, char** argumentsValues) {
+    if (numberOfArguments < 2) {
+        printf("Usage: %s <trace>\n", argumentsValues[0]);
+        return 1;
+    }
+
+    FILE* traceFile = fopen(argumentsValues[1], "rb");
+
+    if (!traceFile) {
+        Error(Tag, "Could not open %s.", argumentsValues[1]);
+        return 1;
+    }
+
+    Tracer::Header traceHeader;
+
+    if ((fread(&traceHeader, sizeof(traceHeader), 1, traceFile) != 1) || (traceHeader.magic != Tracer::TraceMagic) || (traceHeader.version != Tracer::TraceVersion) || (traceHeader.recordSize != sizeof(Tracer::Record))) {
+        Error(Tag, "%s is not a version %u trace.", argumentsValues[1], Tracer::TraceVersion);
+        fclose(traceFile);
+        return 1;
+    }
+
+    // One line per instruction, as the old debug output printed it, followed by what the instruction changed.
+
+    Tracer::Record currentRecord;
+    uint32         addressRegister = 0;
+    uint64         numberOfRecords = 0;
+    char           mnemonicText[32];
+
+    while (fread(&currentRecord, sizeof(currentRecord), 1, traceFile) == 1) {
+        Chip8::Disassemble(currentRecord.opCode, mnemonicText, sizeof(mnemonicText));
+        printf("%6u $%03x (%02x %02x): %-20s", currentRecord.frameNumber, currentRecord.programCounter, currentRecord.opCode >> 8, currentRecord.opCode & 0xFF, mnemonicText);
+
+        for (uint registerIndex = 0; registerIndex < 16; ++registerIndex) {
+            if (currentRecord.changedRegisters & (1 << registerIndex)) {
+                printf(" V%X=$%02x", registerIndex, currentRecord.cpuRegisters[registerIndex]);
+            }
+        }
+
+        uint32 recordAddress = (currentRecord.addressHigh << 16) | currentRecord.addressRegister;
+
+        if ((numberOfRecords == 0) || (recordAddress != addressRegister)) {
+            printf(" I=$%03x", recordAddress);
+        }
+
+        printf("\n");
+
+        addressRegister = recordAddress;
+        numberOfRecords++;
+    }
+
+    fclose(traceFile);
+    return 0;
+}
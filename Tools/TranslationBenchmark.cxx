@@ -0,0 +1,187 @@
+/*
+ * TranslationBenchmark.cxx
+ *
+ * This file is part of the Chip8++ source code.
+ * Copyright 2023 Patrick Melo <patrick@patrickmelo.com.br>
+ */
+
+#include "Chip8.hxx"
+#include "Core.hxx"
+#include "Scheduler.hxx"
+#include "Translation.hxx"
+
+// Constants
+
+static constexpr charconst Tag = "TranslationBenchmark";
+
+static const uint InstructionsPerFrame[] = {8, 30, 1000};
+
+// Machines (every program translated and linked in, loaded from the image it was translated from)
+
+struct Options {
+        uint numberOfFrames;
+        uint checkedFrames;    // Compared with the interpreter state by state
+};
+
+static bool StartMachine(Chip8& chip8, Chip8::RAM& mainMemory, const Chip8::Translation::Program& program, Chip8::Engine engine, uint instructionsPerFrame) {
+    memset(mainMemory, 0, sizeof(mainMemory));
+    memcpy(&mainMemory[Chip8::ProgramStartAddress], program.programData, program.programSize);
+    Chip8::LoadFonts(mainMemory);
+
+    chip8.SetRAM(&mainMemory);
+
+    if (!chip8.SetEngine(engine)) {
+        return false;
+    }
+
+    chip8.SetQuirkProfile(static_cast<Chip8::QuirkProfile>(program.quirkProfile));
+    chip8.SetInstructionsPerFrame(instructionsPerFrame);
+    chip8.SetIdleSkipping(false);
+    chip8.Reset();
+    return true;
+}
+
+// The same keys for every machine, a new handful every few frames, so the input paths run too.
+
+static uint16 KeysAt(uint frameIndex) {
+    uint32 keyState = ((frameIndex / 10) + 1) * 2654435761u;
+    return (keyState >> 13) & (keyState >> 21) & 0xFFFF;
+}
+
+// Checking
+
+static bool CheckProgram(const Chip8::Translation::Program& program, uint instructionsPerFrame, uint numberOfFrames) {
+    Chip8      interpretedChip8;
+    Chip8      translatedChip8;
+    Chip8::RAM interpretedMemory;
+    Chip8::RAM translatedMemory;
+    uint8      interpretedState[Chip8::StateSize];
+    uint8      translatedState[Chip8::StateSize];
+
+    if (!StartMachine(interpretedChip8, interpretedMemory, program, Chip8::Interpreter, instructionsPerFrame) || !StartMachine(translatedChip8, translatedMemory, program, Chip8::Translated, instructionsPerFrame)) {
+        return false;
+    }
+
+    if (!translatedChip8.GetTranslatedProgram()) {
+        Error(Tag, "%s was not picked up by the translated engine.", program.programName);
+        return false;
+    }
+
+    for (uint frameIndex = 0; frameIndex < numberOfFrames; ++frameIndex) {
+        interpretedChip8.SetKeyStates(KeysAt(frameIndex));
+        translatedChip8.SetKeyStates(KeysAt(frameIndex));
+
+        uint64 interpretedInstructions = interpretedChip8.RunFrames(1);
+        uint64 translatedInstructions  = translatedChip8.RunFrames(1);
+
+        interpretedChip8.SaveState(interpretedState, sizeof(interpretedState));
+        translatedChip8.SaveState(translatedState, sizeof(translatedState));
+
+        if ((interpretedInstructions != translatedInstructions) || (interpretedChip8.GetStopReason() != translatedChip8.GetStopReason()) || (memcmp(interpretedState, translatedState, sizeof(interpretedState)) != 0)) {
+            Error(Tag, "%s at %u instructions per frame differs from the interpreter at frame %u (PC %03X against %03X).", program.programName, instructionsPerFrame, frameIndex, translatedChip8.GetProgramCounter(), interpretedChip8.GetProgramCounter());
+            return false;
+        }
+
+        if (interpretedChip8.GetStopReason() != Chip8::BudgetExhausted) {
+            break;
+        }
+    }
+
+    return true;
+}
+
+// Benchmark
+
+struct Measurement {
+        double instructionsPerSecond;
+        double nativeShare;    // Of the instructions retired by the translated engine
+};
+
+static Measurement MeasureEngine(const Chip8::Translation::Program& program, Chip8::Engine engine, uint instructionsPerFrame, uint numberOfFrames) {
+    Chip8       chip8;
+    Chip8::RAM  mainMemory;
+    Measurement measurement = {0.0, 0.0};
+
+    if (!StartMachine(chip8, mainMemory, program, engine, instructionsPerFrame)) {
+        return measurement;
+    }
+
+    uint64 retiredInstructions = 0;
+    uint64 startTime           = Scheduler::Now();
+
+    for (uint frameIndex = 0; frameIndex < numberOfFrames; ++frameIndex) {
+        chip8.SetKeyStates(KeysAt(frameIndex));
+        retiredInstructions += chip8.RunFrames(1);
+
+        if (chip8.GetStopReason() != Chip8::BudgetExhausted) {
+            break;
+        }
+    }
+
+    uint64 elapsedTime = Scheduler::Now() - startTime;
+
+    Chip8::TranslationStatistics translationStatistics = chip8.GetTranslationStatistics();
+    uint64                       translatedTotal       = translationStatistics.nativeInstructions + translationStatistics.interpretedInstructions;
+
+    measurement.instructionsPerSecond = elapsedTime > 0 ? (retiredInstructions * 1e9) / elapsedTime : 0.0;
+    measurement.nativeShare           = translatedTotal > 0 ? (translationStatistics.nativeInstructions * 100.0) / translatedTotal : 0.0;
+    return measurement;
+}
+
+int main(int numberOfArguments, char** argumentsValues) {
+    Options options;
+
+    options.numberOfFrames = 20000;
+    options.checkedFrames  = 3600;
+
+    for (int argumentIndex = 1; argumentIndex < numberOfArguments; ++argumentIndex) {
+        charconst argumentValue = argumentsValues[argumentIndex];
+        bool      hasValue      = (argumentIndex + 1) < numberOfArguments;
+
+        if ((strcmp(argumentValue, "--frames") == 0) && hasValue) {
+            options.numberOfFrames = strtoul(argumentsValues[++argumentIndex], NULL, 10);
+        } else if ((strcmp(argumentValue, "--checked-frames") == 0) && hasValue) {
+            options.checkedFrames = strtoul(argumentsValues[++argumentIndex], NULL, 10);
+        } else {
+            printf("Usage: %s [--frames <count>] [--checked-frames <count>]\n", argumentsValues[0]);
+            return 1;
+        }
+    }
+
+    if (!Chip8::Translation::GetPrograms()) {
+        Error(Tag, "No translated program is linked in.");
+        return 1;
+    }
+
+    Info(Tag, "%u frames measured, %u checked frame by frame against the interpreter, idle skipping off.", options.numberOfFrames, options.checkedFrames);
+    printf("%-14s %5s %14s %14s %14s %14s %8s %8s %10s\n", "program", "ipf", "interpreter/s", "predecoded/s", "recompiled/s", "translated/s", "gain", "native", "state");
+
+    bool isIdentical = true;
+
+    for (const Chip8::Translation::Program* program = Chip8::Translation::GetPrograms(); program; program = program->nextProgram) {
+        for (uint rateIndex = 0; rateIndex < (sizeof(InstructionsPerFrame) / sizeof(InstructionsPerFrame[0])); ++rateIndex) {
+            uint instructionsPerFrame = InstructionsPerFrame[rateIndex];
+            bool isSameState          = CheckProgram(*program, instructionsPerFrame, options.checkedFrames);
+
+            Measurement interpreterRun = MeasureEngine(*program, Chip8::Interpreter, instructionsPerFrame, options.numberOfFrames);
+            Measurement predecodedRun  = MeasureEngine(*program, Chip8::Predecoded, instructionsPerFrame, options.numberOfFrames);
+            Measurement recompiledRun  = MeasureEngine(*program, Chip8::Recompiled, instructionsPerFrame, options.numberOfFrames);
+            Measurement translatedRun  = MeasureEngine(*program, Chip8::Translated, instructionsPerFrame, options.numberOfFrames);
+
+            printf("%-14s %5u %14.0f %14.0f %14.0f %14.0f %7.2fx %7.1f%% %10s\n",
+                   program->programName,
+                   instructionsPerFrame,
+                   interpreterRun.instructionsPerSecond,
+                   predecodedRun.instructionsPerSecond,
+                   recompiledRun.instructionsPerSecond,
+                   translatedRun.instructionsPerSecond,
+                   predecodedRun.instructionsPerSecond > 0 ? translatedRun.instructionsPerSecond / predecodedRun.instructionsPerSecond : 0.0,
+                   translatedRun.nativeShare,
+                   isSameState ? "identical" : "DIFFERENT");
+
+            isIdentical &= isSameState;
+        }
+    }
+
+    return isIdentical ? 0 : 1;
+}
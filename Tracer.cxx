@@ -0,0 +1,212 @@
+/*
+ * Tracer.cxx
+ *
+ * This file is part of the Chip8++ source code.
+ * Copyright 2023 Patrick Melo <patrick@patrickmelo.com.br>
+ */
+
+#include "Tracer.hxx"
+
+#include <chrono>
+
+static_assert(sizeof(Tracer::Record) == 32, "Trace records are expected to be 32 bytes.");
+
+// Helpers
+
+static bool WriteHeader(FILE* traceFile) {
+    Tracer::Header traceHeader;
+
+    traceHeader.magic      = Tracer::TraceMagic;
+    traceHeader.version    = Tracer::TraceVersion;
+    traceHeader.recordSize = sizeof(Tracer::Record);
+
+    return fwrite(&traceHeader, sizeof(traceHeader), 1, traceFile) == 1;
+}
+
+// Tracer
+
+Tracer::Tracer(uint capacity) :
+    isInitialized(false),
+    chip8(NULL),
+    records(NULL),
+    capacity(1),
+    capacityMask(0),
+    frameNumber(0),
+    head(0),
+    tail(0),
+    traceFile(NULL),
+    isWriterRunning(false),
+    isWriting(false),
+    writerStalls(0) {
+    while (this->capacity < capacity) {
+        this->capacity <<= 1;
+    }
+
+    this->capacityMask = this->capacity - 1;
+}
+
+Tracer::~Tracer() {
+    this->Finalize();
+}
+
+// General
+
+bool Tracer::Initialize(Chip8* chip8) {
+    if (this->isInitialized) {
+        return false;
+    }
+
+    this->records = new (std::nothrow) Record[this->capacity];
+
+    if (!this->records) {
+        Error(Tracer::Tag, "Could not allocate %u trace records.", this->capacity);
+        return false;
+    }
+
+    this->chip8       = chip8;
+    this->frameNumber = 0;
+    this->head        = 0;
+    this->tail        = 0;
+    this->chip8->SetTracer(this);
+
+    return this->isInitialized = true;
+}
+
+void Tracer::Finalize(void) {
+    if (!this->isInitialized) {
+        return;
+    }
+
+    this->StopWriter();
+    this->chip8->SetTracer(NULL);
+
+    delete[] this->records;
+
+    this->records       = NULL;
+    this->chip8         = NULL;
+    this->isInitialized = false;
+}
+
+// Writer
+
+bool Tracer::StartWriter(const string filePath) {
+    if (!this->isInitialized || this->isWriting) {
+        return false;
+    }
+
+    this->traceFile = fopen(filePath.c_str(), "wb");
+
+    if (!this->traceFile || !WriteHeader(this->traceFile)) {
+        Error(Tracer::Tag, "Could not write %s.", filePath.c_str());
+
+        if (this->traceFile) {
+            fclose(this->traceFile);
+            this->traceFile = NULL;
+        }
+
+        return false;
+    }
+
+    // Records already in the ring go out first.
+
+    uint64 headIndex = this->head.load();
+    this->tail       = headIndex > this->capacity ? headIndex - this->capacity : 0;
+
+    this->isWriting       = true;
+    this->isWriterRunning = true;
+    this->writerThread    = std::thread(&Tracer::Write, this);
+
+    return true;
+}
+
+void Tracer::StopWriter(void) {
+    if (!this->isWriting) {
+        return;
+    }
+
+    this->isWriterRunning = false;
+    this->writerThread.join();
+    this->isWriting = false;
+
+    fclose(this->traceFile);
+    this->traceFile = NULL;
+
+    Info(Tracer::Tag, "%" PRIu64 " records written (%" PRIu64 " writer stalls).", this->head.load(), this->writerStalls);
+}
+
+bool Tracer::Dump(const string filePath) const {
+    if (!this->isInitialized) {
+        return false;
+    }
+
+    FILE* dumpFile = fopen(filePath.c_str(), "wb");
+
+    if (!dumpFile) {
+        Error(Tracer::Tag, "Could not write %s.", filePath.c_str());
+        return false;
+    }
+
+    uint64 headIndex   = this->head.load(std::memory_order_acquire);
+    uint64 recordIndex = headIndex > this->capacity ? headIndex - this->capacity : 0;
+    bool   isWritten   = WriteHeader(dumpFile);
+
+    for (; isWritten && (recordIndex < headIndex); ++recordIndex) {
+        isWritten = fwrite(&this->records[recordIndex & this->capacityMask], sizeof(Record), 1, dumpFile) == 1;
+    }
+
+    fclose(dumpFile);
+
+    if (!isWritten) {
+        Error(Tracer::Tag, "Could not write %s.", filePath.c_str());
+    }
+
+    return isWritten;
+}
+
+void Tracer::Write(void) {
+    bool isWriteFailed = false;
+
+    for (;;) {
+        uint64 headIndex = this->head.load(std::memory_order_acquire);
+        uint64 tailIndex = this->tail.load(std::memory_order_relaxed);
+
+        if (headIndex == tailIndex) {
+            if (!this->isWriterRunning) {
+                break;
+            }
+
+            std::this_thread::sleep_for(std::chrono::milliseconds(Tracer::WriterWait));
+            continue;
+        }
+
+        // Up to the end of the ring at once, the rest on the next pass.
+
+        uint firstRecord     = tailIndex & this->capacityMask;
+        uint numberOfRecords = std::min<uint64>(headIndex - tailIndex, this->capacity - firstRecord);
+
+        if (!isWriteFailed && (fwrite(&this->records[firstRecord], sizeof(Record), numberOfRecords, this->traceFile) != numberOfRecords)) {
+            Error(Tracer::Tag, "Could not write the trace, the remaining records are discarded.");
+            isWriteFailed = true;
+        }
+
+        this->tail.store(tailIndex + numberOfRecords, std::memory_order_release);
+    }
+}
+
+void Tracer::WaitForWriter(uint64 headIndex) {
+    this->writerStalls++;
+
+    while ((headIndex - this->tail.load(std::memory_order_acquire)) >= this->capacity) {
+        std::this_thread::yield();
+    }
+}
+
+// Statistics
+
+uint64 Tracer::GetRecordCount(void) const {
+    return this->head.load(std::memory_order_relaxed);
+}
+
+uint64 Tracer::GetWriterStalls(void) const {
+    return this->writerStalls;
+}
@@ -0,0 +1,113 @@
+/*
+ * Tracer.hxx
+ *
+ * This file is part of the Chip8++ source code.
+ * Copyright 2023 Patrick Melo <patrick@patrickmelo.com.br>
+ */
+
+#ifndef CHIP8_TRACER_H
+#define CHIP8_TRACER_H
+
+#include "Chip8.hxx"
+
+#include <atomic>
+#include <thread>
+
+// Tracer (fixed-size binary records of every executed instruction, kept in a ring and optionally streamed to a file)
+
+class Tracer {
+    public:
+        Tracer(uint capacity = Tracer::DefaultCapacity);
+        ~Tracer();
+
+        // Types
+        struct Header {
+                uint32 magic;
+                uint16 version;
+                uint16 recordSize;
+        };
+
+        struct Record {
+                uint32 frameNumber;
+                uint16 programCounter;     // Where the instruction was fetched
+                uint16 opCode;
+                uint16 addressRegister;    // Everything below is the state after the instruction (bits 0-15 of I)
+                uint16 changedRegisters;   // One bit per V register the instruction wrote
+                uint8  cpuRegisters[16];
+                uint8  delayTimer;
+                uint8  soundTimer;
+                uint8  stackPointer;
+                uint8  addressHigh;        // Bits 16-23 of I (MEGA-CHIP)
+        };
+
+        // Constants
+        static constexpr charconst Tag             = "Tracer";
+        static constexpr uint32    TraceMagic      = 0x52543843;    // "C8TR"
+        static constexpr uint16    TraceVersion    = 1;
+        static constexpr uint      DefaultCapacity = 64 * 1024;     // Records, rounded up to a power of two
+        static constexpr uint      WriterWait      = 1;             // Milliseconds the writer sleeps when the ring is empty
+
+        // General
+        bool Initialize(Chip8* chip8);
+        void Finalize(void);
+
+        // Writer (streams every record to a file; without it the ring keeps the newest ones)
+        bool StartWriter(const string filePath);
+        void StopWriter(void);
+        bool Dump(const string filePath) const;
+
+        // Recording
+        inline void Append(const Record& newRecord) {
+            uint64 headIndex = this->head.load(std::memory_order_relaxed);
+
+            // A streamed trace must be complete, so a full ring waits for the writer instead of dropping records.
+
+            if (this->isWriting && ((headIndex - this->tail.load(std::memory_order_acquire)) >= this->capacity)) {
+                this->WaitForWriter(headIndex);
+            }
+
+            this->records[headIndex & this->capacityMask] = newRecord;
+            this->head.store(headIndex + 1, std::memory_order_release);
+        }
+
+        inline uint32 GetFrameNumber(void) const {
+            return this->frameNumber;
+        }
+
+        inline void AdvanceFrame(void) {
+            this->frameNumber++;
+        }
+
+        // Statistics
+        uint64 GetRecordCount(void) const;
+        uint64 GetWriterStalls(void) const;
+
+    private:
+        // General
+        bool isInitialized;
+
+        // Chip8
+        Chip8* chip8;
+
+        // Ring
+        Record*             records;
+        uint                capacity;
+        uint                capacityMask;
+        uint32              frameNumber;
+        std::atomic<uint64> head;
+        std::atomic<uint64> tail;
+
+        // Writer
+        FILE*             traceFile;
+        std::thread       writerThread;
+        std::atomic<bool> isWriterRunning;
+        bool              isWriting;
+
+        void Write(void);
+        void WaitForWriter(uint64 headIndex);
+
+        // Statistics
+        uint64 writerStalls;
+};
+
+#endif    // CHIP8_TRACER_H
@@ -0,0 +1,176 @@
+/*
+ * Translation.cxx
+ *
+ * This file is part of the Chip8++ source code.
+ * Copyright 2023 Patrick Melo <patrick@patrickmelo.com.br>
+ */
+
+#include "Translation.hxx"
+
+// Programs
+
+static Chip8::Translation::Program* registeredPrograms = NULL;
+
+void Chip8::Translation::Register(Program* program) {
+    program->nextProgram = registeredPrograms;
+    registeredPrograms   = program;
+}
+
+const Chip8::Translation::Program* Chip8::Translation::GetPrograms(void) {
+    return registeredPrograms;
+}
+
+// Translation
+
+Chip8::Translation::Translation(Chip8* chip8) :
+    chip8(chip8),
+    currentProgram(NULL),
+    nativeInstructions(0),
+    interpretedInstructions(0) {
+    memset(this->codeStates, 0, sizeof(this->codeStates));
+    memset(this->blockInstructions, 0, sizeof(this->blockInstructions));
+    memset(this->blockCoverage, 0, sizeof(this->blockCoverage));
+}
+
+const Chip8::Translation::Program* Chip8::Translation::GetProgram(void) const {
+    return this->currentProgram;
+}
+
+bool Chip8::Translation::IsProgramLoaded(const Program* program) const {
+    if ((program->quirkProfile != this->chip8->quirkProfile) || ((Chip8::ProgramStartAddress + program->programSize) > sizeof(Chip8::RAM))) {
+        return false;
+    }
+
+    for (uint byteIndex = 0; byteIndex < program->programSize; ++byteIndex) {
+        if (this->chip8->ReadMemory(Chip8::ProgramStartAddress + byteIndex) != program->programData[byteIndex]) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// Execution
+
+uint64 Chip8::Translation::Execute(uint64 numberOfCycles) {
+    if (!this->currentProgram) {
+        uint64 interpretedRetired = this->chip8->ExecutePredecoded(numberOfCycles);
+
+        this->interpretedInstructions += interpretedRetired;
+        return interpretedRetired;
+    }
+
+    uint64 retiredInstructions = 0;
+
+    while (retiredInstructions < numberOfCycles) {
+        uint64 nativeInstructions = this->currentProgram->programCode(this->chip8, this->codeStates, numberOfCycles - retiredInstructions);
+
+        retiredInstructions += nativeInstructions;
+        this->nativeInstructions += nativeInstructions;
+
+        if (!this->chip8->isRunning || (retiredInstructions == numberOfCycles)) {
+            break;
+        }
+
+        // The translated code stops where there is none, where it no longer holds, and before a block longer than the
+        // budget left; that last one runs the rest of the budget from the predecoded cache, never past the block end.
+
+        uint16 programCounter     = this->chip8->programCounter;
+        uint64 interpretedBudget  = ((programCounter < sizeof(Chip8::RAM)) && this->codeStates[programCounter]) ? numberOfCycles - retiredInstructions : 1;
+        uint64 interpretedRetired = this->chip8->ExecutePredecoded(interpretedBudget);
+
+        retiredInstructions += interpretedRetired;
+        this->interpretedInstructions += interpretedRetired;
+
+        if (interpretedRetired < interpretedBudget) {
+            break;
+        }
+    }
+
+    return retiredInstructions;
+}
+
+// Code
+
+void Chip8::Translation::Validate(uint16 blockAddress) {
+    uint blockLength = this->blockInstructions[blockAddress] * 2;
+    bool isUnchanged = true;
+
+    for (uint byteIndex = 0; (byteIndex < blockLength) && isUnchanged; ++byteIndex) {
+        isUnchanged = this->chip8->ReadMemory(blockAddress + byteIndex) == this->currentProgram->programData[blockAddress + byteIndex - Chip8::ProgramStartAddress];
+    }
+
+    // Writing back what was there (a state being loaded, say) makes the block usable again.
+
+    for (uint byteIndex = 0; byteIndex < blockLength; byteIndex += 2) {
+        this->codeStates[blockAddress + byteIndex] = isUnchanged;
+    }
+}
+
+void Chip8::Translation::Invalidate(uint16 address, uint length) {
+    if (!this->currentProgram) {
+        return;
+    }
+
+    for (uint byteIndex = 0; byteIndex < length; ++byteIndex) {
+        uint16 writtenAddress = (address + byteIndex) & 0xFFF;
+
+        if (this->blockCoverage[writtenAddress] == 0) {
+            continue;
+        }
+
+        uint16 firstAddress = writtenAddress >= ((Translation::MaximumBlockInstructions * 2) - 1) ? writtenAddress - ((Translation::MaximumBlockInstructions * 2) - 1) : 0;
+
+        for (uint16 blockAddress = firstAddress; blockAddress <= writtenAddress; ++blockAddress) {
+            if (this->blockInstructions[blockAddress] && ((blockAddress + (this->blockInstructions[blockAddress] * 2)) > writtenAddress)) {
+                this->Validate(blockAddress);
+            }
+        }
+    }
+}
+
+void Chip8::Translation::Flush(void) {
+    // The first translation of the program in memory, made for the machine's profile, is the one used.
+
+    this->currentProgram = NULL;
+
+    memset(this->codeStates, 0, sizeof(this->codeStates));
+    memset(this->blockInstructions, 0, sizeof(this->blockInstructions));
+    memset(this->blockCoverage, 0, sizeof(this->blockCoverage));
+
+    for (const Program* program = registeredPrograms; program; program = program->nextProgram) {
+        if (this->IsProgramLoaded(program)) {
+            this->currentProgram = program;
+            break;
+        }
+    }
+
+    if (!this->currentProgram) {
+        return;
+    }
+
+    for (uint blockIndex = 0; blockIndex < this->currentProgram->numberOfBlocks; ++blockIndex) {
+        const Block& currentBlock = this->currentProgram->programBlocks[blockIndex];
+        uint         blockLength  = currentBlock.instructionCount * 2;
+
+        this->blockInstructions[currentBlock.address] = currentBlock.instructionCount;
+
+        for (uint byteIndex = 0; byteIndex < blockLength; ++byteIndex) {
+            this->blockCoverage[currentBlock.address + byteIndex] = 1;
+        }
+
+        for (uint byteIndex = 0; byteIndex < blockLength; byteIndex += 2) {
+            this->codeStates[currentBlock.address + byteIndex] = 1;
+        }
+    }
+}
+
+// Statistics
+
+uint64 Chip8::Translation::GetNativeInstructions(void) const {
+    return this->nativeInstructions;
+}
+
+uint64 Chip8::Translation::GetInterpretedInstructions(void) const {
+    return this->interpretedInstructions;
+}
@@ -0,0 +1,104 @@
+/*
+ * Translation.hxx
+ *
+ * This file is part of the Chip8++ source code.
+ * Copyright 2023 Patrick Melo <patrick@patrickmelo.com.br>
+ */
+
+#ifndef CHIP8_TRANSLATION_H
+#define CHIP8_TRANSLATION_H
+
+#include "Chip8.hxx"
+
+// Translation (runs programs that Tools/RomTranslator translated into C++ ahead of time and that were linked in)
+
+class Chip8::Translation {
+    public:
+        Translation(Chip8* chip8);
+
+        // Types
+        typedef uint64 (*ProgramCode)(Chip8* chip8, const uint8* codeStates, uint64 numberOfCycles);    // Instructions retired
+
+        struct Block {
+                uint16 address;
+                uint8  instructionCount;
+        };
+
+        struct Program {
+                charconst    programName;
+                uint8        quirkProfile;    // The translation is only used by machines running this profile
+                const uint8* programData;     // Only used when memory holds exactly this at ProgramStartAddress
+                uint         programSize;
+                const Block* programBlocks;
+                uint         numberOfBlocks;
+                ProgramCode  programCode;
+                Program*     nextProgram;
+        };
+
+        struct Registration {
+                Registration(Program* program) {
+                    Translation::Register(program);
+                }
+        };
+
+        // Constants
+        static constexpr charconst Tag                      = "Translation";
+        static constexpr uint      MaximumBlockInstructions = 32;
+
+        // Programs (registered by the static initializers of the translated files)
+        static void           Register(Program* program);
+        static const Program* GetPrograms(void);
+        const Program*        GetProgram(void) const;
+
+        // Execution
+        uint64 Execute(uint64 numberOfCycles);
+
+        // Code
+        void Invalidate(uint16 address, uint length);
+        void Flush(void);
+
+        // Statistics
+        uint64 GetNativeInstructions(void) const;
+        uint64 GetInterpretedInstructions(void) const;
+
+        // State (what translated code reads and writes, the same fields the interpreter uses)
+        static inline uint8* GetRegisters(Chip8* chip8) {
+            return chip8->cpuRegisters;
+        }
+
+        static inline uint32& GetAddressRegister(Chip8* chip8) {
+            return chip8->addressRegister;
+        }
+
+        static inline uint16& GetProgramCounter(Chip8* chip8) {
+            return chip8->programCounter;
+        }
+
+        static inline uint8& GetDelayTimer(Chip8* chip8) {
+            return chip8->delayTimer;
+        }
+
+        // Runs the instruction at the program counter through the predecoded cache, false when it stopped the machine.
+        static inline bool Step(Chip8* chip8) {
+            return chip8->ExecutePredecoded(1) != 0;
+        }
+
+    private:
+        // Chip8
+        Chip8* chip8;
+
+        // Code (one state per instruction address, set while the instruction still holds what was translated)
+        const Program* currentProgram;
+        uint8          codeStates[sizeof(Chip8::RAM)];
+        uint8          blockInstructions[sizeof(Chip8::RAM)];    // At the first address of every block
+        uint8          blockCoverage[sizeof(Chip8::RAM)];
+
+        bool IsProgramLoaded(const Program* program) const;
+        void Validate(uint16 blockAddress);
+
+        // Statistics
+        uint64 nativeInstructions;
+        uint64 interpretedInstructions;
+};
+
+#endif    // CHIP8_TRANSLATION_H
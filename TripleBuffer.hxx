@@ -0,0 +1,66 @@
+/*
+ * TripleBuffer.hxx
+ *
+ * This file is part of the Chip8++ source code.
+ * Copyright 2023 Patrick Melo <patrick@patrickmelo.com.br>
+ */
+
+#ifndef CHIP8_TRIPLE_BUFFER_H
+#define CHIP8_TRIPLE_BUFFER_H
+
+#include "Core.hxx"
+
+#include <atomic>
+
+// Triple Buffer (lock-free hand-off of whole frames from one writer to one reader)
+
+template <typename Type>
+class TripleBuffer {
+    public:
+        TripleBuffer(void) :
+            backIndex(0),
+            middleState(1),
+            frontIndex(2) {
+            memset(this->buffers, 0, sizeof(this->buffers));
+        }
+
+        // Constants
+        static constexpr uint8 IndexMask = 0x3;
+        static constexpr uint8 FreshBit  = 0x4;    // The middle buffer holds a frame the reader has not seen
+
+        // Writer
+        Type& GetBackBuffer(void) {
+            return this->buffers[this->backIndex];
+        }
+
+        void Publish(void) {
+            this->backIndex = this->middleState.exchange(this->backIndex | TripleBuffer::FreshBit, std::memory_order_acq_rel) & TripleBuffer::IndexMask;
+        }
+
+        // Reader
+        bool Acquire(void) {
+            if (!(this->middleState.load(std::memory_order_acquire) & TripleBuffer::FreshBit)) {
+                return false;
+            }
+
+            this->frontIndex = this->middleState.exchange(this->frontIndex, std::memory_order_acq_rel) & TripleBuffer::IndexMask;
+            return true;
+        }
+
+        const Type& GetFrontBuffer(void) const {
+            return this->buffers[this->frontIndex];
+        }
+
+    private:
+        // Buffers
+        Type buffers[3];
+
+        // Indexes (each side only touches its own index and the shared middle state)
+        uint8              backIndex;
+        uint8              writerPadding[63];
+        std::atomic<uint8> middleState;
+        uint8              middlePadding[63];
+        uint8              frontIndex;
+};
+
+#endif    // CHIP8_TRIPLE_BUFFER_H